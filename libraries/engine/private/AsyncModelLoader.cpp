@@ -0,0 +1,104 @@
+#include "AsyncModelLoader.hpp"
+
+#include "VulkanModelPipeline.hpp"
+
+AsyncModelLoader::~AsyncModelLoader()
+{
+    clear();
+    _join_retired_workers(true);
+}
+
+void
+AsyncModelLoader::load(std::string const &modelPath,
+                       bool compressTextures,
+                       ModelLoadingOption const &option)
+{
+    clear();
+
+    _worker.loading = std::make_unique<Loading>();
+    auto loading = _worker.loading.get();
+    auto thread_option = option;
+    thread_option.progress = &loading->progress;
+    _worker.thread = std::thread(
+      [loading, modelPath, compressTextures, thread_option]() -> void {
+          try {
+              loading->model.loadModel(modelPath, thread_option);
+              VulkanTextureManager::decodeTextures(
+                VulkanModelPipeline::getTexturePaths(loading->model),
+                compressTextures,
+                loading->progress.cancel,
+                loading->textures);
+          } catch (std::exception const &) {
+              loading->error = std::current_exception();
+          }
+          loading->done = true;
+      });
+}
+
+void
+AsyncModelLoader::cancel()
+{
+    if (_worker.loading) {
+        _worker.loading->progress.cancel = true;
+    }
+}
+
+void
+AsyncModelLoader::clear()
+{
+    _join_retired_workers(false);
+    if (_worker.thread.joinable()) {
+        _worker.loading->progress.cancel = true;
+        _retired_workers.emplace_back(std::move(_worker));
+    }
+    _worker = {};
+}
+
+bool
+AsyncModelLoader::isLoading() const
+{
+    return (_worker.thread.joinable());
+}
+
+float
+AsyncModelLoader::getProgress() const
+{
+    return ((_worker.loading) ? _worker.loading->progress.progress.load()
+                              : 0.0f);
+}
+
+bool
+AsyncModelLoader::getModel(Model &dst,
+                           VulkanTextureManager::DecodedTextures &textures)
+{
+    _join_retired_workers(false);
+    if (!_worker.thread.joinable() || !_worker.loading->done) {
+        return (false);
+    }
+    _worker.thread.join();
+
+    auto loading = std::move(_worker.loading);
+    _worker = {};
+    if (loading->progress.cancel) {
+        return (false);
+    }
+    if (loading->error) {
+        std::rethrow_exception(loading->error);
+    }
+    dst = std::move(loading->model);
+    textures = std::move(loading->textures);
+    return (true);
+}
+
+void
+AsyncModelLoader::_join_retired_workers(bool wait)
+{
+    for (auto it = _retired_workers.begin(); it != _retired_workers.end();) {
+        if (!wait && !it->loading->done) {
+            ++it;
+            continue;
+        }
+        it->thread.join();
+        it = _retired_workers.erase(it);
+    }
+}
@@ -22,7 +22,6 @@ Engine::init(char const *appName)
     _event_handler.setPerspectiveData(&_perspective_data);
     _event_handler.setVkRenderer(&_vk_renderer);
     _event_handler.setUi(&_ui);
-    _event_handler.setModel(&_model);
     _io_manager.createWindow(std::move(win_opts));
     _ui.init(_io_manager.getWindow());
     _vk_renderer.createInstance(appName,
@@ -56,8 +55,13 @@ Engine::run()
 {
     while (!_io_manager.shouldClose()) {
         _event_handler.processEvents(_io_manager.getEvents(), _ui.getUiEvent());
+        if (_ui.isMemoryInfoDisplayed()) {
+            _ui.setMemoryReport(_vk_renderer.getMemoryReport());
+        }
         _ui.drawUi();
-        _vk_renderer.draw(_camera.getPerspectiveViewMatrix());
+        _vk_renderer.draw(_camera.getPerspectiveViewMatrix(),
+                          _camera.getPerspectiveMatrix(),
+                          _camera.getPosition());
     }
     _vk_renderer.deviceWaitIdle();
     _vk_renderer.clear();
@@ -36,12 +36,6 @@ EventHandler::setUi(Ui *ui)
     _ui = ui;
 }
 
-void
-EventHandler::setModel(Model *model)
-{
-    _model = model;
-}
-
 void
 EventHandler::processEvents(IOEvents const &ioEvents, UiEvent const &uiEvent)
 {
@@ -50,7 +44,6 @@ EventHandler::processEvents(IOEvents const &ioEvents, UiEvent const &uiEvent)
     assert(_perspective);
     assert(_renderer);
     assert(_ui);
-    assert(_model);
 
     // Resetting movement tracking
     _movements = glm::ivec3(0);
@@ -86,6 +79,7 @@ EventHandler::processEvents(IOEvents const &ioEvents, UiEvent const &uiEvent)
           &EventHandler::_ui_mouse_exclusive,
           &EventHandler::_ui_invert_mouse_y_axis,
           &EventHandler::_ui_fullscreen,
+          &EventHandler::_ui_cancel_model_loading,
       };
 
     // Checking Timers
@@ -110,6 +104,9 @@ EventHandler::processEvents(IOEvents const &ioEvents, UiEvent const &uiEvent)
         }
     }
 
+    // Async model loading
+    _update_model_loading();
+
     // Camera updating
     if (_io_manager->isMouseExclusive()) {
         _update_camera(ioEvents.mouse_position);
@@ -325,27 +322,15 @@ EventHandler::_invert_camera_y_axis()
 void
 EventHandler::_ui_load_model()
 {
-    Model tmp;
-    bool model_parsed = false;
+    _model_loader.load(_ui->getModelFilepath(),
+                       _renderer->isTextureCompressionSupported());
+    _model_rendering_option = _ui->getModelRenderingOption();
+}
 
-    try {
-        tmp.loadModel(_ui->getModelFilepath());
-        *_model = std::move(tmp);
-        model_parsed = true;
-        _renderer->loadModel(*_model);
-        _model_index = _renderer->addModelInstance({});
-        auto model_info = _model->getModelInfo();
-        _ui->setModelInfo(
-          model_info.nbVertices, model_info.nbIndices, model_info.nbFaces);
-        _ui->resetModelParams();
-    } catch (std::exception const &e) {
-        fmt::print("{}\n", e.what());
-        if (model_parsed) {
-            _model_index = 0;
-            _ui->setModelInfo(0, 0, 0);
-        }
-        _ui->setModelLoadingError();
-    }
+void
+EventHandler::_ui_cancel_model_loading()
+{
+    _model_loader.cancel();
 }
 
 void
@@ -384,6 +369,31 @@ EventHandler::_ui_fullscreen()
     _io_manager->toggleFullscreen();
 }
 
+void
+EventHandler::_update_model_loading()
+{
+    Model tmp;
+    VulkanTextureManager::DecodedTextures textures;
+
+    // Previous model is still drawn when the renderer fails
+    try {
+        if (_model_loader.getModel(tmp, textures)) {
+            auto model_info = tmp.getModelInfo();
+            _renderer->loadModel(
+              std::move(tmp), _model_rendering_option, std::move(textures));
+            _model_index = _renderer->addModelInstance({});
+            _ui->setModelInfo(
+              model_info.nbVertices, model_info.nbIndices, model_info.nbFaces);
+            _ui->resetModelParams();
+        }
+    } catch (std::exception const &e) {
+        fmt::print("{}\n", e.what());
+        _ui->setModelLoadingError();
+    }
+    _ui->setModelLoadingProgress(_model_loader.isLoading(),
+                                 _model_loader.getProgress());
+}
+
 void
 EventHandler::_update_camera(glm::vec2 const &mouse_pos)
 {
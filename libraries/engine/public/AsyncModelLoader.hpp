@@ -0,0 +1,67 @@
+#ifndef SCOP_VULKAN_ASYNCMODELLOADER_HPP
+#define SCOP_VULKAN_ASYNCMODELLOADER_HPP
+
+#include <thread>
+#include <atomic>
+#include <exception>
+#include <string>
+#include <memory>
+#include <vector>
+
+#include "Model.hpp"
+#include "ModelLoadingOption.hpp"
+#include "ModelLoadingProgress.hpp"
+#include "VulkanTextureManager.hpp"
+
+// Loads one model at a time on a background thread, its textures are
+// decoded on the same thread
+class AsyncModelLoader final
+{
+  public:
+    AsyncModelLoader() = default;
+    ~AsyncModelLoader();
+    AsyncModelLoader(AsyncModelLoader const &src) = delete;
+    AsyncModelLoader &operator=(AsyncModelLoader const &rhs) = delete;
+    AsyncModelLoader(AsyncModelLoader &&src) = delete;
+    AsyncModelLoader &operator=(AsyncModelLoader &&rhs) = delete;
+
+    // A loading in progress is cancelled first. compressTextures has to
+    // match the texture manager the model is given to.
+    void load(std::string const &modelPath,
+              bool compressTextures,
+              ModelLoadingOption const &option = {});
+    void cancel();
+    // Cancels the loading in progress without waiting for its thread
+    void clear();
+
+    [[nodiscard]] bool isLoading() const;
+    [[nodiscard]] float getProgress() const;
+    // True once the model is loaded and moved into dst with its decoded
+    // textures, cancelled loadings end without result. Loading errors are
+    // rethrown.
+    bool getModel(Model &dst, VulkanTextureManager::DecodedTextures &textures);
+
+  private:
+    // Owned by the loader, only written by the thread until done is set
+    struct Loading final
+    {
+        ModelLoadingProgress progress;
+        std::atomic<bool> done{};
+        Model model;
+        VulkanTextureManager::DecodedTextures textures;
+        std::exception_ptr error;
+    };
+    struct Worker final
+    {
+        std::thread thread;
+        std::unique_ptr<Loading> loading;
+    };
+
+    inline void _join_retired_workers(bool wait);
+
+    Worker _worker;
+    // Cancelled workers, joined once their thread is done
+    std::vector<Worker> _retired_workers;
+};
+
+#endif // SCOP_VULKAN_ASYNCMODELLOADER_HPP
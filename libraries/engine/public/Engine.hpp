@@ -6,7 +6,6 @@
 #include "EventHandler.hpp"
 #include "Perspective.hpp"
 #include "VulkanRenderer.hpp"
-#include "Model.hpp"
 #include "Ui.hpp"
 
 class Engine final
@@ -35,7 +34,6 @@ class Engine final
     Camera _camera;
     EventHandler _event_handler;
     Perspective _perspective_data{};
-    Model _model;
     Ui _ui;
 };
 
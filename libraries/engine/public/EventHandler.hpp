@@ -10,6 +10,7 @@
 #include "VulkanRenderer.hpp"
 #include "Model.hpp"
 #include "Ui.hpp"
+#include "AsyncModelLoader.hpp"
 
 class EventHandler final
 {
@@ -26,7 +27,6 @@ class EventHandler final
     void setPerspectiveData(Perspective *perspective);
     void setVkRenderer(VulkanRenderer *renderer);
     void setUi(Ui *ui);
-    void setModel(Model *model);
 
     void processEvents(IOEvents const &ioEvents, UiEvent const &uiEvent);
 
@@ -95,6 +95,10 @@ class EventHandler final
     inline void _ui_mouse_exclusive();
     inline void _ui_invert_mouse_y_axis();
     inline void _ui_fullscreen();
+    inline void _ui_cancel_model_loading();
+
+    // Model loading related
+    inline void _update_model_loading();
 
     // Camera Related
     inline void _update_camera(glm::vec2 const &mouse_pos);
@@ -103,9 +107,11 @@ class EventHandler final
     IOManager *_io_manager{};
     Perspective *_perspective{};
     VulkanRenderer *_renderer{};
-    Model *_model{};
     Ui *_ui{};
     uint32_t _model_index{};
+    AsyncModelLoader _model_loader;
+    // Options picked when the model loading was requested
+    ModelRenderingOption _model_rendering_option{};
 
     EventTimers _timers;
 
@@ -16,6 +16,7 @@ class IndexedBuffer
     IndexedBuffer(IndexedBuffer &&src) = delete;
     IndexedBuffer &operator=(IndexedBuffer &&rhs) = delete;
 
+    // 0 means no limit, which is the default
     void setMaxInstanceNb(uint32_t maxInstanceNb);
     uint32_t getCurrentInstanceNb() const;
     uint32_t getMaxInstanceNb() const;
@@ -91,7 +92,7 @@ uint32_t
 IndexedBuffer<InstanceType>::addInstance(InstanceType const &info,
                                          InsatnceUpdateFct<InstanceType> update)
 {
-    if (_current_instance_nb >= _max_instance_nb) {
+    if (_max_instance_nb && _current_instance_nb >= _max_instance_nb) {
         return (0);
     }
 
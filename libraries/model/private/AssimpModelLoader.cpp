@@ -6,18 +6,19 @@
 #include "fmt/core.h"
 
 #include "assimp/Importer.hpp"
-#include "assimp/scene.h"
 #include "assimp/postprocess.h"
 
+#include "ParallelFor.hpp"
+
 void
 assimpLoadModel(char const *model_path,
                 std::vector<Vertex> &vertex_list,
                 std::vector<uint32_t> &indices_list,
-                std::vector<Mesh> &mesh_list)
+                std::vector<Mesh> &mesh_list,
+                ModelLoadingOption const &option)
 {
     assert(model_path);
     Assimp::Importer importer{};
-    std::unordered_map<Vertex, uint32_t> unique_vertices{};
 
     aiScene const *scene =
       importer.ReadFile(model_path,
@@ -28,19 +29,36 @@ assimpLoadModel(char const *model_path,
         throw std::runtime_error("AssimpLoader: Failed to load: " +
                                  std::string(model_path));
     }
-    assimpLoadNode(scene->mRootNode,
-                   scene,
-                   unique_vertices,
-                   vertex_list,
-                   indices_list,
-                   mesh_list);
+    if (option.parallel_import) {
+        std::vector<aiMesh *> meshes;
+        assimpCollectNodeMeshes(scene->mRootNode, scene, meshes);
+
+        std::vector<ModelMeshData> meshes_data(meshes.size());
+        parallelFor(
+          meshes.size(),
+          [&](size_t i) -> void {
+              checkModelLoadingCancel(option.progress);
+              assimpLoadMeshData(meshes[i], scene, meshes_data[i]);
+          },
+          option.nb_import_threads);
+        mergeMeshData(meshes_data, vertex_list, indices_list, mesh_list);
+        return;
+    }
+
+    // Every mesh vertex may be unique, table is sized for the worst case
+    size_t nb_vertices = 0;
+    for (size_t i = 0; i < scene->mNumMeshes; ++i) {
+        nb_vertices += scene->mMeshes[i]->mNumVertices;
+    }
+    VertexWeldTable weld_table(vertex_list, nb_vertices);
+    assimpLoadNode(
+      scene->mRootNode, scene, weld_table, indices_list, mesh_list);
 }
 
 void
 assimpLoadNode(aiNode *node,
                aiScene const *scene,
-               std::unordered_map<Vertex, uint32_t> &unique_vertices,
-               std::vector<Vertex> &vertex_list,
+               VertexWeldTable &weld_table,
                std::vector<uint32_t> &indices_list,
                std::vector<Mesh> &mesh_list)
 {
@@ -48,26 +66,20 @@ assimpLoadNode(aiNode *node,
     for (size_t i = 0; i < node->mNumMeshes; ++i) {
         assimpLoadMesh(scene->mMeshes[node->mMeshes[i]],
                        scene,
-                       unique_vertices,
-                       vertex_list,
+                       weld_table,
                        indices_list,
                        mesh_list);
     }
     for (size_t j = 0; j < node->mNumChildren; ++j) {
-        assimpLoadNode(node->mChildren[j],
-                       scene,
-                       unique_vertices,
-                       vertex_list,
-                       indices_list,
-                       mesh_list);
+        assimpLoadNode(
+          node->mChildren[j], scene, weld_table, indices_list, mesh_list);
     }
 }
 
 void
 assimpLoadMesh(aiMesh *mesh,
                aiScene const *scene,
-               std::unordered_map<Vertex, uint32_t> &unique_vertices,
-               std::vector<Vertex> &vertex_list,
+               VertexWeldTable &weld_table,
                std::vector<uint32_t> &indices_list,
                std::vector<Mesh> &mesh_list)
 {
@@ -87,66 +99,66 @@ assimpLoadMesh(aiMesh *mesh,
         loaded_mesh.max_point = loaded_mesh.min_point;
     }
 
-    // Vertices
-    uint32_t model_indices = unique_vertices.size();
+    // Vertices + Indices
+    indices_list.reserve(indices_list.size() + mesh->mNumVertices);
     for (size_t i = 0; i < mesh->mNumVertices; ++i) {
-        Vertex loaded_vertex{};
-
-        loaded_vertex.position = { mesh->mVertices[i].x,
-                                   mesh->mVertices[i].y,
-                                   mesh->mVertices[i].z };
-        loaded_vertex.normal = { mesh->mNormals[i].x,
-                                 mesh->mNormals[i].y,
-                                 mesh->mNormals[i].z };
-        if (mesh->HasTextureCoords(0)) {
-            loaded_vertex.tex_coords = { mesh->mTextureCoords[0][i].x,
-                                         mesh->mTextureCoords[0][i].y };
-            loaded_vertex.tangent = { mesh->mTangents[i].x,
-                                      mesh->mTangents[i].y,
-                                      mesh->mTangents[i].z };
-            loaded_vertex.bitangent = { mesh->mBitangents[i].x,
-                                        mesh->mBitangents[i].y,
-                                        mesh->mBitangents[i].z };
-        }
-        if (!unique_vertices.contains(loaded_vertex)) {
-            unique_vertices[loaded_vertex] = model_indices;
-            vertex_list.emplace_back(loaded_vertex);
-            ++model_indices;
-        }
-
-        // Indices
-        indices_list.emplace_back(unique_vertices[loaded_vertex]);
+        indices_list.emplace_back(weld_table.weld(assimpLoadVertex(mesh, i)));
         ++loaded_mesh.nb_indices;
 
-        // Min points
-        loaded_mesh.min_point.x =
-          (loaded_mesh.min_point.x > mesh->mVertices[i].x)
-            ? mesh->mVertices[i].x
-            : loaded_mesh.min_point.x;
-        loaded_mesh.min_point.y =
-          (loaded_mesh.min_point.y > mesh->mVertices[i].y)
-            ? mesh->mVertices[i].y
-            : loaded_mesh.min_point.y;
-        loaded_mesh.min_point.z =
-          (loaded_mesh.min_point.z > mesh->mVertices[i].z)
-            ? mesh->mVertices[i].z
-            : loaded_mesh.min_point.z;
-
-        // Max points
-        loaded_mesh.max_point.x =
-          (loaded_mesh.max_point.x < mesh->mVertices[i].x)
-            ? mesh->mVertices[i].x
-            : loaded_mesh.max_point.x;
-        loaded_mesh.max_point.y =
-          (loaded_mesh.max_point.y < mesh->mVertices[i].y)
-            ? mesh->mVertices[i].y
-            : loaded_mesh.max_point.y;
-        loaded_mesh.max_point.z =
-          (loaded_mesh.max_point.z < mesh->mVertices[i].z)
-            ? mesh->mVertices[i].z
-            : loaded_mesh.max_point.z;
+        assimpUpdateMinMaxPoints(
+          mesh->mVertices[i], loaded_mesh.min_point, loaded_mesh.max_point);
     }
 
+    assimpFinalizeMesh(mesh, scene, loaded_mesh);
+    mesh_list.emplace_back(loaded_mesh);
+}
+
+Vertex
+assimpLoadVertex(aiMesh const *mesh, size_t i)
+{
+    assert(mesh);
+    Vertex loaded_vertex{};
+
+    loaded_vertex.position = { mesh->mVertices[i].x,
+                               mesh->mVertices[i].y,
+                               mesh->mVertices[i].z };
+    loaded_vertex.normal = { mesh->mNormals[i].x,
+                             mesh->mNormals[i].y,
+                             mesh->mNormals[i].z };
+    if (mesh->HasTextureCoords(0)) {
+        loaded_vertex.tex_coords = { mesh->mTextureCoords[0][i].x,
+                                     mesh->mTextureCoords[0][i].y };
+        loaded_vertex.tangent = { mesh->mTangents[i].x,
+                                  mesh->mTangents[i].y,
+                                  mesh->mTangents[i].z };
+        loaded_vertex.bitangent = { mesh->mBitangents[i].x,
+                                    mesh->mBitangents[i].y,
+                                    mesh->mBitangents[i].z };
+    }
+    return (loaded_vertex);
+}
+
+void
+assimpUpdateMinMaxPoints(aiVector3D const &point,
+                         glm::vec3 &min_point,
+                         glm::vec3 &max_point)
+{
+    // Min points
+    min_point.x = (min_point.x > point.x) ? point.x : min_point.x;
+    min_point.y = (min_point.y > point.y) ? point.y : min_point.y;
+    min_point.z = (min_point.z > point.z) ? point.z : min_point.z;
+
+    // Max points
+    max_point.x = (max_point.x < point.x) ? point.x : max_point.x;
+    max_point.y = (max_point.y < point.y) ? point.y : max_point.y;
+    max_point.z = (max_point.z < point.z) ? point.z : max_point.z;
+}
+
+void
+assimpFinalizeMesh(aiMesh *mesh, aiScene const *scene, Mesh &loaded_mesh)
+{
+    assert(mesh && scene);
+
     // Center
     loaded_mesh.center = {
         (loaded_mesh.min_point.x + loaded_mesh.max_point.x) / 2.0f,
@@ -158,8 +170,48 @@ assimpLoadMesh(aiMesh *mesh,
     loaded_mesh.material = assimpLoadMaterial(mesh, scene);
     loaded_mesh.mesh_name = mesh->mName.C_Str();
     loaded_mesh.nb_faces = mesh->mNumFaces;
+}
 
-    mesh_list.emplace_back(loaded_mesh);
+void
+assimpCollectNodeMeshes(aiNode *node,
+                        aiScene const *scene,
+                        std::vector<aiMesh *> &meshes)
+{
+    assert(node && scene);
+    for (size_t i = 0; i < node->mNumMeshes; ++i) {
+        meshes.emplace_back(scene->mMeshes[node->mMeshes[i]]);
+    }
+    for (size_t j = 0; j < node->mNumChildren; ++j) {
+        assimpCollectNodeMeshes(node->mChildren[j], scene, meshes);
+    }
+}
+
+void
+assimpLoadMeshData(aiMesh *mesh, aiScene const *scene, ModelMeshData &data)
+{
+    assert(mesh && scene);
+    VertexWeldTable weld_table(data.vertex_list, mesh->mNumVertices);
+    auto &loaded_mesh = data.mesh;
+
+    // Init Min / Max point
+    if (mesh->mNumVertices) {
+        loaded_mesh.min_point = { mesh->mVertices[0].x,
+                                  mesh->mVertices[0].y,
+                                  mesh->mVertices[0].z };
+        loaded_mesh.max_point = loaded_mesh.min_point;
+    }
+
+    // Vertices + mesh local indices
+    data.indices_list.reserve(mesh->mNumVertices);
+    for (size_t i = 0; i < mesh->mNumVertices; ++i) {
+        data.indices_list.emplace_back(
+          weld_table.weld(assimpLoadVertex(mesh, i)));
+        ++loaded_mesh.nb_indices;
+
+        assimpUpdateMinMaxPoints(
+          mesh->mVertices[i], loaded_mesh.min_point, loaded_mesh.max_point);
+    }
+    assimpFinalizeMesh(mesh, scene, loaded_mesh);
 }
 
 Material
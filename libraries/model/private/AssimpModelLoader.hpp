@@ -2,25 +2,41 @@
 #define SCOP_VULKAN_ASSIMPMODELLOADER_HPP
 
 #include "Mesh.hpp"
+#include "ModelLoadingOption.hpp"
+#include "ModelMeshData.hpp"
+#include "WeldTable.hpp"
 
 #include "assimp/scene.h"
 
 void assimpLoadModel(char const *model_path,
                      std::vector<Vertex> &vertex_list,
                      std::vector<uint32_t> &indices_list,
-                     std::vector<Mesh> &mesh_list);
+                     std::vector<Mesh> &mesh_list,
+                     ModelLoadingOption const &option);
 void assimpLoadNode(aiNode *node,
                     aiScene const *scene,
-                    std::unordered_map<Vertex, uint32_t> &unique_vertices,
-                    std::vector<Vertex> &vertex_list,
+                    VertexWeldTable &weld_table,
                     std::vector<uint32_t> &indices_list,
                     std::vector<Mesh> &mesh_list);
 void assimpLoadMesh(aiMesh *mesh,
                     aiScene const *scene,
-                    std::unordered_map<Vertex, uint32_t> &unique_vertices,
-                    std::vector<Vertex> &vertex_list,
+                    VertexWeldTable &weld_table,
                     std::vector<uint32_t> &indices_list,
                     std::vector<Mesh> &mesh_list);
+Vertex assimpLoadVertex(aiMesh const *mesh, size_t i);
+void assimpUpdateMinMaxPoints(aiVector3D const &point,
+                              glm::vec3 &min_point,
+                              glm::vec3 &max_point);
+void assimpFinalizeMesh(aiMesh *mesh, aiScene const *scene, Mesh &loaded_mesh);
+
+// Parallel import related
+void assimpCollectNodeMeshes(aiNode *node,
+                             aiScene const *scene,
+                             std::vector<aiMesh *> &meshes);
+void assimpLoadMeshData(aiMesh *mesh,
+                        aiScene const *scene,
+                        ModelMeshData &data);
+
 Material assimpLoadMaterial(aiMesh *mesh, aiScene const *scene);
 std::string assimpGetTextureName(aiMaterial *mat, aiTextureType type);
 
@@ -0,0 +1,55 @@
+#include "MappedFile.hpp"
+
+#include <stdexcept>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+MappedFile::MappedFile(std::string const &filepath)
+{
+    int fd = open(filepath.c_str(), O_RDONLY);
+    if (fd < 0) {
+        throw std::runtime_error("MappedFile: Failed to open: " + filepath);
+    }
+
+    struct stat file_stat
+    {};
+    if (fstat(fd, &file_stat) < 0) {
+        close(fd);
+        throw std::runtime_error("MappedFile: Failed to stat: " + filepath);
+    }
+    _size = static_cast<size_t>(file_stat.st_size);
+    if (!_size) {
+        close(fd);
+        return;
+    }
+
+    _data = mmap(nullptr, _size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (_data == MAP_FAILED) {
+        _data = nullptr;
+        _size = 0;
+        throw std::runtime_error("MappedFile: Failed to map: " + filepath);
+    }
+}
+
+MappedFile::~MappedFile()
+{
+    if (_data) {
+        munmap(_data, _size);
+    }
+}
+
+uint8_t const *
+MappedFile::data() const
+{
+    return (static_cast<uint8_t const *>(_data));
+}
+
+size_t
+MappedFile::size() const
+{
+    return (_size);
+}
@@ -0,0 +1,28 @@
+#ifndef SCOP_VULKAN_MAPPEDFILE_HPP
+#define SCOP_VULKAN_MAPPEDFILE_HPP
+
+#include <cstdint>
+#include <cstddef>
+#include <string>
+
+// Read only memory mapping of a whole file
+class MappedFile final
+{
+  public:
+    MappedFile() = default;
+    explicit MappedFile(std::string const &filepath);
+    ~MappedFile();
+    MappedFile(MappedFile const &src) = delete;
+    MappedFile &operator=(MappedFile const &rhs) = delete;
+    MappedFile(MappedFile &&src) = delete;
+    MappedFile &operator=(MappedFile &&rhs) = delete;
+
+    [[nodiscard]] uint8_t const *data() const;
+    [[nodiscard]] size_t size() const;
+
+  private:
+    void *_data{};
+    size_t _size{};
+};
+
+#endif // SCOP_VULKAN_MAPPEDFILE_HPP
@@ -41,5 +41,13 @@ Mesh::printMesh() const
     fmt::print("\tNb Faces: {}\n", nb_faces);
     fmt::print("\tNb Indices: {}\n", nb_indices);
     fmt::print("\tIndices buffer offset: {}\n", indices_offset);
+    fmt::print("\tNb Clusters: {}\n", nb_clusters);
+    for (size_t i = 0; i < lods.size(); ++i) {
+        fmt::print("\tLod {}: {} indices at {} | error: {}\n",
+                   i + 1,
+                   lods[i].nb_indices,
+                   lods[i].indices_offset,
+                   lods[i].error);
+    }
     fmt::print("----- END MESH -----\n");
 }
@@ -0,0 +1,148 @@
+#include "MeshBatcher.hpp"
+
+#include <algorithm>
+
+void
+meshBuildBatches(std::vector<uint32_t> &indices_list,
+                 std::vector<Mesh> &mesh_list,
+                 std::vector<MeshBatch> &batch_list,
+                 ModelLoadingOption const &option)
+{
+    // Groups in order of first appearance, few materials are expected
+    std::vector<std::vector<uint32_t>> groups;
+    for (uint32_t i = 0; i < mesh_list.size(); ++i) {
+        auto group = groups.end();
+        if (option.batch_meshes) {
+            group = std::find_if(
+              groups.begin(),
+              groups.end(),
+              [&](std::vector<uint32_t> const &it) -> bool {
+                  return (meshBatchSameMaterial(mesh_list[it[0]].material,
+                                                mesh_list[i].material));
+              });
+        }
+        if (group == groups.end()) {
+            groups.emplace_back(1, i);
+        } else {
+            group->emplace_back(i);
+        }
+    }
+
+    // Rebuild, ranges are read from the previous list
+    std::vector<uint32_t> new_indices_list;
+    std::vector<Mesh> new_mesh_list;
+    new_indices_list.reserve(indices_list.size());
+    new_mesh_list.reserve(mesh_list.size());
+    batch_list.clear();
+    batch_list.reserve(groups.size());
+    auto append_range = [&](uint32_t offset, uint32_t nbIndices) -> uint32_t {
+        uint32_t new_offset = new_indices_list.size();
+        new_indices_list.insert(new_indices_list.end(),
+                                indices_list.begin() + offset,
+                                indices_list.begin() + offset + nbIndices);
+        return (new_offset);
+    };
+
+    for (auto const &group : groups) {
+        MeshBatch batch{};
+        batch.first_mesh = new_mesh_list.size();
+        batch.nb_meshes = group.size();
+        batch.indices_offset = new_indices_list.size();
+        batch.min_point = mesh_list[group[0]].min_point;
+        batch.max_point = mesh_list[group[0]].max_point;
+
+        // Full meshes
+        for (auto const &it : group) {
+            auto const &src = mesh_list[it];
+            auto &dst = new_mesh_list.emplace_back(src);
+
+            dst.indices_offset =
+              append_range(src.indices_offset, src.nb_indices);
+            batch.nb_indices += src.nb_indices;
+            batch.min_point = glm::min(batch.min_point, src.min_point);
+            batch.max_point = glm::max(batch.max_point, src.max_point);
+            batch.nb_lods = std::max<uint32_t>(
+              batch.nb_lods, std::min<size_t>(src.lods.size(), MAX_MESH_LODS));
+        }
+
+        // Lods, level by level
+        for (uint32_t j = 0; j < batch.nb_lods; ++j) {
+            auto &lod = batch.lods[j];
+            lod.indices_offset = new_indices_list.size();
+            for (uint32_t k = 0; k < group.size(); ++k) {
+                auto const &src = mesh_list[group[k]];
+                auto &dst = new_mesh_list[batch.first_mesh + k];
+
+                if (src.lods.empty()) {
+                    append_range(src.indices_offset, src.nb_indices);
+                    lod.nb_indices += src.nb_indices;
+                    continue;
+                }
+                auto level = std::min<size_t>(j, src.lods.size() - 1);
+                auto offset = append_range(src.lods[level].indices_offset,
+                                           src.lods[level].nb_indices);
+                if (level == j) {
+                    dst.lods[j].indices_offset = offset;
+                }
+                lod.nb_indices += src.lods[level].nb_indices;
+                lod.error = std::max(lod.error, src.lods[level].error);
+            }
+        }
+        batch_list.emplace_back(batch);
+    }
+
+    indices_list = std::move(new_indices_list);
+    mesh_list = std::move(new_mesh_list);
+}
+
+bool
+meshBatchSameMaterial(Material const &lhs, Material const &rhs)
+{
+    return (lhs.ambient == rhs.ambient && lhs.diffuse == rhs.diffuse &&
+            lhs.specular == rhs.specular && lhs.shininess == rhs.shininess &&
+            lhs.tex_ambient_name == rhs.tex_ambient_name &&
+            lhs.tex_diffuse_name == rhs.tex_diffuse_name &&
+            lhs.tex_specular_name == rhs.tex_specular_name &&
+            lhs.tex_normal_name == rhs.tex_normal_name &&
+            lhs.tex_alpha_name == rhs.tex_alpha_name);
+}
+
+void
+meshBatchSetClusters(std::vector<Mesh> const &mesh_list,
+                     std::vector<MeshBatch> &batch_list)
+{
+    for (auto &it : batch_list) {
+        it.clusters_offset = mesh_list[it.first_mesh].clusters_offset;
+        it.nb_clusters = 0;
+        for (uint32_t i = 0; i < it.nb_meshes; ++i) {
+            it.nb_clusters += mesh_list[it.first_mesh + i].nb_clusters;
+        }
+    }
+}
+
+void
+meshBatchGetMeshes(std::vector<Mesh> const &mesh_list,
+                   std::span<MeshBatch const> batch_list,
+                   std::vector<Mesh> &batched_mesh_list)
+{
+    batched_mesh_list.resize(batch_list.size());
+    for (size_t i = 0; i < batch_list.size(); ++i) {
+        auto const &src = batch_list[i];
+        auto &dst = batched_mesh_list[i];
+
+        dst = {};
+        dst.material = mesh_list[src.first_mesh].material;
+        dst.min_point = src.min_point;
+        dst.max_point = src.max_point;
+        dst.center = (src.min_point + src.max_point) * 0.5f;
+        for (uint32_t j = 0; j < src.nb_meshes; ++j) {
+            dst.nb_faces += mesh_list[src.first_mesh + j].nb_faces;
+        }
+        dst.nb_indices = src.nb_indices;
+        dst.indices_offset = src.indices_offset;
+        dst.lods.assign(src.lods, src.lods + src.nb_lods);
+        dst.nb_clusters = src.nb_clusters;
+        dst.clusters_offset = src.clusters_offset;
+        dst.mesh_name = dst.material.material_name;
+    }
+}
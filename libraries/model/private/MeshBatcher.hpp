@@ -0,0 +1,27 @@
+#ifndef SCOP_VULKAN_MESHBATCHER_HPP
+#define SCOP_VULKAN_MESHBATCHER_HPP
+
+#include <vector>
+#include <span>
+#include <cstdint>
+
+#include "Mesh.hpp"
+#include "ModelLoadingOption.hpp"
+
+// Reorders meshes by material in order of first appearance and rebuilds
+// the index list batch by batch. Without batch_meshes each mesh is its
+// own batch.
+void meshBuildBatches(std::vector<uint32_t> &indices_list,
+                      std::vector<Mesh> &mesh_list,
+                      std::vector<MeshBatch> &batch_list,
+                      ModelLoadingOption const &option);
+bool meshBatchSameMaterial(Material const &lhs, Material const &rhs);
+// Clusters are built per mesh, after batching
+void meshBatchSetClusters(std::vector<Mesh> const &mesh_list,
+                          std::vector<MeshBatch> &batch_list);
+// One mesh per batch holding its material, bounds and ranges
+void meshBatchGetMeshes(std::vector<Mesh> const &mesh_list,
+                        std::span<MeshBatch const> batch_list,
+                        std::vector<Mesh> &batched_mesh_list);
+
+#endif // SCOP_VULKAN_MESHBATCHER_HPP
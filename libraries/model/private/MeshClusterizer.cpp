@@ -0,0 +1,147 @@
+#include "MeshClusterizer.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+#include "ParallelFor.hpp"
+
+void
+meshBuildClusters(std::vector<Vertex> const &vertex_list,
+                  std::vector<uint32_t> const &indices_list,
+                  std::vector<Mesh> &mesh_list,
+                  std::vector<MeshCluster> &cluster_list,
+                  ModelLoadingOption const &option)
+{
+    std::vector<std::vector<MeshCluster>> meshes_clusters(mesh_list.size());
+    parallelFor(
+      mesh_list.size(),
+      [&](size_t i) -> void {
+          checkModelLoadingCancel(option.progress);
+          auto const &mesh = mesh_list[i];
+          meshBuildMeshClusters(
+            vertex_list,
+            std::span<uint32_t const>(indices_list)
+              .subspan(mesh.indices_offset, mesh.nb_indices),
+            mesh.indices_offset,
+            i,
+            meshes_clusters[i]);
+      },
+      (option.parallel_import) ? option.nb_import_threads : 1);
+
+    cluster_list.clear();
+    for (size_t i = 0; i < mesh_list.size(); ++i) {
+        mesh_list[i].clusters_offset = cluster_list.size();
+        mesh_list[i].nb_clusters = meshes_clusters[i].size();
+        cluster_list.insert(cluster_list.end(),
+                            meshes_clusters[i].begin(),
+                            meshes_clusters[i].end());
+    }
+}
+
+void
+meshBuildMeshClusters(std::vector<Vertex> const &vertex_list,
+                      std::span<uint32_t const> indices,
+                      uint32_t meshIndicesOffset,
+                      uint32_t meshIndex,
+                      std::vector<MeshCluster> &clusters)
+{
+    // Greedy scan, cache optimized order keeps triangles of a cluster
+    // close to each other
+    std::vector<uint32_t> cluster_vertices;
+    cluster_vertices.reserve(MAX_CLUSTER_VERTICES);
+    uint32_t cluster_begin = 0;
+
+    auto emit_cluster = [&](uint32_t end) -> void {
+        MeshCluster cluster{};
+        cluster.indices_offset = meshIndicesOffset + cluster_begin;
+        cluster.nb_indices = end - cluster_begin;
+        cluster.mesh_index = meshIndex;
+        meshComputeClusterBounds(
+          vertex_list, indices.subspan(cluster_begin, end - cluster_begin),
+          cluster);
+        clusters.emplace_back(cluster);
+        cluster_vertices.clear();
+        cluster_begin = end;
+    };
+
+    for (uint32_t i = 0; i + 2 < indices.size(); i += 3) {
+        uint32_t nb_new_vertices = 0;
+        for (uint32_t j = 0; j < 3; ++j) {
+            if (std::find(cluster_vertices.begin(),
+                          cluster_vertices.end(),
+                          indices[i + j]) == cluster_vertices.end()) {
+                ++nb_new_vertices;
+            }
+        }
+        if (cluster_vertices.size() + nb_new_vertices >
+              MAX_CLUSTER_VERTICES ||
+            (i - cluster_begin) / 3 >= MAX_CLUSTER_TRIANGLES) {
+            emit_cluster(i);
+        }
+        for (uint32_t j = 0; j < 3; ++j) {
+            if (std::find(cluster_vertices.begin(),
+                          cluster_vertices.end(),
+                          indices[i + j]) == cluster_vertices.end()) {
+                cluster_vertices.emplace_back(indices[i + j]);
+            }
+        }
+    }
+    if (cluster_begin < indices.size()) {
+        emit_cluster(indices.size());
+    }
+}
+
+void
+meshComputeClusterBounds(std::vector<Vertex> const &vertex_list,
+                         std::span<uint32_t const> indices,
+                         MeshCluster &cluster)
+{
+    // Sphere around the bounding box
+    auto min_point = vertex_list[indices[0]].position;
+    auto max_point = min_point;
+    for (auto const &it : indices) {
+        min_point = glm::min(min_point, vertex_list[it].position);
+        max_point = glm::max(max_point, vertex_list[it].position);
+    }
+    cluster.center = (min_point + max_point) * 0.5f;
+    cluster.radius = 0.0f;
+    for (auto const &it : indices) {
+        cluster.radius =
+          std::max(cluster.radius,
+                   glm::length(vertex_list[it].position - cluster.center));
+    }
+
+    // Normal cone, axis is the area weighted average normal
+    std::vector<glm::vec3> normals;
+    normals.reserve(indices.size() / 3);
+    glm::vec3 axis(0.0f);
+    for (size_t i = 0; i + 2 < indices.size(); i += 3) {
+        auto const &p0 = vertex_list[indices[i]].position;
+        auto const &p1 = vertex_list[indices[i + 1]].position;
+        auto const &p2 = vertex_list[indices[i + 2]].position;
+        auto normal = glm::cross(p1 - p0, p2 - p0);
+        auto length = glm::length(normal);
+
+        if (length > 0.0f) {
+            axis += normal;
+            normals.emplace_back(normal / length);
+        }
+    }
+
+    // Cutoff of 1 can never cull
+    cluster.cone_axis = glm::vec3(0.0f, 0.0f, 1.0f);
+    cluster.cone_cutoff = 1.0f;
+    auto axis_length = glm::length(axis);
+    if (axis_length <= 0.0f || normals.empty()) {
+        return;
+    }
+    axis /= axis_length;
+    float min_dot = 1.0f;
+    for (auto const &it : normals) {
+        min_dot = std::min(min_dot, glm::dot(axis, it));
+    }
+    cluster.cone_axis = axis;
+    if (min_dot > 0.0f) {
+        cluster.cone_cutoff = std::sqrt(1.0f - min_dot * min_dot);
+    }
+}
@@ -0,0 +1,32 @@
+#ifndef SCOP_VULKAN_MESHCLUSTERIZER_HPP
+#define SCOP_VULKAN_MESHCLUSTERIZER_HPP
+
+#include <vector>
+#include <span>
+#include <cstdint>
+
+#include "glm/glm.hpp"
+
+#include "Mesh.hpp"
+#include "ModelLoadingOption.hpp"
+
+// Cluster list is uploaded as is to the gpu
+static_assert(sizeof(MeshCluster) == 48);
+
+// Clusters follow the triangle order of each full mesh so the index
+// list is left untouched, the vertex cache pass should run first
+void meshBuildClusters(std::vector<Vertex> const &vertex_list,
+                       std::vector<uint32_t> const &indices_list,
+                       std::vector<Mesh> &mesh_list,
+                       std::vector<MeshCluster> &cluster_list,
+                       ModelLoadingOption const &option);
+void meshBuildMeshClusters(std::vector<Vertex> const &vertex_list,
+                           std::span<uint32_t const> indices,
+                           uint32_t meshIndicesOffset,
+                           uint32_t meshIndex,
+                           std::vector<MeshCluster> &clusters);
+void meshComputeClusterBounds(std::vector<Vertex> const &vertex_list,
+                              std::span<uint32_t const> indices,
+                              MeshCluster &cluster);
+
+#endif // SCOP_VULKAN_MESHCLUSTERIZER_HPP
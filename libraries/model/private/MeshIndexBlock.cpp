@@ -0,0 +1,68 @@
+#include "MeshIndexBlock.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+void
+buildMeshIndexBlocks(std::span<uint32_t const> indices_list,
+                     std::vector<Mesh> const &mesh_list,
+                     std::vector<MeshIndexBlock> &blocks,
+                     std::vector<uint8_t> &index_data)
+{
+    blocks.resize(mesh_list.size());
+    index_data.clear();
+
+    for (size_t i = 0; i < mesh_list.size(); ++i) {
+        auto const &mesh = mesh_list[i];
+        auto &block = blocks[i];
+        auto full_range =
+          indices_list.subspan(mesh.indices_offset, mesh.nb_indices);
+
+        // Lods only use vertices of their mesh
+        uint32_t min_index = UINT32_MAX;
+        uint32_t max_index = 0;
+        for (auto const &it : full_range) {
+            min_index = std::min(min_index, it);
+            max_index = std::max(max_index, it);
+        }
+        if (full_range.empty()) {
+            min_index = 0;
+        }
+
+        block = {};
+        block.offset = index_data.size();
+        if (max_index - min_index <= UINT16_MAX) {
+            block.index_size = sizeof(uint16_t);
+            block.vertex_offset = static_cast<int32_t>(min_index);
+        } else {
+            block.index_size = sizeof(uint32_t);
+            block.vertex_offset = 0;
+        }
+
+        uint32_t nb_block_indices = 0;
+        auto append_range = [&](uint32_t offset, uint32_t nbIndices) -> void {
+            auto src = indices_list.subspan(offset, nbIndices);
+            auto dst = index_data.size();
+
+            index_data.resize(dst + nbIndices * block.index_size);
+            for (auto const &it : src) {
+                if (block.index_size == sizeof(uint16_t)) {
+                    auto index = static_cast<uint16_t>(it - min_index);
+                    std::memcpy(&index_data[dst], &index, sizeof(uint16_t));
+                } else {
+                    std::memcpy(&index_data[dst], &it, sizeof(uint32_t));
+                }
+                dst += block.index_size;
+            }
+            nb_block_indices += nbIndices;
+        };
+        append_range(mesh.indices_offset, mesh.nb_indices);
+        for (size_t j = 0; j < mesh.lods.size(); ++j) {
+            block.levels_offset[j + 1] = nb_block_indices;
+            append_range(mesh.lods[j].indices_offset, mesh.lods[j].nb_indices);
+        }
+
+        // Bind offsets have to be a multiple of the index size
+        index_data.resize((index_data.size() + 3) / 4 * 4);
+    }
+}
@@ -0,0 +1,322 @@
+#include "MeshOptimizer.hpp"
+
+#include <algorithm>
+#include <numeric>
+
+#include "ParallelFor.hpp"
+#include "ModelMeshData.hpp"
+
+void
+meshOptimizeModel(std::vector<Vertex> &vertex_list,
+                  std::vector<uint32_t> &indices_list,
+                  std::vector<Mesh> const &mesh_list,
+                  ModelLoadingOption const &option,
+                  VertexCacheStats &before,
+                  VertexCacheStats &after)
+{
+    before =
+      meshAnalyzeVertexCache(indices_list, vertex_list.size(), mesh_list);
+
+    // Meshes and their lods own disjoint index ranges,
+    // vertices are only read
+    std::vector<MeshLod> ranges;
+    for (auto const &it : mesh_list) {
+        ranges.emplace_back(MeshLod{ it.nb_indices, it.indices_offset, 0.0f });
+        ranges.insert(ranges.end(), it.lods.begin(), it.lods.end());
+    }
+    std::span<uint32_t> indices(indices_list);
+    parallelFor(
+      ranges.size(),
+      [&](size_t i) -> void {
+          checkModelLoadingCancel(option.progress);
+          meshOptimizeMesh(
+            indices.subspan(ranges[i].indices_offset, ranges[i].nb_indices),
+            vertex_list,
+            option.optimize_overdraw);
+      },
+      (option.parallel_import) ? option.nb_import_threads : 1);
+    meshOptimizeVertexFetch(vertex_list, indices_list);
+
+    after =
+      meshAnalyzeVertexCache(indices_list, vertex_list.size(), mesh_list);
+}
+
+void
+meshOptimizeMesh(std::span<uint32_t> indices,
+                 std::vector<Vertex> const &vertex_list,
+                 bool optimizeOverdraw)
+{
+    // Line and point primitives kept by triangulation are left as is
+    if (indices.size() < 6 || indices.size() % 3) {
+        return;
+    }
+
+    // Mesh local vertex indices keep per mesh tables small
+    std::vector<uint32_t> local_to_model;
+    std::vector<uint32_t> local_indices;
+    getMeshLocalIndices(indices, local_to_model, local_indices);
+
+    std::vector<uint32_t> clusters;
+    meshOptimizeVertexCache(local_indices, local_to_model.size(), clusters);
+    if (optimizeOverdraw) {
+        std::vector<glm::vec3> positions(local_to_model.size());
+        for (size_t i = 0; i < local_to_model.size(); ++i) {
+            positions[i] = vertex_list[local_to_model[i]].position;
+        }
+        meshOptimizeOverdraw(local_indices, positions, clusters);
+    }
+
+    for (size_t i = 0; i < indices.size(); ++i) {
+        indices[i] = local_to_model[local_indices[i]];
+    }
+}
+
+void
+meshOptimizeVertexCache(std::vector<uint32_t> &indices,
+                        uint32_t nbVertices,
+                        std::vector<uint32_t> &clusters)
+{
+    auto nb_triangles = static_cast<uint32_t>(indices.size() / 3);
+
+    // Vertex to triangles adjacency
+    std::vector<uint32_t> live_triangles(nbVertices, 0);
+    for (auto const &it : indices) {
+        ++live_triangles[it];
+    }
+    std::vector<uint32_t> adjacency_offsets(nbVertices + 1, 0);
+    std::inclusive_scan(live_triangles.begin(),
+                        live_triangles.end(),
+                        adjacency_offsets.begin() + 1);
+    std::vector<uint32_t> adjacency(indices.size());
+    std::vector<uint32_t> fill_offsets(adjacency_offsets.begin(),
+                                       adjacency_offsets.end() - 1);
+    for (uint32_t i = 0; i < indices.size(); ++i) {
+        adjacency[fill_offsets[indices[i]]++] = i / 3;
+    }
+
+    std::vector<uint32_t> output;
+    output.reserve(indices.size());
+    std::vector<uint32_t> cache_timestamps(nbVertices, 0);
+    std::vector<bool> emitted(nb_triangles, false);
+    std::vector<uint32_t> dead_ends;
+    std::vector<uint32_t> candidates;
+    uint32_t timestamp = MESH_OPTIMIZER_CACHE_SIZE + 1;
+    uint32_t cursor = 0;
+    uint32_t fanning_vertex = indices[0];
+
+    clusters.clear();
+    clusters.emplace_back(0);
+    while (fanning_vertex != UINT32_MAX) {
+        candidates.clear();
+        for (uint32_t i = adjacency_offsets[fanning_vertex];
+             i < adjacency_offsets[fanning_vertex + 1];
+             ++i) {
+            auto triangle = adjacency[i];
+            if (emitted[triangle]) {
+                continue;
+            }
+            for (uint32_t j = 0; j < 3; ++j) {
+                auto vertex = indices[triangle * 3 + j];
+                output.emplace_back(vertex);
+                dead_ends.emplace_back(vertex);
+                candidates.emplace_back(vertex);
+                --live_triangles[vertex];
+                if (timestamp - cache_timestamps[vertex] >
+                    MESH_OPTIMIZER_CACHE_SIZE) {
+                    cache_timestamps[vertex] = timestamp++;
+                }
+            }
+            emitted[triangle] = true;
+        }
+
+        fanning_vertex = meshOptimizeNextVertex(
+          candidates, live_triangles, cache_timestamps, timestamp);
+        if (fanning_vertex == UINT32_MAX) {
+            fanning_vertex =
+              meshOptimizeSkipDeadEnd(dead_ends, live_triangles, cursor);
+            // Cache locality is lost, overdraw pass may move what follows
+            if (fanning_vertex != UINT32_MAX) {
+                clusters.emplace_back(output.size() / 3);
+            }
+        }
+    }
+    indices = std::move(output);
+}
+
+uint32_t
+meshOptimizeNextVertex(std::vector<uint32_t> const &candidates,
+                       std::vector<uint32_t> const &live_triangles,
+                       std::vector<uint32_t> const &cache_timestamps,
+                       uint32_t timestamp)
+{
+    // Oldest vertex that stays in cache while fanning its triangles
+    uint32_t best_vertex = UINT32_MAX;
+    int64_t best_priority = -1;
+    for (auto const &it : candidates) {
+        if (!live_triangles[it]) {
+            continue;
+        }
+        int64_t priority = 0;
+        if (timestamp - cache_timestamps[it] + 2 * live_triangles[it] <=
+            MESH_OPTIMIZER_CACHE_SIZE) {
+            priority = timestamp - cache_timestamps[it];
+        }
+        if (priority > best_priority) {
+            best_priority = priority;
+            best_vertex = it;
+        }
+    }
+    return (best_vertex);
+}
+
+uint32_t
+meshOptimizeSkipDeadEnd(std::vector<uint32_t> &dead_ends,
+                        std::vector<uint32_t> const &live_triangles,
+                        uint32_t &cursor)
+{
+    // Recently used vertices first, then next one in input order
+    while (!dead_ends.empty()) {
+        auto vertex = dead_ends.back();
+        dead_ends.pop_back();
+        if (live_triangles[vertex]) {
+            return (vertex);
+        }
+    }
+    for (; cursor < live_triangles.size(); ++cursor) {
+        if (live_triangles[cursor]) {
+            return (cursor);
+        }
+    }
+    return (UINT32_MAX);
+}
+
+void
+meshOptimizeOverdraw(std::vector<uint32_t> &indices,
+                     std::vector<glm::vec3> const &positions,
+                     std::vector<uint32_t> const &clusters)
+{
+    if (clusters.size() < 2) {
+        return;
+    }
+
+    auto nb_triangles = static_cast<uint32_t>(indices.size() / 3);
+    std::vector<glm::vec3> cluster_centers(clusters.size(), glm::vec3(0.0f));
+    std::vector<glm::vec3> cluster_normals(clusters.size(), glm::vec3(0.0f));
+    std::vector<float> cluster_areas(clusters.size(), 0.0f);
+    glm::vec3 mesh_center(0.0f);
+    float mesh_area = 0.0f;
+
+    // Area weighted centers and normals
+    for (size_t i = 0; i < clusters.size(); ++i) {
+        auto end = (i + 1 < clusters.size()) ? clusters[i + 1] : nb_triangles;
+        for (uint32_t j = clusters[i]; j < end; ++j) {
+            auto const &p0 = positions[indices[j * 3]];
+            auto const &p1 = positions[indices[j * 3 + 1]];
+            auto const &p2 = positions[indices[j * 3 + 2]];
+            auto normal = glm::cross(p1 - p0, p2 - p0);
+            auto area = glm::length(normal);
+
+            cluster_centers[i] += (p0 + p1 + p2) * (area / 3.0f);
+            cluster_normals[i] += normal;
+            cluster_areas[i] += area;
+        }
+        mesh_center += cluster_centers[i];
+        mesh_area += cluster_areas[i];
+        if (cluster_areas[i] > 0.0f) {
+            cluster_centers[i] /= cluster_areas[i];
+        }
+    }
+    if (mesh_area > 0.0f) {
+        mesh_center /= mesh_area;
+    }
+
+    std::vector<float> sort_keys(clusters.size(), 0.0f);
+    for (size_t i = 0; i < clusters.size(); ++i) {
+        auto normal_length = glm::length(cluster_normals[i]);
+        if (normal_length > 0.0f) {
+            sort_keys[i] =
+              glm::dot(cluster_centers[i] - mesh_center, cluster_normals[i]) /
+              normal_length;
+        }
+    }
+    std::vector<uint32_t> order(clusters.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(
+      order.begin(), order.end(), [&](uint32_t lhs, uint32_t rhs) -> bool {
+          return (sort_keys[lhs] > sort_keys[rhs]);
+      });
+
+    std::vector<uint32_t> output;
+    output.reserve(indices.size());
+    for (auto const &it : order) {
+        auto end = (it + 1 < clusters.size()) ? clusters[it + 1] : nb_triangles;
+        output.insert(output.end(),
+                      indices.begin() + clusters[it] * 3,
+                      indices.begin() + end * 3);
+    }
+    indices = std::move(output);
+}
+
+void
+meshOptimizeVertexFetch(std::vector<Vertex> &vertex_list,
+                        std::vector<uint32_t> &indices_list)
+{
+    std::vector<uint32_t> remap(vertex_list.size(), UINT32_MAX);
+    std::vector<Vertex> fetch_ordered;
+    fetch_ordered.reserve(vertex_list.size());
+
+    for (auto &it : indices_list) {
+        if (remap[it] == UINT32_MAX) {
+            remap[it] = static_cast<uint32_t>(fetch_ordered.size());
+            fetch_ordered.emplace_back(vertex_list[it]);
+        }
+        it = remap[it];
+    }
+    vertex_list = std::move(fetch_ordered);
+}
+
+VertexCacheStats
+meshAnalyzeVertexCache(std::span<uint32_t const> indices_list,
+                       size_t nbVertices,
+                       std::vector<Mesh> const &mesh_list)
+{
+    // FIFO cache is emptied between draws, a vertex is cached while
+    // less than cache size vertices were transformed after it
+    std::vector<uint32_t> cache_timestamps(nbVertices, 0);
+    std::vector<uint32_t> last_mesh_seen(nbVertices, 0);
+    uint32_t timestamp = MESH_OPTIMIZER_CACHE_SIZE + 1;
+    uint64_t nb_transforms = 0;
+    uint64_t nb_unique = 0;
+    uint64_t nb_triangles = 0;
+
+    for (uint32_t i = 0; i < mesh_list.size(); ++i) {
+        auto const &mesh = mesh_list[i];
+        auto mesh_indices =
+          indices_list.subspan(mesh.indices_offset, mesh.nb_indices);
+
+        for (auto const &it : mesh_indices) {
+            if (last_mesh_seen[it] != i + 1) {
+                last_mesh_seen[it] = i + 1;
+                ++nb_unique;
+            }
+            if (!cache_timestamps[it] ||
+                timestamp - cache_timestamps[it] > MESH_OPTIMIZER_CACHE_SIZE) {
+                cache_timestamps[it] = timestamp++;
+                ++nb_transforms;
+            }
+        }
+        nb_triangles += mesh_indices.size() / 3;
+        timestamp += MESH_OPTIMIZER_CACHE_SIZE;
+    }
+
+    VertexCacheStats stats{};
+    if (nb_triangles) {
+        stats.acmr = static_cast<float>(nb_transforms) /
+                     static_cast<float>(nb_triangles);
+    }
+    if (nb_unique) {
+        stats.atvr =
+          static_cast<float>(nb_transforms) / static_cast<float>(nb_unique);
+    }
+    return (stats);
+}
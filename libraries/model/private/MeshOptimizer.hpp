@@ -0,0 +1,63 @@
+#ifndef SCOP_VULKAN_MESHOPTIMIZER_HPP
+#define SCOP_VULKAN_MESHOPTIMIZER_HPP
+
+#include <vector>
+#include <span>
+#include <cstdint>
+
+#include "glm/glm.hpp"
+
+#include "Mesh.hpp"
+#include "ModelLoadingOption.hpp"
+
+// Simulated post-transform cache, FIFO of recent GPUs
+static constexpr uint32_t const MESH_OPTIMIZER_CACHE_SIZE = 16;
+
+struct VertexCacheStats final
+{
+    // Average transformed vertices per triangle, 0.5 is the best case
+    float acmr{};
+    // Average transforms per unique vertex of a draw, 1.0 is the best case
+    float atvr{};
+};
+
+// Reorders triangles of each mesh and lod then vertices of the model in
+// fetch order. Vertices not referenced by any mesh are removed.
+// Stats only cover full detail meshes.
+void meshOptimizeModel(std::vector<Vertex> &vertex_list,
+                       std::vector<uint32_t> &indices_list,
+                       std::vector<Mesh> const &mesh_list,
+                       ModelLoadingOption const &option,
+                       VertexCacheStats &before,
+                       VertexCacheStats &after);
+
+// Per mesh passes, indices are mesh local in [0, nbVertices)
+void meshOptimizeMesh(std::span<uint32_t> indices,
+                      std::vector<Vertex> const &vertex_list,
+                      bool optimizeOverdraw);
+// Tipsify, clusters receive the first triangle of each cache restart
+void meshOptimizeVertexCache(std::vector<uint32_t> &indices,
+                             uint32_t nbVertices,
+                             std::vector<uint32_t> &clusters);
+uint32_t meshOptimizeNextVertex(
+  std::vector<uint32_t> const &candidates,
+  std::vector<uint32_t> const &live_triangles,
+  std::vector<uint32_t> const &cache_timestamps,
+  uint32_t timestamp);
+uint32_t meshOptimizeSkipDeadEnd(std::vector<uint32_t> &dead_ends,
+                                 std::vector<uint32_t> const &live_triangles,
+                                 uint32_t &cursor);
+// Sorts clusters so outward facing ones are drawn first
+void meshOptimizeOverdraw(std::vector<uint32_t> &indices,
+                          std::vector<glm::vec3> const &positions,
+                          std::vector<uint32_t> const &clusters);
+
+// Model wide passes
+void meshOptimizeVertexFetch(std::vector<Vertex> &vertex_list,
+                             std::vector<uint32_t> &indices_list);
+VertexCacheStats meshAnalyzeVertexCache(
+  std::span<uint32_t const> indices_list,
+  size_t nbVertices,
+  std::vector<Mesh> const &mesh_list);
+
+#endif // SCOP_VULKAN_MESHOPTIMIZER_HPP
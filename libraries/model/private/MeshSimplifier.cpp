@@ -0,0 +1,375 @@
+#include "MeshSimplifier.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+#include "ParallelFor.hpp"
+#include "ModelMeshData.hpp"
+
+void
+meshGenerateLods(std::vector<Vertex> const &vertex_list,
+                 std::vector<uint32_t> &indices_list,
+                 std::vector<Mesh> &mesh_list,
+                 ModelLoadingOption const &option)
+{
+    auto nb_lods = std::min(option.nb_lods, MAX_MESH_LODS);
+    if (!nb_lods || option.lod_reduction_ratio <= 0.0f ||
+        option.lod_reduction_ratio >= 1.0f) {
+        return;
+    }
+
+    std::vector<std::vector<SimplifierLevel>> meshes_levels(mesh_list.size());
+    parallelFor(
+      mesh_list.size(),
+      [&](size_t i) -> void {
+          checkModelLoadingCancel(option.progress);
+          auto const &mesh = mesh_list[i];
+          std::vector<uint32_t> local_to_model;
+          std::vector<uint32_t> local_indices;
+          getMeshLocalIndices(
+            std::span<uint32_t const>(indices_list)
+              .subspan(mesh.indices_offset, mesh.nb_indices),
+            local_to_model,
+            local_indices);
+
+          std::vector<glm::vec3> positions(local_to_model.size());
+          for (size_t j = 0; j < local_to_model.size(); ++j) {
+              positions[j] = vertex_list[local_to_model[j]].position;
+          }
+          std::vector<uint32_t> targets;
+          auto nb_triangles = static_cast<float>(mesh.nb_indices / 3);
+          for (uint32_t j = 0; j < nb_lods; ++j) {
+              nb_triangles *= option.lod_reduction_ratio;
+              targets.emplace_back(static_cast<uint32_t>(nb_triangles) * 3);
+          }
+
+          meshSimplify(local_indices, positions, targets, meshes_levels[i]);
+          for (auto &level : meshes_levels[i]) {
+              for (auto &it : level.indices) {
+                  it = local_to_model[it];
+              }
+          }
+      },
+      (option.parallel_import) ? option.nb_import_threads : 1);
+
+    // Appended in mesh order so the output does not depend on threading
+    for (size_t i = 0; i < mesh_list.size(); ++i) {
+        auto &mesh = mesh_list[i];
+        auto previous_nb_indices = static_cast<float>(mesh.nb_indices);
+
+        mesh.lods.clear();
+        for (auto const &it : meshes_levels[i]) {
+            auto max_nb_indices =
+              previous_nb_indices * (1.0f - MESH_SIMPLIFIER_MIN_REDUCTION);
+            if (it.indices.empty() ||
+                static_cast<float>(it.indices.size()) > max_nb_indices) {
+                continue;
+            }
+            mesh.lods.emplace_back(
+              MeshLod{ static_cast<uint32_t>(it.indices.size()),
+                       static_cast<uint32_t>(indices_list.size()),
+                       it.error });
+            indices_list.insert(
+              indices_list.end(), it.indices.begin(), it.indices.end());
+            previous_nb_indices = static_cast<float>(it.indices.size());
+        }
+    }
+}
+
+void
+meshSimplify(std::vector<uint32_t> const &indices,
+             std::vector<glm::vec3> const &positions,
+             std::vector<uint32_t> const &targetNbIndices,
+             std::vector<SimplifierLevel> &levels)
+{
+    std::vector<uint32_t> current = indices;
+    std::vector<SimplifierQuadric> quadrics;
+    std::vector<bool> locked;
+    double max_cost = 0.0;
+
+    meshSimplifyComputeQuadrics(indices, positions, quadrics);
+    meshSimplifyLockBorders(indices, locked);
+    levels.clear();
+
+    // Levels are snapshots of a single progressive simplification
+    size_t level = 0;
+    while (level < targetNbIndices.size()) {
+        if (current.size() <= targetNbIndices[level]) {
+            levels.emplace_back(SimplifierLevel{
+              current, static_cast<float>(std::sqrt(max_cost)) });
+            ++level;
+            continue;
+        }
+        if (!meshSimplifyPass(current,
+                              positions,
+                              quadrics,
+                              locked,
+                              targetNbIndices[level],
+                              max_cost)) {
+            // Stuck, what was reached is still worth a level
+            levels.emplace_back(SimplifierLevel{
+              current, static_cast<float>(std::sqrt(max_cost)) });
+            break;
+        }
+    }
+}
+
+void
+meshSimplifyComputeQuadrics(std::vector<uint32_t> const &indices,
+                            std::vector<glm::vec3> const &positions,
+                            std::vector<SimplifierQuadric> &quadrics)
+{
+    quadrics.assign(positions.size(), SimplifierQuadric{});
+    for (size_t i = 0; i + 2 < indices.size(); i += 3) {
+        glm::dvec3 p0 = positions[indices[i]];
+        glm::dvec3 p1 = positions[indices[i + 1]];
+        glm::dvec3 p2 = positions[indices[i + 2]];
+        auto normal = glm::cross(p1 - p0, p2 - p0);
+        auto length = glm::length(normal);
+        if (length <= 0.0) {
+            continue;
+        }
+
+        auto area = length * 0.5;
+        normal /= length;
+        auto d = -glm::dot(normal, p0);
+        SimplifierQuadric plane = { area,
+                                    area * normal.x * normal.x,
+                                    area * normal.x * normal.y,
+                                    area * normal.x * normal.z,
+                                    area * normal.x * d,
+                                    area * normal.y * normal.y,
+                                    area * normal.y * normal.z,
+                                    area * normal.y * d,
+                                    area * normal.z * normal.z,
+                                    area * normal.z * d,
+                                    area * d * d };
+        for (uint32_t j = 0; j < 3; ++j) {
+            meshSimplifyAddQuadric(quadrics[indices[i + j]], plane);
+        }
+    }
+}
+
+void
+meshSimplifyLockBorders(std::vector<uint32_t> const &indices,
+                        std::vector<bool> &locked)
+{
+    uint32_t nb_vertices = 0;
+    std::vector<uint64_t> edges;
+    edges.reserve(indices.size());
+    for (size_t i = 0; i + 2 < indices.size(); i += 3) {
+        for (uint32_t j = 0; j < 3; ++j) {
+            uint64_t a = indices[i + j];
+            uint64_t b = indices[i + (j + 1) % 3];
+            edges.emplace_back((a < b) ? (a << 32 | b) : (b << 32 | a));
+            nb_vertices = std::max(nb_vertices, indices[i + j] + 1);
+        }
+    }
+    std::sort(edges.begin(), edges.end());
+
+    // Edges not shared by exactly two triangles are borders or seams
+    locked.assign(nb_vertices, false);
+    for (size_t i = 0; i < edges.size();) {
+        size_t j = i + 1;
+        while (j < edges.size() && edges[j] == edges[i]) {
+            ++j;
+        }
+        if (j - i != 2) {
+            locked[edges[i] >> 32] = true;
+            locked[edges[i] & UINT32_MAX] = true;
+        }
+        i = j;
+    }
+}
+
+uint32_t
+meshSimplifyPass(std::vector<uint32_t> &indices,
+                 std::vector<glm::vec3> const &positions,
+                 std::vector<SimplifierQuadric> &quadrics,
+                 std::vector<bool> const &locked,
+                 uint32_t targetNbIndices,
+                 double &maxCost)
+{
+    auto is_degenerate = [&](size_t triangle) -> bool {
+        auto const *tri = &indices[triangle * 3];
+        return (tri[0] == tri[1] || tri[1] == tri[2] || tri[0] == tri[2]);
+    };
+
+    // Vertex to triangles adjacency
+    std::vector<uint32_t> adjacency_offsets(positions.size() + 1, 0);
+    for (auto const &it : indices) {
+        ++adjacency_offsets[it + 1];
+    }
+    for (size_t i = 1; i < adjacency_offsets.size(); ++i) {
+        adjacency_offsets[i] += adjacency_offsets[i - 1];
+    }
+    std::vector<uint32_t> adjacency(indices.size());
+    std::vector<uint32_t> fill_offsets(adjacency_offsets.begin(),
+                                       adjacency_offsets.end() - 1);
+    for (uint32_t i = 0; i < indices.size(); ++i) {
+        adjacency[fill_offsets[indices[i]]++] = i / 3;
+    }
+
+    // Cheapest direction of each edge
+    std::vector<uint64_t> edges;
+    edges.reserve(indices.size());
+    for (size_t i = 0; i < indices.size(); i += 3) {
+        for (uint32_t j = 0; j < 3; ++j) {
+            uint64_t a = indices[i + j];
+            uint64_t b = indices[i + (j + 1) % 3];
+            edges.emplace_back((a < b) ? (a << 32 | b) : (b << 32 | a));
+        }
+    }
+    std::sort(edges.begin(), edges.end());
+    edges.erase(std::unique(edges.begin(), edges.end()), edges.end());
+
+    std::vector<SimplifierCollapse> collapses;
+    collapses.reserve(edges.size());
+    for (auto const &it : edges) {
+        auto a = static_cast<uint32_t>(it >> 32);
+        auto b = static_cast<uint32_t>(it & UINT32_MAX);
+        if (locked[a] && locked[b]) {
+            continue;
+        }
+
+        auto merged = quadrics[a];
+        meshSimplifyAddQuadric(merged, quadrics[b]);
+        auto cost_to_b = (locked[a])
+                           ? INFINITY
+                           : meshSimplifyEvalQuadric(merged, positions[b]);
+        auto cost_to_a = (locked[b])
+                           ? INFINITY
+                           : meshSimplifyEvalQuadric(merged, positions[a]);
+        if (cost_to_b <= cost_to_a) {
+            collapses.emplace_back(SimplifierCollapse{ cost_to_b, a, b });
+        } else {
+            collapses.emplace_back(SimplifierCollapse{ cost_to_a, b, a });
+        }
+    }
+    std::sort(collapses.begin(),
+              collapses.end(),
+              [](SimplifierCollapse const &lhs, SimplifierCollapse const &rhs)
+                -> bool { return (lhs.cost < rhs.cost); });
+
+    // Only the cheapest part of the edges per pass, later collapses
+    // are evaluated again with the merged quadrics
+    auto nb_triangles = static_cast<uint32_t>(indices.size() / 3);
+    auto target_nb_triangles = targetNbIndices / 3;
+    auto max_collapses = std::max<size_t>(collapses.size() / 4, 1);
+    uint32_t nb_collapses = 0;
+    std::vector<bool> touched(positions.size(), false);
+    for (auto const &it : collapses) {
+        if (nb_triangles <= target_nb_triangles ||
+            nb_collapses >= max_collapses) {
+            break;
+        }
+        if (touched[it.from] || touched[it.to]) {
+            continue;
+        }
+        auto triangles = std::span<uint32_t const>(adjacency).subspan(
+          adjacency_offsets[it.from],
+          adjacency_offsets[it.from + 1] - adjacency_offsets[it.from]);
+        if (meshSimplifyFlips(indices, positions, triangles, it)) {
+            continue;
+        }
+
+        for (auto const &triangle : triangles) {
+            if (is_degenerate(triangle)) {
+                continue;
+            }
+            for (uint32_t j = 0; j < 3; ++j) {
+                if (indices[triangle * 3 + j] == it.from) {
+                    indices[triangle * 3 + j] = it.to;
+                }
+            }
+            if (is_degenerate(triangle)) {
+                --nb_triangles;
+            }
+        }
+        meshSimplifyAddQuadric(quadrics[it.to], quadrics[it.from]);
+        touched[it.from] = true;
+        touched[it.to] = true;
+        if (quadrics[it.to].weight > 0.0) {
+            maxCost = std::max(maxCost, it.cost / quadrics[it.to].weight);
+        }
+        ++nb_collapses;
+    }
+
+    // Removing collapsed triangles
+    size_t dst = 0;
+    for (size_t i = 0; i < indices.size() / 3; ++i) {
+        if (!is_degenerate(i)) {
+            indices[dst * 3] = indices[i * 3];
+            indices[dst * 3 + 1] = indices[i * 3 + 1];
+            indices[dst * 3 + 2] = indices[i * 3 + 2];
+            ++dst;
+        }
+    }
+    indices.resize(dst * 3);
+    return (nb_collapses);
+}
+
+bool
+meshSimplifyFlips(std::vector<uint32_t> const &indices,
+                  std::vector<glm::vec3> const &positions,
+                  std::span<uint32_t const> triangles,
+                  SimplifierCollapse const &collapse)
+{
+    for (auto const &it : triangles) {
+        auto const *tri = &indices[it * 3];
+        if (tri[0] == tri[1] || tri[1] == tri[2] || tri[0] == tri[2] ||
+            tri[0] == collapse.to || tri[1] == collapse.to ||
+            tri[2] == collapse.to) {
+            continue;
+        }
+
+        glm::vec3 before[3];
+        glm::vec3 after[3];
+        for (uint32_t j = 0; j < 3; ++j) {
+            before[j] = positions[tri[j]];
+            after[j] = (tri[j] == collapse.from) ? positions[collapse.to]
+                                                 : before[j];
+        }
+        auto normal_before =
+          glm::cross(before[1] - before[0], before[2] - before[0]);
+        auto normal_after =
+          glm::cross(after[1] - after[0], after[2] - after[0]);
+        if (glm::dot(normal_before, normal_after) <= 0.0f) {
+            return (true);
+        }
+    }
+    return (false);
+}
+
+void
+meshSimplifyAddQuadric(SimplifierQuadric &dst, SimplifierQuadric const &src)
+{
+    dst.weight += src.weight;
+    dst.a2 += src.a2;
+    dst.ab += src.ab;
+    dst.ac += src.ac;
+    dst.ad += src.ad;
+    dst.b2 += src.b2;
+    dst.bc += src.bc;
+    dst.bd += src.bd;
+    dst.c2 += src.c2;
+    dst.cd += src.cd;
+    dst.d2 += src.d2;
+}
+
+double
+meshSimplifyEvalQuadric(SimplifierQuadric const &quadric,
+                        glm::vec3 const &point)
+{
+    double x = point.x;
+    double y = point.y;
+    double z = point.z;
+
+    // v^T Q v with v = (x, y, z, 1)
+    auto cost = quadric.a2 * x * x + 2.0 * quadric.ab * x * y +
+                2.0 * quadric.ac * x * z + 2.0 * quadric.ad * x +
+                quadric.b2 * y * y + 2.0 * quadric.bc * y * z +
+                2.0 * quadric.bd * y + quadric.c2 * z * z +
+                2.0 * quadric.cd * z + quadric.d2;
+    return ((cost > 0.0) ? cost : 0.0);
+}
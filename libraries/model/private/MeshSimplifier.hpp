@@ -0,0 +1,81 @@
+#ifndef SCOP_VULKAN_MESHSIMPLIFIER_HPP
+#define SCOP_VULKAN_MESHSIMPLIFIER_HPP
+
+#include <vector>
+#include <span>
+#include <cstdint>
+
+#include "glm/glm.hpp"
+
+#include "Mesh.hpp"
+#include "ModelLoadingOption.hpp"
+
+// Levels removing less than this share of the previous level triangles
+// are not worth an extra range
+static constexpr float const MESH_SIMPLIFIER_MIN_REDUCTION = 0.15f;
+
+// Symmetric 4x4 matrix of area weighted squared plane distances,
+// weight is the summed area to get back a mean distance
+struct SimplifierQuadric final
+{
+    double weight;
+    double a2;
+    double ab;
+    double ac;
+    double ad;
+    double b2;
+    double bc;
+    double bd;
+    double c2;
+    double cd;
+    double d2;
+};
+
+struct SimplifierCollapse final
+{
+    double cost;
+    uint32_t from;
+    uint32_t to;
+};
+
+struct SimplifierLevel final
+{
+    std::vector<uint32_t> indices;
+    float error;
+};
+
+// Appends the levels of every mesh after the current indices and fills
+// Mesh::lods. Levels only reference vertices of their full mesh.
+void meshGenerateLods(std::vector<Vertex> const &vertex_list,
+                      std::vector<uint32_t> &indices_list,
+                      std::vector<Mesh> &mesh_list,
+                      ModelLoadingOption const &option);
+
+// Mesh local indices in [0, positions.size()), vertices are collapsed
+// onto existing ones. Vertices on open edges, including attribute seams,
+// are never removed.
+void meshSimplify(std::vector<uint32_t> const &indices,
+                  std::vector<glm::vec3> const &positions,
+                  std::vector<uint32_t> const &targetNbIndices,
+                  std::vector<SimplifierLevel> &levels);
+void meshSimplifyComputeQuadrics(std::vector<uint32_t> const &indices,
+                                 std::vector<glm::vec3> const &positions,
+                                 std::vector<SimplifierQuadric> &quadrics);
+void meshSimplifyLockBorders(std::vector<uint32_t> const &indices,
+                             std::vector<bool> &locked);
+uint32_t meshSimplifyPass(std::vector<uint32_t> &indices,
+                          std::vector<glm::vec3> const &positions,
+                          std::vector<SimplifierQuadric> &quadrics,
+                          std::vector<bool> const &locked,
+                          uint32_t targetNbIndices,
+                          double &maxCost);
+bool meshSimplifyFlips(std::vector<uint32_t> const &indices,
+                       std::vector<glm::vec3> const &positions,
+                       std::span<uint32_t const> triangles,
+                       SimplifierCollapse const &collapse);
+void meshSimplifyAddQuadric(SimplifierQuadric &dst,
+                            SimplifierQuadric const &src);
+double meshSimplifyEvalQuadric(SimplifierQuadric const &quadric,
+                               glm::vec3 const &point);
+
+#endif // SCOP_VULKAN_MESHSIMPLIFIER_HPP
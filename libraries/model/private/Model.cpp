@@ -1,23 +1,32 @@
 #include "Model.hpp"
 
 #include <cstring>
+#include <cassert>
+#include <stdexcept>
 
 #include "fmt/core.h"
 
 #include "AssimpModelLoader.hpp"
+#include "ObjModelLoader.hpp"
+#include "ModelCache.hpp"
+#include "MeshOptimizer.hpp"
+#include "MeshSimplifier.hpp"
+#include "MeshClusterizer.hpp"
+#include "MeshBatcher.hpp"
 
-Model::Model(const std::string &model_path)
+Model::Model(const std::string &model_path, ModelLoadingOption const &option)
 {
-    loadModel(model_path.c_str());
+    loadModel(model_path.c_str(), option);
 }
 
-Model::Model(const char *model_path)
+Model::Model(const char *model_path, ModelLoadingOption const &option)
 {
-    loadModel(model_path);
+    loadModel(model_path, option);
 }
 
 void
-Model::loadModel(const std::string &model_path)
+Model::loadModel(const std::string &model_path,
+                 ModelLoadingOption const &option)
 {
     _model_path = model_path;
     auto pos = model_path.find_last_of('/');
@@ -26,13 +35,11 @@ Model::loadModel(const std::string &model_path)
     } else {
         _directory = model_path.substr(0, pos);
     }
-    assimpLoadModel(
-      model_path.c_str(), _vertex_list, _indices_list, _mesh_list);
-    _compute_min_max_points_and_center();
+    _load_model(option);
 }
 
 void
-Model::loadModel(const char *model_path)
+Model::loadModel(const char *model_path, ModelLoadingOption const &option)
 {
     assert(model_path);
     _model_path = model_path;
@@ -43,8 +50,7 @@ Model::loadModel(const char *model_path)
         uintptr_t size = pos - model_path;
         _directory = std::string(model_path, size);
     }
-    assimpLoadModel(model_path, _vertex_list, _indices_list, _mesh_list);
-    _compute_min_max_points_and_center();
+    _load_model(option);
 }
 
 void
@@ -54,6 +60,7 @@ Model::printModel() const
     fmt::print("Model Path: {}\n", _model_path);
     fmt::print("Model Directory: {}\n", _directory);
     fmt::print("Model Nb Faces: {}\n", _nb_faces);
+    fmt::print("Model Nb Batches: {}\n", _batched_mesh_list.size());
     fmt::print("Model Min Point: ( {} | {} | {} )\n",
                _min_point.x,
                _min_point.y,
@@ -64,6 +71,14 @@ Model::printModel() const
                _max_point.z);
     fmt::print(
       "Model Center: ( {} | {} | {} )\n", _center.x, _center.y, _center.z);
+    if (_optimization_info.optimized) {
+        fmt::print("Model ACMR: {} -> {}\n",
+                   _optimization_info.acmrBefore,
+                   _optimization_info.acmrAfter);
+        fmt::print("Model ATVR: {} -> {}\n",
+                   _optimization_info.atvrBefore,
+                   _optimization_info.atvrAfter);
+    }
     for (auto const &it : _mesh_list) {
         it.printMesh();
     }
@@ -73,30 +88,71 @@ Model::printModel() const
 ModelInfo
 Model::getModelInfo() const
 {
-    ModelInfo info = { static_cast<uint32_t>(_vertex_list.size()),
-                       static_cast<uint32_t>(_indices_list.size()),
+    // Lod ranges are not part of the model indices count
+    uint32_t nb_indices = 0;
+    for (auto const &it : _mesh_list) {
+        nb_indices += it.nb_indices;
+    }
+    ModelInfo info = { static_cast<uint32_t>(getVertexList().size()),
+                       nb_indices,
                        _nb_faces };
     return (info);
 }
 
-std::vector<Vertex> const &
+ModelOptimizationInfo const &
+Model::getOptimizationInfo() const
+{
+    return (_optimization_info);
+}
+
+std::span<Vertex const>
 Model::getVertexList() const
 {
+    if (_cache_file) {
+        return (_cached_vertex_list);
+    }
     return (_vertex_list);
 }
 
-std::vector<uint32_t> const &
+std::span<uint32_t const>
 Model::getIndicesList() const
 {
+    if (_cache_file) {
+        return (_cached_indices_list);
+    }
     return (_indices_list);
 }
 
+std::span<MeshCluster const>
+Model::getClusterList() const
+{
+    if (_cache_file) {
+        return (_cached_cluster_list);
+    }
+    return (_cluster_list);
+}
+
 std::vector<Mesh> const &
 Model::getMeshList() const
 {
     return (_mesh_list);
 }
 
+std::span<MeshBatch const>
+Model::getMeshBatchList() const
+{
+    if (_cache_file) {
+        return (_cached_batch_list);
+    }
+    return (_batch_list);
+}
+
+std::vector<Mesh> const &
+Model::getBatchedMeshList() const
+{
+    return (_batched_mesh_list);
+}
+
 std::string const &
 Model::getDirectory() const
 {
@@ -109,6 +165,104 @@ Model::getCenter() const
     return (_center);
 }
 
+void
+Model::_load_model(ModelLoadingOption const &option)
+{
+    _vertex_list.clear();
+    _indices_list.clear();
+    _mesh_list.clear();
+    _cluster_list.clear();
+    _batch_list.clear();
+    _batched_mesh_list.clear();
+    _center = glm::vec3(0.0f);
+    _min_point = glm::vec3(0.0f);
+    _max_point = glm::vec3(0.0f);
+    _nb_faces = 0;
+    _optimization_info = {};
+    _cache_file = nullptr;
+    _cached_vertex_list = {};
+    _cached_indices_list = {};
+    _cached_cluster_list = {};
+    _cached_batch_list = {};
+    auto update_progress = [&](float progress) -> void {
+        checkModelLoadingCancel(option.progress);
+        if (option.progress) {
+            option.progress->progress = progress;
+        }
+    };
+
+    // Cache hit
+    update_progress(0.0f);
+    if (option.use_model_cache) {
+        ModelCacheData cache_data{};
+        if (modelCacheLoad(_model_path, option, cache_data)) {
+            _cache_file = std::move(cache_data.file);
+            _cached_vertex_list = cache_data.vertex_list;
+            _cached_indices_list = cache_data.indices_list;
+            _cached_cluster_list = cache_data.cluster_list;
+            _cached_batch_list = cache_data.batch_list;
+            _mesh_list = std::move(cache_data.mesh_list);
+            meshBatchGetMeshes(
+              _mesh_list, _cached_batch_list, _batched_mesh_list);
+            _compute_min_max_points_and_center();
+            update_progress(1.0f);
+            return;
+        }
+    }
+
+    if (!option.use_native_obj_loader ||
+        !objLoadModel(_model_path.c_str(),
+                      _vertex_list,
+                      _indices_list,
+                      _mesh_list,
+                      option)) {
+        assimpLoadModel(
+          _model_path.c_str(), _vertex_list, _indices_list, _mesh_list, option);
+    }
+    update_progress(0.4f);
+    if (option.generate_lods) {
+        meshGenerateLods(_vertex_list, _indices_list, _mesh_list, option);
+    }
+    update_progress(0.6f);
+    if (option.optimize_vertex_cache) {
+        _optimize_meshes(option);
+    }
+    update_progress(0.75f);
+    meshBuildBatches(_indices_list, _mesh_list, _batch_list, option);
+    if (option.build_clusters) {
+        meshBuildClusters(
+          _vertex_list, _indices_list, _mesh_list, _cluster_list, option);
+        meshBatchSetClusters(_mesh_list, _batch_list);
+    }
+    meshBatchGetMeshes(_mesh_list, _batch_list, _batched_mesh_list);
+    _compute_min_max_points_and_center();
+    update_progress(0.9f);
+    if (option.use_model_cache) {
+        modelCacheWrite(_model_path,
+                        _directory,
+                        option,
+                        _vertex_list,
+                        _indices_list,
+                        _cluster_list,
+                        _batch_list,
+                        _mesh_list);
+    }
+    update_progress(1.0f);
+}
+
+void
+Model::_optimize_meshes(ModelLoadingOption const &option)
+{
+    VertexCacheStats before{};
+    VertexCacheStats after{};
+
+    meshOptimizeModel(
+      _vertex_list, _indices_list, _mesh_list, option, before, after);
+    _optimization_info = {
+        true, before.acmr, after.acmr, before.atvr, after.atvr
+    };
+}
+
 void
 Model::_compute_min_max_points_and_center()
 {
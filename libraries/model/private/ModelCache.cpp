@@ -0,0 +1,556 @@
+#include "ModelCache.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <random>
+#include <stdexcept>
+#include <system_error>
+#include <type_traits>
+#include <unordered_set>
+
+#include "fmt/core.h"
+
+#include "ModelHash.hpp"
+#include "ObjModelLoader.hpp"
+
+static_assert(sizeof(ModelCacheHeader) % sizeof(uint64_t) == 0);
+static_assert(sizeof(ModelCacheDependency) % sizeof(uint64_t) == 0);
+static_assert(sizeof(glm::vec3) == 3 * sizeof(float));
+static_assert(std::is_trivially_copyable_v<MeshBatch>);
+
+std::string
+modelCacheGetPath(std::string const &model_path,
+                  ModelLoadingOption const &option)
+{
+    std::filesystem::path cache_dir;
+    if (!option.model_cache_directory.empty()) {
+        cache_dir = option.model_cache_directory;
+    } else if (auto xdg_cache = std::getenv("XDG_CACHE_HOME");
+               xdg_cache && *xdg_cache) {
+        cache_dir = std::filesystem::path(xdg_cache) / "scop";
+    } else if (auto home = std::getenv("HOME"); home && *home) {
+        cache_dir = std::filesystem::path(home) / ".cache" / "scop";
+    } else {
+        return ("");
+    }
+
+    std::error_code ec;
+    auto abs_path = std::filesystem::absolute(model_path, ec).string();
+    if (ec) {
+        return ("");
+    }
+    auto name = fmt::format(
+      "{:016x}.scopmdl", hashBytes(abs_path.data(), abs_path.size()));
+    return ((cache_dir / name).string());
+}
+
+uint64_t
+modelCacheOptionHash(ModelLoadingOption const &option)
+{
+    // Thread related options produce identical output and are not part of
+    // the key, options altering the imported data have to be hashed here
+    uint64_t const flags[] = {
+        option.use_native_obj_loader,
+        option.optimize_vertex_cache,
+        option.optimize_vertex_cache && option.optimize_overdraw,
+        option.generate_lods,
+        (option.generate_lods) ? option.nb_lods : 0,
+        (option.generate_lods)
+          ? std::bit_cast<uint32_t>(option.lod_reduction_ratio)
+          : 0,
+        option.build_clusters,
+        option.batch_meshes,
+    };
+    return (hashBytes(flags, sizeof(flags)));
+}
+
+bool
+modelCacheCheckSection(size_t fileSize,
+                       uint64_t offset,
+                       uint64_t nbElements,
+                       size_t elementSize)
+{
+    if (offset % MODEL_CACHE_ALIGNMENT || offset > fileSize) {
+        return (false);
+    }
+    return (nbElements <= (fileSize - offset) / elementSize);
+}
+
+std::string
+modelCacheGetString(ModelCacheHeader const &header,
+                    uint8_t const *fileData,
+                    ModelCacheString const &str)
+{
+    if (static_cast<uint64_t>(str.offset) + str.size > header.strings_size) {
+        throw std::runtime_error("ModelCache: Invalid string");
+    }
+    return (std::string(reinterpret_cast<char const *>(
+                          fileData + header.strings_offset + str.offset),
+                        str.size));
+}
+
+bool
+modelCacheCheckDependency(ModelCacheDependency const &dependency,
+                          std::string const &path)
+{
+    ModelCacheDependency current{};
+    std::error_code ec;
+
+    current.exists = std::filesystem::is_regular_file(path, ec);
+    if (current.exists != dependency.exists) {
+        return (false);
+    }
+    if (!current.exists) {
+        return (true);
+    }
+    current.size = std::filesystem::file_size(path, ec);
+    if (ec || current.size != dependency.size) {
+        return (false);
+    }
+    current.mtime =
+      std::filesystem::last_write_time(path, ec).time_since_epoch().count();
+    if (ec) {
+        return (false);
+    }
+    if (current.mtime == dependency.mtime) {
+        return (true);
+    }
+
+    // Touched but same size, content decides
+    return (modelCacheHashFile(path) == dependency.content_hash);
+}
+
+void
+modelCacheFillDependency(std::string const &path,
+                         ModelCacheDependency &dependency)
+{
+    std::error_code ec;
+
+    dependency.exists = std::filesystem::is_regular_file(path, ec);
+    if (!dependency.exists) {
+        return;
+    }
+    dependency.size = std::filesystem::file_size(path, ec);
+    dependency.mtime =
+      std::filesystem::last_write_time(path, ec).time_since_epoch().count();
+    dependency.content_hash = modelCacheHashFile(path);
+}
+
+std::vector<std::string>
+modelCacheCollectDependencies(std::string const &model_path,
+                              std::string const &directory,
+                              std::vector<Mesh> const &mesh_list)
+{
+    std::vector<std::string> dependencies;
+    std::unordered_set<std::string> known;
+
+    auto add_dependency = [&](std::string const &name) -> void {
+        if (name.empty()) {
+            return;
+        }
+        auto path = directory + "/" + name;
+        if (known.insert(path).second) {
+            dependencies.emplace_back(std::move(path));
+        }
+    };
+
+    // Model file
+    dependencies.emplace_back(model_path);
+    known.insert(model_path);
+
+    // Material files
+    MappedFile model_file(model_path);
+    auto begin = reinterpret_cast<char const *>(model_file.data());
+    auto end = begin + model_file.size();
+    // Read like the OBJ loader does
+    std::vector<std::string> mtllibs;
+    for (auto line = begin; line < end;) {
+        char const *str;
+        char const *line_end;
+
+        line = objReadLine(line, end, str, line_end);
+        if (objReadKeyword(str, line_end) == "mtllib") {
+            objReadMaterialLibs(str, line_end, mtllibs);
+        }
+    }
+    for (auto const &it : mtllibs) {
+        add_dependency(it);
+    }
+
+    // Textures
+    for (auto const &it : mesh_list) {
+        add_dependency(it.material.tex_ambient_name);
+        add_dependency(it.material.tex_diffuse_name);
+        add_dependency(it.material.tex_specular_name);
+        add_dependency(it.material.tex_normal_name);
+        add_dependency(it.material.tex_alpha_name);
+    }
+    return (dependencies);
+}
+
+uint64_t
+modelCacheHashFile(std::string const &path)
+{
+    MappedFile file(path);
+    return (hashBytes(file.data(), file.size()));
+}
+
+std::string
+modelCacheGetTmpPath(std::string const &cache_path)
+{
+    std::random_device rd;
+    return (fmt::format("{}.{:08x}{:08x}.tmp", cache_path, rd(), rd()));
+}
+
+bool
+modelCacheLoad(std::string const &model_path,
+               ModelLoadingOption const &option,
+               ModelCacheData &data)
+{
+    auto cache_path = modelCacheGetPath(model_path, option);
+    std::error_code ec;
+    if (cache_path.empty() || !std::filesystem::exists(cache_path, ec)) {
+        return (false);
+    }
+
+    try {
+        auto file = std::make_shared<MappedFile const>(cache_path);
+        auto file_data = file->data();
+        auto file_size = file->size();
+
+        // Header
+        if (file_size < sizeof(ModelCacheHeader)) {
+            return (false);
+        }
+        ModelCacheHeader header{};
+        std::memcpy(&header, file_data, sizeof(ModelCacheHeader));
+        if (header.magic != MODEL_CACHE_MAGIC ||
+            header.version != MODEL_CACHE_VERSION ||
+            header.vertex_size != sizeof(Vertex) ||
+            header.option_hash != modelCacheOptionHash(option)) {
+            return (false);
+        }
+        if (!modelCacheCheckSection(file_size,
+                                    header.vertices_offset,
+                                    header.nb_vertices,
+                                    sizeof(Vertex)) ||
+            !modelCacheCheckSection(file_size,
+                                    header.indices_offset,
+                                    header.nb_indices,
+                                    sizeof(uint32_t)) ||
+            !modelCacheCheckSection(file_size,
+                                    header.clusters_offset,
+                                    header.nb_clusters,
+                                    sizeof(MeshCluster)) ||
+            !modelCacheCheckSection(file_size,
+                                    header.batches_offset,
+                                    header.nb_batches,
+                                    sizeof(MeshBatch)) ||
+            !modelCacheCheckSection(file_size,
+                                    header.meshes_offset,
+                                    header.nb_meshes,
+                                    sizeof(ModelCacheMesh)) ||
+            !modelCacheCheckSection(file_size,
+                                    header.dependencies_offset,
+                                    header.nb_dependencies,
+                                    sizeof(ModelCacheDependency)) ||
+            !modelCacheCheckSection(
+              file_size, header.strings_offset, header.strings_size, 1)) {
+            return (false);
+        }
+
+        // Hash collision on the file name
+        auto abs_path = std::filesystem::absolute(model_path).string();
+        if (modelCacheGetString(header, file_data, header.source_path) !=
+            abs_path) {
+            return (false);
+        }
+
+        // Dependencies
+        auto dependencies = reinterpret_cast<ModelCacheDependency const *>(
+          file_data + header.dependencies_offset);
+        for (uint32_t i = 0; i < header.nb_dependencies; ++i) {
+            if (!modelCacheCheckDependency(
+                  dependencies[i],
+                  modelCacheGetString(
+                    header, file_data, dependencies[i].path))) {
+                return (false);
+            }
+        }
+
+        // Meshes
+        auto meshes = reinterpret_cast<ModelCacheMesh const *>(
+          file_data + header.meshes_offset);
+        std::vector<Mesh> mesh_list(header.nb_meshes);
+        for (size_t i = 0; i < header.nb_meshes; ++i) {
+            auto const &src = meshes[i];
+            auto &dst = mesh_list[i];
+
+            if (static_cast<uint64_t>(src.indices_offset) + src.nb_indices >
+                  header.nb_indices ||
+                src.nb_lods > MAX_MESH_LODS ||
+                static_cast<uint64_t>(src.clusters_offset) + src.nb_clusters >
+                  header.nb_clusters) {
+                return (false);
+            }
+            for (uint32_t j = 0; j < src.nb_lods; ++j) {
+                if (static_cast<uint64_t>(src.lods[j].indices_offset) +
+                      src.lods[j].nb_indices >
+                    header.nb_indices) {
+                    return (false);
+                }
+            }
+            dst.material.ambient = src.ambient;
+            dst.material.diffuse = src.diffuse;
+            dst.material.specular = src.specular;
+            dst.material.shininess = src.shininess;
+            dst.material.material_name =
+              modelCacheGetString(header, file_data, src.material_name);
+            dst.material.tex_ambient_name =
+              modelCacheGetString(header, file_data, src.tex_ambient_name);
+            dst.material.tex_diffuse_name =
+              modelCacheGetString(header, file_data, src.tex_diffuse_name);
+            dst.material.tex_specular_name =
+              modelCacheGetString(header, file_data, src.tex_specular_name);
+            dst.material.tex_normal_name =
+              modelCacheGetString(header, file_data, src.tex_normal_name);
+            dst.material.tex_alpha_name =
+              modelCacheGetString(header, file_data, src.tex_alpha_name);
+            dst.center = src.center;
+            dst.min_point = src.min_point;
+            dst.max_point = src.max_point;
+            dst.nb_faces = src.nb_faces;
+            dst.nb_indices = src.nb_indices;
+            dst.indices_offset = src.indices_offset;
+            dst.lods.assign(src.lods, src.lods + src.nb_lods);
+            dst.nb_clusters = src.nb_clusters;
+            dst.clusters_offset = src.clusters_offset;
+            dst.mesh_name =
+              modelCacheGetString(header, file_data, src.mesh_name);
+        }
+
+        // Batches
+        auto batches = reinterpret_cast<MeshBatch const *>(
+          file_data + header.batches_offset);
+        for (size_t i = 0; i < header.nb_batches; ++i) {
+            auto const &batch = batches[i];
+
+            if (static_cast<uint64_t>(batch.first_mesh) + batch.nb_meshes >
+                  header.nb_meshes ||
+                !batch.nb_meshes ||
+                static_cast<uint64_t>(batch.indices_offset) +
+                    batch.nb_indices >
+                  header.nb_indices ||
+                batch.nb_lods > MAX_MESH_LODS ||
+                static_cast<uint64_t>(batch.clusters_offset) +
+                    batch.nb_clusters >
+                  header.nb_clusters) {
+                return (false);
+            }
+            for (uint32_t j = 0; j < batch.nb_lods; ++j) {
+                if (static_cast<uint64_t>(batch.lods[j].indices_offset) +
+                      batch.lods[j].nb_indices >
+                    header.nb_indices) {
+                    return (false);
+                }
+            }
+        }
+
+        // Indices and clusters are read without checks by the optimizer
+        // and the gpu
+        auto indices = reinterpret_cast<uint32_t const *>(
+          file_data + header.indices_offset);
+        if (std::any_of(indices,
+                        indices + header.nb_indices,
+                        [&](uint32_t index) -> bool {
+                            return (index >= header.nb_vertices);
+                        })) {
+            return (false);
+        }
+        auto clusters = reinterpret_cast<MeshCluster const *>(
+          file_data + header.clusters_offset);
+        for (size_t i = 0; i < header.nb_clusters; ++i) {
+            if (static_cast<uint64_t>(clusters[i].indices_offset) +
+                  clusters[i].nb_indices >
+                header.nb_indices) {
+                return (false);
+            }
+        }
+
+        // Vertices and indices stay in the mapping
+        data.vertex_list = std::span<Vertex const>(
+          reinterpret_cast<Vertex const *>(file_data + header.vertices_offset),
+          header.nb_vertices);
+        data.indices_list = std::span<uint32_t const>(
+          reinterpret_cast<uint32_t const *>(file_data +
+                                             header.indices_offset),
+          header.nb_indices);
+        data.cluster_list = std::span<MeshCluster const>(
+          reinterpret_cast<MeshCluster const *>(file_data +
+                                                header.clusters_offset),
+          header.nb_clusters);
+        data.batch_list =
+          std::span<MeshBatch const>(batches, header.nb_batches);
+        data.mesh_list = std::move(mesh_list);
+        data.file = std::move(file);
+    } catch (std::exception const &) {
+        return (false);
+    }
+    return (true);
+}
+
+void
+modelCacheWrite(std::string const &model_path,
+                std::string const &directory,
+                ModelLoadingOption const &option,
+                std::span<Vertex const> vertex_list,
+                std::span<uint32_t const> indices_list,
+                std::span<MeshCluster const> cluster_list,
+                std::span<MeshBatch const> batch_list,
+                std::vector<Mesh> const &mesh_list)
+{
+    auto cache_path = modelCacheGetPath(model_path, option);
+    if (cache_path.empty()) {
+        return;
+    }
+
+    std::string tmp_path;
+    try {
+        std::string strings;
+        auto add_string = [&](std::string const &str) -> ModelCacheString {
+            ModelCacheString cache_str = {
+                static_cast<uint32_t>(strings.size()),
+                static_cast<uint32_t>(str.size())
+            };
+            strings += str;
+            return (cache_str);
+        };
+        auto align = [](uint64_t offset) -> uint64_t {
+            return ((offset + MODEL_CACHE_ALIGNMENT - 1) &
+                    ~(MODEL_CACHE_ALIGNMENT - 1));
+        };
+
+        // Meshes
+        std::vector<ModelCacheMesh> meshes(mesh_list.size());
+        for (size_t i = 0; i < mesh_list.size(); ++i) {
+            auto const &src = mesh_list[i];
+            auto &dst = meshes[i];
+
+            dst.ambient = src.material.ambient;
+            dst.diffuse = src.material.diffuse;
+            dst.specular = src.material.specular;
+            dst.shininess = src.material.shininess;
+            dst.center = src.center;
+            dst.min_point = src.min_point;
+            dst.max_point = src.max_point;
+            dst.nb_faces = src.nb_faces;
+            dst.nb_indices = src.nb_indices;
+            dst.indices_offset = src.indices_offset;
+            dst.nb_lods = std::min<uint32_t>(src.lods.size(), MAX_MESH_LODS);
+            std::copy(
+              src.lods.begin(), src.lods.begin() + dst.nb_lods, dst.lods);
+            dst.nb_clusters = src.nb_clusters;
+            dst.clusters_offset = src.clusters_offset;
+            dst.material_name = add_string(src.material.material_name);
+            dst.tex_ambient_name = add_string(src.material.tex_ambient_name);
+            dst.tex_diffuse_name = add_string(src.material.tex_diffuse_name);
+            dst.tex_specular_name = add_string(src.material.tex_specular_name);
+            dst.tex_normal_name = add_string(src.material.tex_normal_name);
+            dst.tex_alpha_name = add_string(src.material.tex_alpha_name);
+            dst.mesh_name = add_string(src.mesh_name);
+        }
+
+        // Dependencies
+        auto dependency_paths =
+          modelCacheCollectDependencies(model_path, directory, mesh_list);
+        std::vector<ModelCacheDependency> dependencies(
+          dependency_paths.size());
+        for (size_t i = 0; i < dependency_paths.size(); ++i) {
+            modelCacheFillDependency(dependency_paths[i], dependencies[i]);
+            dependencies[i].path = add_string(dependency_paths[i]);
+        }
+
+        // Header
+        ModelCacheHeader header{};
+        header.magic = MODEL_CACHE_MAGIC;
+        header.version = MODEL_CACHE_VERSION;
+        header.vertex_size = sizeof(Vertex);
+        header.nb_dependencies = dependencies.size();
+        header.option_hash = modelCacheOptionHash(option);
+        header.source_path =
+          add_string(std::filesystem::absolute(model_path).string());
+        header.vertices_offset = align(sizeof(ModelCacheHeader));
+        header.nb_vertices = vertex_list.size();
+        header.indices_offset =
+          align(header.vertices_offset + vertex_list.size_bytes());
+        header.nb_indices = indices_list.size();
+        header.clusters_offset =
+          align(header.indices_offset + indices_list.size_bytes());
+        header.nb_clusters = cluster_list.size();
+        header.batches_offset =
+          align(header.clusters_offset + cluster_list.size_bytes());
+        header.nb_batches = batch_list.size();
+        header.meshes_offset =
+          align(header.batches_offset + batch_list.size_bytes());
+        header.nb_meshes = meshes.size();
+        header.dependencies_offset = align(
+          header.meshes_offset + meshes.size() * sizeof(ModelCacheMesh));
+        header.strings_offset =
+          align(header.dependencies_offset +
+                dependencies.size() * sizeof(ModelCacheDependency));
+        header.strings_size = strings.size();
+
+        // Written in a temporary file so readers never map a partial cache
+        std::filesystem::create_directories(
+          std::filesystem::path(cache_path).parent_path());
+        tmp_path = modelCacheGetTmpPath(cache_path);
+        std::ofstream ofs(tmp_path, std::ios::binary | std::ios::trunc);
+        if (!ofs.is_open()) {
+            throw std::runtime_error("Failed to open: " + tmp_path);
+        }
+        auto write_at =
+          [&](uint64_t offset, void const *src, size_t size) -> void {
+            static constexpr char const PADDING[MODEL_CACHE_ALIGNMENT] = {};
+            if (!ofs) {
+                return;
+            }
+            auto pos = static_cast<uint64_t>(ofs.tellp());
+            ofs.write(PADDING, offset - pos);
+            ofs.write(static_cast<char const *>(src), size);
+        };
+        write_at(0, &header, sizeof(ModelCacheHeader));
+        write_at(
+          header.vertices_offset, vertex_list.data(), vertex_list.size_bytes());
+        write_at(header.indices_offset,
+                 indices_list.data(),
+                 indices_list.size_bytes());
+        write_at(header.clusters_offset,
+                 cluster_list.data(),
+                 cluster_list.size_bytes());
+        write_at(header.batches_offset,
+                 batch_list.data(),
+                 batch_list.size_bytes());
+        write_at(header.meshes_offset,
+                 meshes.data(),
+                 meshes.size() * sizeof(ModelCacheMesh));
+        write_at(header.dependencies_offset,
+                 dependencies.data(),
+                 dependencies.size() * sizeof(ModelCacheDependency));
+        write_at(header.strings_offset, strings.data(), strings.size());
+        ofs.close();
+        if (!ofs) {
+            throw std::runtime_error("Failed to write: " + tmp_path);
+        }
+        std::filesystem::rename(tmp_path, cache_path);
+    } catch (std::exception const &e) {
+        fmt::print(stderr, "ModelCache: {}\n", e.what());
+        if (!tmp_path.empty()) {
+            std::error_code ec;
+            std::filesystem::remove(tmp_path, ec);
+        }
+    }
+}
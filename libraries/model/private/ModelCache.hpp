@@ -0,0 +1,133 @@
+#ifndef SCOP_VULKAN_MODELCACHE_HPP
+#define SCOP_VULKAN_MODELCACHE_HPP
+
+#include <memory>
+#include <span>
+#include <string>
+#include <vector>
+#include <cstdint>
+
+#include "glm/glm.hpp"
+
+#include "Mesh.hpp"
+#include "MappedFile.hpp"
+#include "ModelLoadingOption.hpp"
+
+// Bumped on any change of the layout below or of the import output
+static constexpr uint32_t const MODEL_CACHE_VERSION = 4;
+static constexpr uint32_t const MODEL_CACHE_MAGIC = 0x444D4353; // "SCMD"
+static constexpr uint64_t const MODEL_CACHE_ALIGNMENT = 64;
+
+struct ModelCacheString final
+{
+    uint32_t offset;
+    uint32_t size;
+};
+
+struct ModelCacheHeader final
+{
+    uint32_t magic;
+    uint32_t version;
+    uint32_t vertex_size;
+    uint32_t nb_dependencies;
+    uint64_t option_hash;
+    ModelCacheString source_path;
+    uint64_t vertices_offset;
+    uint64_t nb_vertices;
+    uint64_t indices_offset;
+    uint64_t nb_indices;
+    uint64_t clusters_offset;
+    uint64_t nb_clusters;
+    uint64_t batches_offset;
+    uint64_t nb_batches;
+    uint64_t meshes_offset;
+    uint64_t nb_meshes;
+    uint64_t dependencies_offset;
+    uint64_t strings_offset;
+    uint64_t strings_size;
+};
+
+// Files the cached data was built from
+struct ModelCacheDependency final
+{
+    ModelCacheString path;
+    uint32_t exists;
+    uint32_t padding;
+    uint64_t size;
+    int64_t mtime;
+    uint64_t content_hash;
+};
+
+struct ModelCacheMesh final
+{
+    glm::vec3 ambient;
+    glm::vec3 diffuse;
+    glm::vec3 specular;
+    float shininess;
+    glm::vec3 center;
+    glm::vec3 min_point;
+    glm::vec3 max_point;
+    uint32_t nb_faces;
+    uint32_t nb_indices;
+    uint32_t indices_offset;
+    uint32_t nb_lods;
+    MeshLod lods[MAX_MESH_LODS];
+    uint32_t nb_clusters;
+    uint32_t clusters_offset;
+    ModelCacheString material_name;
+    ModelCacheString tex_ambient_name;
+    ModelCacheString tex_diffuse_name;
+    ModelCacheString tex_specular_name;
+    ModelCacheString tex_normal_name;
+    ModelCacheString tex_alpha_name;
+    ModelCacheString mesh_name;
+};
+
+struct ModelCacheData final
+{
+    std::shared_ptr<MappedFile const> file;
+    std::span<Vertex const> vertex_list;
+    std::span<uint32_t const> indices_list;
+    std::span<MeshCluster const> cluster_list;
+    std::span<MeshBatch const> batch_list;
+    std::vector<Mesh> mesh_list;
+};
+
+std::string modelCacheGetPath(std::string const &model_path,
+                              ModelLoadingOption const &option);
+uint64_t modelCacheOptionHash(ModelLoadingOption const &option);
+
+bool modelCacheCheckSection(size_t fileSize,
+                            uint64_t offset,
+                            uint64_t nbElements,
+                            size_t elementSize);
+std::string modelCacheGetString(ModelCacheHeader const &header,
+                                uint8_t const *fileData,
+                                ModelCacheString const &str);
+bool modelCacheCheckDependency(ModelCacheDependency const &dependency,
+                               std::string const &path);
+void modelCacheFillDependency(std::string const &path,
+                              ModelCacheDependency &dependency);
+std::vector<std::string> modelCacheCollectDependencies(
+  std::string const &model_path,
+  std::string const &directory,
+  std::vector<Mesh> const &mesh_list);
+uint64_t modelCacheHashFile(std::string const &path);
+// Unique per call, concurrent writers never share a temporary file
+std::string modelCacheGetTmpPath(std::string const &cache_path);
+
+// Returns false when no valid cache exists for model_path
+bool modelCacheLoad(std::string const &model_path,
+                    ModelLoadingOption const &option,
+                    ModelCacheData &data);
+// Failure to write only disables the cache for this model
+void modelCacheWrite(std::string const &model_path,
+                     std::string const &directory,
+                     ModelLoadingOption const &option,
+                     std::span<Vertex const> vertex_list,
+                     std::span<uint32_t const> indices_list,
+                     std::span<MeshCluster const> cluster_list,
+                     std::span<MeshBatch const> batch_list,
+                     std::vector<Mesh> const &mesh_list);
+
+#endif // SCOP_VULKAN_MODELCACHE_HPP
@@ -0,0 +1,41 @@
+#ifndef SCOP_VULKAN_MODELHASH_HPP
+#define SCOP_VULKAN_MODELHASH_HPP
+
+#include <bit>
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+
+// xxHash64 style 64-bit hash, inlined so fixed size keys get unrolled
+inline uint64_t
+hashBytes(void const *data, size_t size, uint64_t seed = 0)
+{
+    static constexpr uint64_t const PRIME64_1 = 0x9E3779B185EBCA87ULL;
+    static constexpr uint64_t const PRIME64_2 = 0xC2B2AE3D27D4EB4FULL;
+    static constexpr uint64_t const PRIME64_3 = 0x165667B19E3779F9ULL;
+
+    auto bytes = static_cast<uint8_t const *>(data);
+    uint64_t h = seed + PRIME64_3 + size;
+    size_t i = 0;
+    for (; i + sizeof(uint64_t) <= size; i += sizeof(uint64_t)) {
+        uint64_t k;
+        std::memcpy(&k, bytes + i, sizeof(uint64_t));
+        k = std::rotl(k * PRIME64_2, 31) * PRIME64_1;
+        h ^= k;
+        h = std::rotl(h, 27) * PRIME64_1 + PRIME64_3;
+    }
+    for (; i < size; ++i) {
+        h ^= bytes[i] * PRIME64_3;
+        h = std::rotl(h, 11) * PRIME64_1;
+    }
+
+    // Avalanche
+    h ^= h >> 33;
+    h *= PRIME64_2;
+    h ^= h >> 29;
+    h *= PRIME64_3;
+    h ^= h >> 32;
+    return (h);
+}
+
+#endif // SCOP_VULKAN_MODELHASH_HPP
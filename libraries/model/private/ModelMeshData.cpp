@@ -0,0 +1,64 @@
+#include "ModelMeshData.hpp"
+
+#include <algorithm>
+
+#include "WeldTable.hpp"
+
+void
+mergeMeshData(std::vector<ModelMeshData> &meshes_data,
+              std::vector<Vertex> &vertex_list,
+              std::vector<uint32_t> &indices_list,
+              std::vector<Mesh> &mesh_list)
+{
+    size_t total_vertices = 0;
+    size_t total_indices = indices_list.size();
+    for (auto const &it : meshes_data) {
+        total_vertices += it.vertex_list.size();
+        total_indices += it.indices_list.size();
+    }
+    vertex_list.reserve(vertex_list.size() + total_vertices);
+    indices_list.reserve(total_indices);
+    VertexWeldTable weld_table(vertex_list, total_vertices);
+
+    // Meshes are merged in order and their unique vertices
+    // in first seen order so the result matches a serial import
+    std::vector<uint32_t> local_to_model;
+    for (auto &it : meshes_data) {
+        if (!mesh_list.empty()) {
+            it.mesh.indices_offset =
+              mesh_list.back().indices_offset + mesh_list.back().nb_indices;
+        }
+
+        local_to_model.resize(it.vertex_list.size());
+        for (size_t i = 0; i < it.vertex_list.size(); ++i) {
+            local_to_model[i] = weld_table.weld(it.vertex_list[i]);
+        }
+        for (auto const &local_index : it.indices_list) {
+            indices_list.emplace_back(local_to_model[local_index]);
+        }
+        mesh_list.emplace_back(std::move(it.mesh));
+
+        it.vertex_list = {};
+        it.indices_list = {};
+    }
+}
+
+void
+getMeshLocalIndices(std::span<uint32_t const> indices,
+                    std::vector<uint32_t> &local_to_model,
+                    std::vector<uint32_t> &local_indices)
+{
+    local_to_model.assign(indices.begin(), indices.end());
+    std::sort(local_to_model.begin(), local_to_model.end());
+    local_to_model.erase(
+      std::unique(local_to_model.begin(), local_to_model.end()),
+      local_to_model.end());
+
+    local_indices.resize(indices.size());
+    for (size_t i = 0; i < indices.size(); ++i) {
+        local_indices[i] = static_cast<uint32_t>(
+          std::lower_bound(
+            local_to_model.begin(), local_to_model.end(), indices[i]) -
+          local_to_model.begin());
+    }
+}
@@ -0,0 +1,31 @@
+#ifndef SCOP_VULKAN_MODELMESHDATA_HPP
+#define SCOP_VULKAN_MODELMESHDATA_HPP
+
+#include <vector>
+#include <span>
+#include <cstdint>
+
+#include "Mesh.hpp"
+
+// Mesh imported on its own with mesh local vertex dedup,
+// used by parallel imports before merging into the model lists
+struct ModelMeshData final
+{
+    std::vector<Vertex> vertex_list;
+    std::vector<uint32_t> indices_list;
+    Mesh mesh{};
+};
+
+// Meshes are appended in order, vertices are welded across meshes
+void mergeMeshData(std::vector<ModelMeshData> &meshes_data,
+                   std::vector<Vertex> &vertex_list,
+                   std::vector<uint32_t> &indices_list,
+                   std::vector<Mesh> &mesh_list);
+
+// Compacts the model vertex indices used by a mesh range into [0, n),
+// local_to_model is sorted so local order follows model order
+void getMeshLocalIndices(std::span<uint32_t const> indices,
+                         std::vector<uint32_t> &local_to_model,
+                         std::vector<uint32_t> &local_indices);
+
+#endif // SCOP_VULKAN_MODELMESHDATA_HPP
@@ -0,0 +1,867 @@
+#include "ObjModelLoader.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <cassert>
+#include <cctype>
+#include <charconv>
+#include <cstring>
+#include <filesystem>
+#include <limits>
+#include <stdexcept>
+#include <system_error>
+
+#include "MappedFile.hpp"
+#include "WeldTable.hpp"
+#include "ParallelFor.hpp"
+
+static_assert(sizeof(ObjCorner) == 3 * sizeof(int32_t),
+              "ObjCorner is welded bitwise and must not have padding");
+
+bool
+objLoadModel(char const *model_path,
+             std::vector<Vertex> &vertex_list,
+             std::vector<uint32_t> &indices_list,
+             std::vector<Mesh> &mesh_list,
+             ModelLoadingOption const &option)
+{
+    assert(model_path);
+    static constexpr size_t const MIN_CHUNK_SIZE = 1 << 20;
+    static constexpr size_t const CHUNKS_PER_THREAD = 8;
+
+    std::filesystem::path path(model_path);
+    auto extension = path.extension().string();
+    std::transform(
+      extension.begin(), extension.end(), extension.begin(), [](char c) {
+          return (std::tolower(static_cast<unsigned char>(c)));
+      });
+    if (extension != ".obj") {
+        return (false);
+    }
+    uint32_t nb_threads = 1;
+    if (option.parallel_import) {
+        nb_threads = (option.nb_import_threads) ? option.nb_import_threads
+                                                : getNbWorkerThreads();
+    }
+
+    std::vector<ModelMeshData> meshes_data;
+    try {
+        MappedFile file(model_path);
+        auto data = reinterpret_cast<char const *>(file.data());
+        ObjModelData model{};
+
+        // Chunks are split on line boundaries and parsed independently
+        auto nb_chunks = std::clamp(file.size() / MIN_CHUNK_SIZE,
+                                    static_cast<size_t>(1),
+                                    nb_threads * CHUNKS_PER_THREAD);
+        auto bounds = objSplitChunks(data, file.size(), nb_chunks);
+        model.chunks.resize(bounds.size() - 1);
+        std::vector<uint8_t> is_parsed(model.chunks.size());
+        parallelFor(
+          model.chunks.size(),
+          [&](size_t i) -> void {
+              checkModelLoadingCancel(option.progress);
+              is_parsed[i] = objParseChunk(
+                data + bounds[i], data + bounds[i + 1], model.chunks[i]);
+          },
+          nb_threads);
+        for (auto const &it : is_parsed) {
+            if (!it) {
+                return (false);
+            }
+        }
+        objGatherVertexData(model, nb_threads);
+        objBuildMeshDescs(model);
+        if (model.meshes.empty()) {
+            return (false);
+        }
+
+        // Material libs are small, loaded serially
+        auto directory = path.parent_path();
+        if (directory.empty()) {
+            directory = ".";
+        }
+        for (auto const &chunk : model.chunks) {
+            for (auto const &it : chunk.mtllibs) {
+                objLoadMaterialLib((directory / it).string(), model.materials);
+            }
+        }
+
+        // Meshes are built in parallel and merged in file order
+        meshes_data.resize(model.meshes.size());
+        parallelFor(
+          model.meshes.size(),
+          [&](size_t i) -> void {
+              checkModelLoadingCancel(option.progress);
+              objBuildMeshData(model, model.meshes[i], meshes_data[i]);
+          },
+          nb_threads);
+    } catch (ModelLoadingCancelled const &) {
+        throw;
+    } catch (std::exception const &) {
+        return (false);
+    }
+    mergeMeshData(meshes_data, vertex_list, indices_list, mesh_list);
+    return (true);
+}
+
+std::vector<size_t>
+objSplitChunks(char const *data, size_t size, size_t nbChunks)
+{
+    std::vector<size_t> bounds = { 0 };
+
+    for (size_t i = 1; i < nbChunks; ++i) {
+        size_t pos = size * i / nbChunks;
+        if (pos <= bounds.back()) {
+            continue;
+        }
+        auto line_end =
+          static_cast<char const *>(std::memchr(data + pos, '\n', size - pos));
+        if (!line_end) {
+            break;
+        }
+        pos = line_end - data + 1;
+        if (pos < size) {
+            bounds.emplace_back(pos);
+        }
+    }
+    bounds.emplace_back(size);
+    return (bounds);
+}
+
+bool
+objParseChunk(char const *begin, char const *end, ObjChunkData &chunk)
+{
+    for (auto line = begin; line < end;) {
+        char const *str;
+        char const *line_end;
+
+        line = objReadLine(line, end, str, line_end);
+        if (str == line_end || *str == '#') {
+            continue;
+        }
+        // Line continuations are left to Assimp
+        if (line_end[-1] == '\\') {
+            return (false);
+        }
+
+        auto keyword = objReadKeyword(str, line_end);
+        if (keyword == "v") {
+            glm::vec3 position{};
+            if (!(str = objParseFloat(str, line_end, position.x)) ||
+                !(str = objParseFloat(str, line_end, position.y)) ||
+                !objParseFloat(str, line_end, position.z)) {
+                return (false);
+            }
+            chunk.positions.emplace_back(position);
+        } else if (keyword == "vt") {
+            glm::vec2 tex_coords{};
+            if (!(str = objParseFloat(str, line_end, tex_coords.x))) {
+                return (false);
+            }
+            objParseFloat(str, line_end, tex_coords.y);
+            chunk.tex_coords.emplace_back(tex_coords);
+        } else if (keyword == "vn") {
+            glm::vec3 normal{};
+            if (!(str = objParseFloat(str, line_end, normal.x)) ||
+                !(str = objParseFloat(str, line_end, normal.y)) ||
+                !objParseFloat(str, line_end, normal.z)) {
+                return (false);
+            }
+            chunk.normals.emplace_back(normal);
+        } else if (keyword == "f") {
+            if (!objParseFace(str, line_end, chunk)) {
+                return (false);
+            }
+        } else if (keyword == "o" || keyword == "g") {
+            chunk.events.push_back(
+              { static_cast<uint32_t>(chunk.face_offsets.size()),
+                false,
+                std::string(str, line_end) });
+        } else if (keyword == "usemtl") {
+            chunk.events.push_back(
+              { static_cast<uint32_t>(chunk.face_offsets.size()),
+                true,
+                std::string(str, line_end) });
+        } else if (keyword == "mtllib") {
+            objReadMaterialLibs(str, line_end, chunk.mtllibs);
+        } else if (keyword == "l" || keyword == "p" || keyword == "vp" ||
+                   keyword == "cstype" || keyword == "deg" ||
+                   keyword == "bmat" || keyword == "step" ||
+                   keyword == "curv" || keyword == "curv2" ||
+                   keyword == "surf" || keyword == "parm" ||
+                   keyword == "trim" || keyword == "hole" ||
+                   keyword == "scrv" || keyword == "sp" ||
+                   keyword == "end" || keyword == "con") {
+            // Points, lines and free form geometry are left to Assimp
+            return (false);
+        }
+    }
+    chunk.face_offsets.emplace_back(chunk.corners.size());
+    return (true);
+}
+
+bool
+objParseFace(char const *str, char const *end, ObjChunkData &chunk)
+{
+    auto face_index = static_cast<uint32_t>(chunk.face_offsets.size());
+    auto first_corner = chunk.corners.size();
+    bool is_relative = false;
+
+    chunk.face_offsets.emplace_back(first_corner);
+    while (str < end && *str != '#') {
+        ObjCorner corner{};
+
+        // v, v/vt, v//vn or v/vt/vn
+        if (!(str = objParseInt(str, end, corner.v)) || !corner.v) {
+            return (false);
+        }
+        if (str < end && *str == '/') {
+            ++str;
+            if (str < end && *str != '/' &&
+                !(str = objParseInt(str, end, corner.vt))) {
+                return (false);
+            }
+            if (str < end && *str == '/') {
+                ++str;
+                if (!(str = objParseInt(str, end, corner.vn))) {
+                    return (false);
+                }
+            }
+        }
+        is_relative |= corner.v < 0 || corner.vt < 0 || corner.vn < 0;
+        chunk.corners.emplace_back(corner);
+        str = objSkipSpaces(str, end);
+    }
+    if (chunk.corners.size() - first_corner < 3 ||
+        chunk.corners.size() > std::numeric_limits<uint32_t>::max()) {
+        return (false);
+    }
+
+    if (is_relative) {
+        chunk.relative_faces.push_back(
+          { face_index,
+            static_cast<uint32_t>(chunk.positions.size()),
+            static_cast<uint32_t>(chunk.tex_coords.size()),
+            static_cast<uint32_t>(chunk.normals.size()) });
+    }
+    return (true);
+}
+
+char const *
+objParseFloat(char const *str, char const *end, float &value)
+{
+    static constexpr double const POW10[] = {
+        1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+        1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+    };
+    static constexpr int64_t const MAX_EXACT_POW10 = 22;
+    static constexpr uint64_t const MAX_EXACT_MANTISSA = 1ULL << 53;
+    static constexpr size_t const MAX_MANTISSA_DIGITS = 19;
+    static constexpr uint64_t const MAX_EXPONENT = 1 << 16;
+
+    str = objSkipSpaces(str, end);
+    auto number = str;
+    bool is_negative = false;
+    if (str < end && (*str == '-' || *str == '+')) {
+        is_negative = *str == '-';
+        ++str;
+    }
+
+    // Mantissa, decimals are accumulated as part of it
+    uint64_t mantissa = 0;
+    int64_t exponent = 0;
+    auto nb_digits = objParseDigits(str, end, mantissa);
+    if (str < end && *str == '.') {
+        ++str;
+        auto nb_decimals = objParseDigits(str, end, mantissa);
+        nb_digits += nb_decimals;
+        exponent = -static_cast<int64_t>(nb_decimals);
+    }
+
+    // Exponent, ignored when not followed by digits
+    if (nb_digits && str < end && (*str == 'e' || *str == 'E')) {
+        auto exponent_str = str + 1;
+        bool is_negative_exponent = false;
+        if (exponent_str < end &&
+            (*exponent_str == '-' || *exponent_str == '+')) {
+            is_negative_exponent = *exponent_str == '-';
+            ++exponent_str;
+        }
+        uint64_t exponent_value = 0;
+        auto nb_exponent_digits =
+          objParseDigits(exponent_str, end, exponent_value);
+        if (nb_exponent_digits) {
+            exponent_value = std::min(exponent_value, MAX_EXPONENT);
+            exponent += (is_negative_exponent)
+                          ? -static_cast<int64_t>(exponent_value)
+                          : static_cast<int64_t>(exponent_value);
+            str = exponent_str;
+        }
+    }
+
+    // Mantissa and power of ten are exact doubles, the double result is
+    // correctly rounded. Converting it to float rounds a second time, which
+    // may be one ulp off in rare halfway cases.
+    if (nb_digits && nb_digits <= MAX_MANTISSA_DIGITS &&
+        mantissa <= MAX_EXACT_MANTISSA && exponent >= -MAX_EXACT_POW10 &&
+        exponent <= MAX_EXACT_POW10) {
+        auto result = static_cast<double>(mantissa);
+        result =
+          (exponent < 0) ? result / POW10[-exponent] : result * POW10[exponent];
+        value = static_cast<float>((is_negative) ? -result : result);
+        return (str);
+    }
+
+    // Slow path for long mantissa, huge exponents, inf and nan
+    if (number < end && *number == '+') {
+        ++number;
+    }
+    auto [ptr, ec] = std::from_chars(number, end, value);
+    if (ec != std::errc()) {
+        return (nullptr);
+    }
+    return (ptr);
+}
+
+char const *
+objParseInt(char const *str, char const *end, int32_t &value)
+{
+    static constexpr size_t const MAX_INT_DIGITS = 10;
+
+    bool is_negative = false;
+    if (str < end && (*str == '-' || *str == '+')) {
+        is_negative = *str == '-';
+        ++str;
+    }
+    uint64_t abs_value = 0;
+    auto nb_digits = objParseDigits(str, end, abs_value);
+    if (!nb_digits || nb_digits > MAX_INT_DIGITS ||
+        abs_value >
+          static_cast<uint64_t>(std::numeric_limits<int32_t>::max())) {
+        return (nullptr);
+    }
+    value = static_cast<int32_t>(abs_value);
+    if (is_negative) {
+        value = -value;
+    }
+    return (str);
+}
+
+size_t
+objParseDigits(char const *&str, char const *end, uint64_t &value)
+{
+    static constexpr uint64_t const POW10[] = { 1,      10,      100,
+                                                1000,   10000,   100000,
+                                                1000000, 10000000, 100000000 };
+    auto begin = str;
+
+    // SWAR fast path, up to 8 digits are converted at once
+    if constexpr (std::endian::native == std::endian::little) {
+        while (end - str >= 8) {
+            uint64_t chars;
+            std::memcpy(&chars, str, sizeof(uint64_t));
+
+            // Non zero byte for each char out of '0' - '9'.
+            // Digit bytes never carry so leading digits are exact.
+            uint64_t non_digits =
+              ((chars & 0xF0F0F0F0F0F0F0F0) ^ 0x3030303030303030) |
+              (((chars + 0x0606060606060606) & 0xF0F0F0F0F0F0F0F0) ^
+               0x3030303030303030);
+            auto nb_digits = std::countr_zero(non_digits) / 8;
+            if (!nb_digits) {
+                break;
+            }
+
+            // Digits moved to upper bytes, lower bytes read as leading 0
+            uint64_t digits = (chars - 0x3030303030303030)
+                              << (8 * (8 - nb_digits));
+            digits = (digits * 10) + (digits >> 8);
+            digits = (((digits & 0x000000FF000000FF) * 0x000F424000000064) +
+                      (((digits >> 16) & 0x000000FF000000FF) *
+                       0x0000271000000001)) >>
+                     32;
+            value = value * POW10[nb_digits] + digits;
+            str += nb_digits;
+            if (nb_digits < 8) {
+                return (str - begin);
+            }
+        }
+    }
+
+    while (str < end && *str >= '0' && *str <= '9') {
+        value = value * 10 + (*str - '0');
+        ++str;
+    }
+    return (str - begin);
+}
+
+char const *
+objReadLine(char const *line,
+            char const *end,
+            char const *&str,
+            char const *&str_end)
+{
+    auto line_end =
+      static_cast<char const *>(std::memchr(line, '\n', end - line));
+    if (!line_end) {
+        line_end = end;
+    }
+
+    str = objSkipSpaces(line, line_end);
+    str_end = line_end;
+    while (str_end > str &&
+           std::isspace(static_cast<unsigned char>(str_end[-1]))) {
+        --str_end;
+    }
+    return (line_end + 1);
+}
+
+std::string_view
+objReadKeyword(char const *&str, char const *end)
+{
+    auto keyword_begin = str;
+    while (str < end && !std::isspace(static_cast<unsigned char>(*str))) {
+        ++str;
+    }
+    std::string_view keyword(keyword_begin, str - keyword_begin);
+    str = objSkipSpaces(str, end);
+    return (keyword);
+}
+
+void
+objReadMaterialLibs(char const *str,
+                    char const *end,
+                    std::vector<std::string> &mtllibs)
+{
+    // Libraries are separated by whitespaces
+    while (str < end) {
+        mtllibs.emplace_back(objReadKeyword(str, end));
+    }
+}
+
+char const *
+objSkipSpaces(char const *str, char const *end)
+{
+    while (str < end && std::isspace(static_cast<unsigned char>(*str))) {
+        ++str;
+    }
+    return (str);
+}
+
+void
+objGatherVertexData(ObjModelData &model, uint32_t nbThreads)
+{
+    auto nb_chunks = model.chunks.size();
+    std::vector<size_t> base_positions(nb_chunks + 1);
+    std::vector<size_t> base_tex_coords(nb_chunks + 1);
+    std::vector<size_t> base_normals(nb_chunks + 1);
+
+    for (size_t i = 0; i < nb_chunks; ++i) {
+        auto const &chunk = model.chunks[i];
+
+        base_positions[i + 1] = base_positions[i] + chunk.positions.size();
+        base_tex_coords[i + 1] = base_tex_coords[i] + chunk.tex_coords.size();
+        base_normals[i + 1] = base_normals[i] + chunk.normals.size();
+    }
+    static constexpr size_t const MAX_NB_ELEMENTS =
+      std::numeric_limits<int32_t>::max();
+    if (base_positions.back() > MAX_NB_ELEMENTS ||
+        base_tex_coords.back() > MAX_NB_ELEMENTS ||
+        base_normals.back() > MAX_NB_ELEMENTS) {
+        throw std::runtime_error("ObjLoader: Too many vertices");
+    }
+
+    model.positions.resize(base_positions.back());
+    model.tex_coords.resize(base_tex_coords.back());
+    model.normals.resize(base_normals.back());
+    parallelFor(
+      nb_chunks,
+      [&](size_t i) -> void {
+          auto &chunk = model.chunks[i];
+
+          objResolveRelativeFaces(chunk,
+                                  base_positions[i],
+                                  base_tex_coords[i],
+                                  base_normals[i]);
+          std::copy(chunk.positions.begin(),
+                    chunk.positions.end(),
+                    model.positions.begin() + base_positions[i]);
+          std::copy(chunk.tex_coords.begin(),
+                    chunk.tex_coords.end(),
+                    model.tex_coords.begin() + base_tex_coords[i]);
+          std::copy(chunk.normals.begin(),
+                    chunk.normals.end(),
+                    model.normals.begin() + base_normals[i]);
+          chunk.positions = {};
+          chunk.tex_coords = {};
+          chunk.normals = {};
+      },
+      nbThreads);
+}
+
+void
+objResolveRelativeFaces(ObjChunkData &chunk,
+                        uint32_t basePositions,
+                        uint32_t baseTexCoords,
+                        uint32_t baseNormals)
+{
+    // -1 is the last element defined before the face, out of range
+    // results are kept negative so they fail the index checks
+    auto resolve = [](int32_t &index, int64_t count) -> void {
+        if (index >= 0) {
+            return;
+        }
+        int64_t resolved = count + index + 1;
+        index = (resolved > 0) ? static_cast<int32_t>(resolved) : -1;
+    };
+
+    for (auto const &it : chunk.relative_faces) {
+        auto begin = chunk.face_offsets[it.face_index];
+        auto end = chunk.face_offsets[it.face_index + 1];
+
+        for (auto i = begin; i < end; ++i) {
+            auto &corner = chunk.corners[i];
+
+            resolve(corner.v,
+                    static_cast<int64_t>(basePositions) + it.nb_positions);
+            resolve(corner.vt,
+                    static_cast<int64_t>(baseTexCoords) + it.nb_tex_coords);
+            resolve(corner.vn,
+                    static_cast<int64_t>(baseNormals) + it.nb_normals);
+        }
+    }
+    chunk.relative_faces = {};
+}
+
+void
+objBuildMeshDescs(ObjModelData &model)
+{
+    // Each "o", "g" or "usemtl" starts a new mesh, meshes may span chunks
+    ObjMeshDesc current{ "defaultobject", "", {} };
+    auto end_mesh = [&]() -> void {
+        if (!current.ranges.empty()) {
+            model.meshes.emplace_back(current);
+            current.ranges.clear();
+        }
+    };
+
+    for (uint32_t i = 0; i < model.chunks.size(); ++i) {
+        auto const &chunk = model.chunks[i];
+        auto nb_faces = static_cast<uint32_t>(chunk.face_offsets.size() - 1);
+        uint32_t face_begin = 0;
+
+        for (auto const &it : chunk.events) {
+            if (it.face_index > face_begin) {
+                current.ranges.push_back({ i, face_begin, it.face_index });
+                face_begin = it.face_index;
+            }
+            end_mesh();
+            if (it.is_material) {
+                current.material_name = it.name;
+            } else {
+                current.name = it.name;
+            }
+        }
+        if (nb_faces > face_begin) {
+            current.ranges.push_back({ i, face_begin, nb_faces });
+        }
+    }
+    end_mesh();
+}
+
+void
+objBuildMeshData(ObjModelData const &model,
+                 ObjMeshDesc const &desc,
+                 ModelMeshData &data)
+{
+    auto &loaded_mesh = data.mesh;
+
+    // Faces are triangulated as fans like aiProcess_Triangulate does
+    size_t nb_triangles = 0;
+    for (auto const &it : desc.ranges) {
+        auto const &offsets = model.chunks[it.chunk].face_offsets;
+
+        nb_triangles += offsets[it.face_end] - offsets[it.face_begin] -
+                        2 * (it.face_end - it.face_begin);
+    }
+    std::vector<ObjCorner> corners;
+    WeldTable<ObjCorner> corner_table(corners, nb_triangles);
+    data.indices_list.reserve(nb_triangles * 3);
+    for (auto const &it : desc.ranges) {
+        auto const &chunk = model.chunks[it.chunk];
+
+        for (auto i = it.face_begin; i < it.face_end; ++i) {
+            auto face = chunk.corners.data() + chunk.face_offsets[i];
+            auto nb_corners = chunk.face_offsets[i + 1] - chunk.face_offsets[i];
+
+            auto first = corner_table.weld(face[0]);
+            auto previous = corner_table.weld(face[1]);
+            for (uint32_t j = 2; j < nb_corners; ++j) {
+                auto current = corner_table.weld(face[j]);
+                data.indices_list.emplace_back(first);
+                data.indices_list.emplace_back(previous);
+                data.indices_list.emplace_back(current);
+                previous = current;
+            }
+        }
+    }
+    loaded_mesh.nb_faces = nb_triangles;
+    loaded_mesh.nb_indices = data.indices_list.size();
+
+    // Vertices
+    bool has_tex_coords = false;
+    bool has_missing_normals = false;
+    auto is_valid = [](int32_t index, size_t size) -> bool {
+        return (index > 0 && static_cast<size_t>(index) <= size);
+    };
+    data.vertex_list.resize(corners.size());
+    for (size_t i = 0; i < corners.size(); ++i) {
+        auto const &corner = corners[i];
+        auto &vertex = data.vertex_list[i];
+
+        if (!is_valid(corner.v, model.positions.size()) ||
+            (corner.vt && !is_valid(corner.vt, model.tex_coords.size())) ||
+            (corner.vn && !is_valid(corner.vn, model.normals.size()))) {
+            throw std::runtime_error("ObjLoader: Invalid face index");
+        }
+        vertex.position = model.positions[corner.v - 1];
+        if (corner.vt) {
+            vertex.tex_coords = model.tex_coords[corner.vt - 1];
+            has_tex_coords = true;
+        }
+        if (corner.vn) {
+            vertex.normal = model.normals[corner.vn - 1];
+        } else {
+            has_missing_normals = true;
+        }
+    }
+    if (has_missing_normals) {
+        objGenerateNormals(corners, data.indices_list, data.vertex_list);
+    }
+    if (has_tex_coords) {
+        objGenerateTangents(data.indices_list, data.vertex_list);
+        // Corners without texture coordinates keep 0
+        for (size_t i = 0; i < corners.size(); ++i) {
+            if (corners[i].vt) {
+                auto &tex_coords = data.vertex_list[i].tex_coords;
+                tex_coords.y = 1.0f - tex_coords.y;
+            }
+        }
+    }
+
+    // Min / Max point + Center
+    if (!data.vertex_list.empty()) {
+        loaded_mesh.min_point = data.vertex_list[0].position;
+        loaded_mesh.max_point = data.vertex_list[0].position;
+    }
+    for (auto const &it : data.vertex_list) {
+        loaded_mesh.min_point = glm::min(loaded_mesh.min_point, it.position);
+        loaded_mesh.max_point = glm::max(loaded_mesh.max_point, it.position);
+    }
+    loaded_mesh.center = (loaded_mesh.min_point + loaded_mesh.max_point) / 2.0f;
+
+    // Other
+    auto material = model.materials.find(desc.material_name);
+    loaded_mesh.material = (material != model.materials.end())
+                             ? material->second
+                             : objDefaultMaterial("DefaultMaterial");
+    loaded_mesh.mesh_name = desc.name;
+}
+
+void
+objGenerateNormals(std::vector<ObjCorner> const &corners,
+                   std::vector<uint32_t> const &indices_list,
+                   std::vector<Vertex> &vertex_list)
+{
+    // Face normals are averaged over every corner sharing a position index
+    std::vector<ObjCorner> positions;
+    WeldTable<ObjCorner> position_table(positions, corners.size());
+    std::vector<uint32_t> vertex_to_position(corners.size());
+    for (size_t i = 0; i < corners.size(); ++i) {
+        vertex_to_position[i] = position_table.weld({ corners[i].v, 0, 0 });
+    }
+
+    std::vector<glm::vec3> normals(positions.size(), glm::vec3(0.0f));
+    for (size_t i = 0; i + 2 < indices_list.size(); i += 3) {
+        auto const &p0 = vertex_list[indices_list[i]].position;
+        auto const &p1 = vertex_list[indices_list[i + 1]].position;
+        auto const &p2 = vertex_list[indices_list[i + 2]].position;
+        auto face_normal = objSafeNormalize(glm::cross(p1 - p0, p2 - p0));
+
+        for (size_t j = 0; j < 3; ++j) {
+            normals[vertex_to_position[indices_list[i + j]]] += face_normal;
+        }
+    }
+    for (size_t i = 0; i < corners.size(); ++i) {
+        if (!corners[i].vn) {
+            vertex_list[i].normal =
+              objSafeNormalize(normals[vertex_to_position[i]]);
+        }
+    }
+}
+
+void
+objGenerateTangents(std::vector<uint32_t> const &indices_list,
+                    std::vector<Vertex> &vertex_list)
+{
+    // Same per face tangents as aiProcess_CalcTangentSpace,
+    // accumulated per vertex then orthogonalized against the normal
+    std::vector<glm::vec3> tangents(vertex_list.size(), glm::vec3(0.0f));
+    std::vector<glm::vec3> bitangents(vertex_list.size(), glm::vec3(0.0f));
+    for (size_t i = 0; i + 2 < indices_list.size(); i += 3) {
+        auto const &v0 = vertex_list[indices_list[i]];
+        auto const &v1 = vertex_list[indices_list[i + 1]];
+        auto const &v2 = vertex_list[indices_list[i + 2]];
+
+        auto v = v1.position - v0.position;
+        auto w = v2.position - v0.position;
+        float sx = v1.tex_coords.x - v0.tex_coords.x;
+        float sy = v1.tex_coords.y - v0.tex_coords.y;
+        float tx = v2.tex_coords.x - v0.tex_coords.x;
+        float ty = v2.tex_coords.y - v0.tex_coords.y;
+        float dir_correction = ((tx * sy - ty * sx) < 0.0f) ? -1.0f : 1.0f;
+        if (sx * ty == sy * tx) {
+            sx = 0.0f;
+            sy = 1.0f;
+            tx = 1.0f;
+            ty = 0.0f;
+        }
+        auto tangent = (w * sy - v * ty) * dir_correction;
+        auto bitangent = (v * tx - w * sx) * dir_correction;
+
+        for (size_t j = 0; j < 3; ++j) {
+            tangents[indices_list[i + j]] += tangent;
+            bitangents[indices_list[i + j]] += bitangent;
+        }
+    }
+    for (size_t i = 0; i < vertex_list.size(); ++i) {
+        auto &vertex = vertex_list[i];
+        auto normal = objSafeNormalize(vertex.normal);
+
+        vertex.tangent = objSafeNormalize(
+          tangents[i] - normal * glm::dot(tangents[i], normal));
+        vertex.bitangent = objSafeNormalize(
+          bitangents[i] - normal * glm::dot(bitangents[i], normal));
+    }
+}
+
+glm::vec3
+objSafeNormalize(glm::vec3 const &vec)
+{
+    auto length = glm::length(vec);
+    if (length > 0.0f) {
+        return (vec / length);
+    }
+    return (vec);
+}
+
+Material
+objDefaultMaterial(std::string const &name)
+{
+    // Defaults of Assimp OBJ materials
+    Material mat{};
+
+    mat.ambient = glm::vec3(0.0f);
+    mat.diffuse = glm::vec3(0.6f);
+    mat.specular = glm::vec3(0.0f);
+    mat.shininess = 0.0f;
+    mat.material_name = name;
+    return (mat);
+}
+
+void
+objLoadMaterialLib(std::string const &path,
+                   std::unordered_map<std::string, Material> &materials)
+{
+    // Missing material libs are not an error, as with Assimp
+    std::error_code ec;
+    if (!std::filesystem::is_regular_file(path, ec)) {
+        return;
+    }
+
+    MappedFile file(path);
+    auto begin = reinterpret_cast<char const *>(file.data());
+    auto end = begin + file.size();
+    Material *current = nullptr;
+    auto parse_color = [](char const *str,
+                          char const *line_end,
+                          glm::vec3 &color) -> void {
+        glm::vec3 tmp{};
+
+        if (!(str = objParseFloat(str, line_end, tmp.x))) {
+            return;
+        }
+        // Single value applies to every channel
+        auto next = objParseFloat(str, line_end, tmp.y);
+        if (!next || !objParseFloat(next, line_end, tmp.z)) {
+            tmp = glm::vec3(tmp.x);
+        }
+        color = tmp;
+    };
+
+    for (auto line = begin; line < end;) {
+        char const *str;
+        char const *line_end;
+
+        line = objReadLine(line, end, str, line_end);
+        if (str == line_end || *str == '#') {
+            continue;
+        }
+
+        auto keyword = objReadKeyword(str, line_end);
+        if (keyword == "newmtl") {
+            std::string name(str, line_end);
+            current = &(materials[name] = objDefaultMaterial(name));
+        } else if (!current) {
+            continue;
+        } else if (keyword == "Ka") {
+            parse_color(str, line_end, current->ambient);
+        } else if (keyword == "Kd") {
+            parse_color(str, line_end, current->diffuse);
+        } else if (keyword == "Ks") {
+            parse_color(str, line_end, current->specular);
+        } else if (keyword == "Ns") {
+            objParseFloat(str, line_end, current->shininess);
+        } else if (keyword == "map_Ka") {
+            current->tex_ambient_name = objGetTextureName(str, line_end);
+        } else if (keyword == "map_Kd") {
+            current->tex_diffuse_name = objGetTextureName(str, line_end);
+        } else if (keyword == "map_Ks") {
+            current->tex_specular_name = objGetTextureName(str, line_end);
+        } else if (keyword == "map_Bump" || keyword == "map_bump" ||
+                   keyword == "bump") {
+            current->tex_normal_name = objGetTextureName(str, line_end);
+        } else if (keyword == "map_d") {
+            current->tex_alpha_name = objGetTextureName(str, line_end);
+        }
+    }
+}
+
+std::string
+objGetTextureName(char const *str, char const *end)
+{
+    // Options come first, "-type" and "-imfchan" take a word,
+    // others take numbers or on / off
+    while (str < end && *str == '-') {
+        auto option = objReadKeyword(str, end);
+        bool takes_word = option == "-type" || option == "-imfchan";
+
+        while (str < end) {
+            auto arg_begin = str;
+            auto arg = objReadKeyword(str, end);
+            float number;
+
+            if (takes_word) {
+                break;
+            }
+            if (arg != "on" && arg != "off" &&
+                objParseFloat(arg_begin, arg_begin + arg.size(), number) !=
+                  arg_begin + arg.size()) {
+                str = arg_begin;
+                break;
+            }
+        }
+    }
+    return (std::string(str, end));
+}
@@ -0,0 +1,131 @@
+#ifndef SCOP_VULKAN_OBJMODELLOADER_HPP
+#define SCOP_VULKAN_OBJMODELLOADER_HPP
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <unordered_map>
+#include <cstdint>
+
+#include "glm/glm.hpp"
+
+#include "Mesh.hpp"
+#include "ModelLoadingOption.hpp"
+#include "ModelMeshData.hpp"
+
+// Indices of a face corner as written in the file, 0 when absent.
+// Relative indices are turned into absolute ones before use.
+struct ObjCorner final
+{
+    int32_t v;
+    int32_t vt;
+    int32_t vn;
+};
+
+// Face using relative indices with the chunk local counts at its position
+struct ObjRelativeFace final
+{
+    uint32_t face_index;
+    uint32_t nb_positions;
+    uint32_t nb_tex_coords;
+    uint32_t nb_normals;
+};
+
+// "o", "g" or "usemtl" statement, ends the current mesh
+struct ObjMeshEvent final
+{
+    uint32_t face_index;
+    bool is_material;
+    std::string name;
+};
+
+struct ObjChunkData final
+{
+    std::vector<glm::vec3> positions;
+    std::vector<glm::vec2> tex_coords;
+    std::vector<glm::vec3> normals;
+    std::vector<ObjCorner> corners;
+    // First corner of each face, last element is the corner count
+    std::vector<uint32_t> face_offsets;
+    std::vector<ObjRelativeFace> relative_faces;
+    std::vector<ObjMeshEvent> events;
+    std::vector<std::string> mtllibs;
+};
+
+struct ObjFaceRange final
+{
+    uint32_t chunk;
+    uint32_t face_begin;
+    uint32_t face_end;
+};
+
+struct ObjMeshDesc final
+{
+    std::string name;
+    std::string material_name;
+    std::vector<ObjFaceRange> ranges;
+};
+
+struct ObjModelData final
+{
+    std::vector<ObjChunkData> chunks;
+    std::vector<glm::vec3> positions;
+    std::vector<glm::vec2> tex_coords;
+    std::vector<glm::vec3> normals;
+    std::vector<ObjMeshDesc> meshes;
+    std::unordered_map<std::string, Material> materials;
+};
+
+// Returns false when the file has to be imported by Assimp,
+// either because of unsupported statements or invalid content.
+// Output matches the Assimp import flags used by assimpLoadModel.
+bool objLoadModel(char const *model_path,
+                  std::vector<Vertex> &vertex_list,
+                  std::vector<uint32_t> &indices_list,
+                  std::vector<Mesh> &mesh_list,
+                  ModelLoadingOption const &option);
+
+// Parsing
+std::vector<size_t> objSplitChunks(char const *data,
+                                   size_t size,
+                                   size_t nbChunks);
+bool objParseChunk(char const *begin, char const *end, ObjChunkData &chunk);
+bool objParseFace(char const *str, char const *end, ObjChunkData &chunk);
+char const *objParseFloat(char const *str, char const *end, float &value);
+char const *objParseInt(char const *str, char const *end, int32_t &value);
+size_t objParseDigits(char const *&str, char const *end, uint64_t &value);
+char const *objReadLine(char const *line,
+                        char const *end,
+                        char const *&str,
+                        char const *&str_end);
+std::string_view objReadKeyword(char const *&str, char const *end);
+// Libraries of a mtllib statement, str starts after the keyword
+void objReadMaterialLibs(char const *str,
+                         char const *end,
+                         std::vector<std::string> &mtllibs);
+char const *objSkipSpaces(char const *str, char const *end);
+
+// Model assembly
+void objGatherVertexData(ObjModelData &model, uint32_t nbThreads);
+void objResolveRelativeFaces(ObjChunkData &chunk,
+                             uint32_t basePositions,
+                             uint32_t baseTexCoords,
+                             uint32_t baseNormals);
+void objBuildMeshDescs(ObjModelData &model);
+void objBuildMeshData(ObjModelData const &model,
+                      ObjMeshDesc const &desc,
+                      ModelMeshData &data);
+void objGenerateNormals(std::vector<ObjCorner> const &corners,
+                        std::vector<uint32_t> const &indices_list,
+                        std::vector<Vertex> &vertex_list);
+void objGenerateTangents(std::vector<uint32_t> const &indices_list,
+                         std::vector<Vertex> &vertex_list);
+glm::vec3 objSafeNormalize(glm::vec3 const &vec);
+
+// Materials
+Material objDefaultMaterial(std::string const &name);
+void objLoadMaterialLib(std::string const &path,
+                        std::unordered_map<std::string, Material> &materials);
+std::string objGetTextureName(char const *str, char const *end);
+
+#endif // SCOP_VULKAN_OBJMODELLOADER_HPP
@@ -0,0 +1,105 @@
+#include "PackedVertex.hpp"
+
+#include <cmath>
+#include <cstring>
+
+#include "glm/gtc/packing.hpp"
+
+static_assert(sizeof(PackedVertex) == 20,
+              "PackedVertex is expected to be 20 bytes");
+
+PackedVertex
+packVertex(Vertex const &vertex,
+           glm::vec3 const &minPoint,
+           glm::vec3 const &invExtent)
+{
+    PackedVertex packed{};
+
+    // Position + tangent frame handedness
+    auto bitangent_sign =
+      glm::dot(glm::cross(vertex.normal, vertex.tangent), vertex.bitangent);
+    auto position = glm::vec4((vertex.position - minPoint) * invExtent,
+                              (bitangent_sign < 0.0f) ? 0.0f : 1.0f);
+    auto packed_position = glm::packUnorm4x16(position);
+    std::memcpy(packed.position, &packed_position, sizeof(packed.position));
+
+    // Normal / Tangent / Tex coords
+    packed.normal = packOctahedral(vertex.normal);
+    packed.tangent = packOctahedral(vertex.tangent);
+    packed.tex_coords = glm::packHalf2x16(vertex.tex_coords);
+    return (packed);
+}
+
+uint32_t
+packOctahedral(glm::vec3 const &vec)
+{
+    float norm = std::abs(vec.x) + std::abs(vec.y) + std::abs(vec.z);
+    if (norm == 0.0f) {
+        return (glm::packSnorm2x16(glm::vec2(0.0f)));
+    }
+
+    // Lower hemisphere is folded over the diagonals
+    auto oct = glm::vec2(vec.x, vec.y) / norm;
+    if (vec.z < 0.0f) {
+        float sign_x = (oct.x >= 0.0f) ? 1.0f : -1.0f;
+        float sign_y = (oct.y >= 0.0f) ? 1.0f : -1.0f;
+        oct = glm::vec2((1.0f - std::abs(oct.y)) * sign_x,
+                        (1.0f - std::abs(oct.x)) * sign_y);
+    }
+    return (glm::packSnorm2x16(oct));
+}
+
+glm::vec3
+getPackingInvExtent(Mesh const &mesh)
+{
+    auto extent = mesh.max_point - mesh.min_point;
+
+    // Flat axis, every vertex is at min point
+    return (glm::vec3((extent.x > 0.0f) ? 1.0f / extent.x : 0.0f,
+                      (extent.y > 0.0f) ? 1.0f / extent.y : 0.0f,
+                      (extent.z > 0.0f) ? 1.0f / extent.z : 0.0f));
+}
+
+void
+packModelVertices(std::span<Vertex const> vertex_list,
+                  std::span<uint32_t const> indices_list,
+                  std::vector<Mesh> const &mesh_list,
+                  std::vector<PackedVertex> &packed_vertex_list,
+                  std::vector<uint32_t> &packed_indices_list)
+{
+    static constexpr uint32_t const NOT_PACKED = UINT32_MAX;
+
+    std::vector<uint32_t> remap(vertex_list.size(), NOT_PACKED);
+    std::vector<uint32_t> mesh_vertices;
+    packed_vertex_list.clear();
+    packed_vertex_list.reserve(vertex_list.size());
+    packed_indices_list.resize(indices_list.size());
+    for (auto const &it : mesh_list) {
+        auto inv_extent = getPackingInvExtent(it);
+        auto pack_range = [&](uint32_t offset, uint32_t nbIndices) -> void {
+            for (uint32_t i = offset; i < offset + nbIndices; ++i) {
+                auto index = indices_list[i];
+
+                if (remap[index] == NOT_PACKED) {
+                    remap[index] = packed_vertex_list.size();
+                    packed_vertex_list.emplace_back(
+                      packVertex(vertex_list[index], it.min_point, inv_extent));
+                    mesh_vertices.emplace_back(index);
+                }
+                packed_indices_list[i] = remap[index];
+            }
+        };
+
+        // Lods only use vertices of their mesh
+        pack_range(it.indices_offset, it.nb_indices);
+        for (auto const &lod : it.lods) {
+            pack_range(lod.indices_offset, lod.nb_indices);
+        }
+
+        // Next mesh gets its own copies
+        for (auto const &index : mesh_vertices) {
+            remap[index] = NOT_PACKED;
+        }
+        mesh_vertices.clear();
+    }
+}
@@ -0,0 +1,163 @@
+#ifndef SCOP_VULKAN_WELDTABLE_HPP
+#define SCOP_VULKAN_WELDTABLE_HPP
+
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <vector>
+
+#include "Mesh.hpp"
+#include "ModelHash.hpp"
+
+// Open addressing table used to weld identical values during import.
+// Slots only store a hash tag and the value index, values themselves
+// live in the bound list. Values are normalized by weldNormalize then
+// hashed and compared bitwise so T must not contain padding.
+template<typename T>
+class WeldTable final
+{
+  public:
+    WeldTable(std::vector<T> &valueList, size_t expectedNbValues);
+    ~WeldTable() = default;
+    WeldTable(WeldTable const &src) = delete;
+    WeldTable &operator=(WeldTable const &rhs) = delete;
+    WeldTable(WeldTable &&src) = delete;
+    WeldTable &operator=(WeldTable &&rhs) = delete;
+
+    // Returns index of value, appending it to the value list when unseen.
+    // Indices are relative to the value list size at table creation.
+    uint32_t weld(T const &value);
+    [[nodiscard]] uint32_t getNbUniqueValues() const;
+
+  private:
+    static constexpr uint32_t const EMPTY_SLOT = UINT32_MAX;
+    static constexpr uint64_t const MAX_LOAD_NUMERATOR = 3;
+    static constexpr uint64_t const MAX_LOAD_DENOMINATOR = 4;
+
+    struct Slot final
+    {
+        uint32_t tag = 0;
+        uint32_t index = EMPTY_SLOT;
+    };
+
+    std::vector<T> &_value_list;
+    size_t _base{};
+    uint32_t _nb_unique_values{};
+    uint64_t _mask{};
+    std::vector<Slot> _slots;
+
+    inline void _allocate_slots(size_t nbValues);
+    inline void _grow();
+};
+
+using VertexWeldTable = WeldTable<Vertex>;
+
+template<typename T>
+inline T
+weldNormalize(T const &value)
+{
+    return (value);
+}
+
+static_assert(sizeof(Vertex) == 56, "Vertex is expected to be 14 floats");
+
+// -0 becomes +0 so both weld as with Vertex::operator==. NaN components
+// weld when bitwise identical, operator== never matches them.
+inline Vertex
+weldNormalize(Vertex const &value)
+{
+    auto normalize = [](auto &vec) -> void {
+        for (glm::length_t i = 0; i < vec.length(); ++i) {
+            vec[i] = (vec[i] == 0.0f) ? 0.0f : vec[i];
+        }
+    };
+
+    Vertex normalized = value;
+    normalize(normalized.position);
+    normalize(normalized.normal);
+    normalize(normalized.tex_coords);
+    normalize(normalized.tangent);
+    normalize(normalized.bitangent);
+    return (normalized);
+}
+
+template<typename T>
+WeldTable<T>::WeldTable(std::vector<T> &valueList, size_t expectedNbValues)
+  : _value_list(valueList)
+  , _base(valueList.size())
+{
+    _allocate_slots(expectedNbValues);
+}
+
+template<typename T>
+uint32_t
+WeldTable<T>::weld(T const &value)
+{
+    if ((_nb_unique_values + 1) * MAX_LOAD_DENOMINATOR >
+        _slots.size() * MAX_LOAD_NUMERATOR) {
+        _grow();
+    }
+
+    // Stored values are normalized as well
+    auto normalized = weldNormalize(value);
+    auto hash = hashBytes(&normalized, sizeof(T));
+    auto tag = static_cast<uint32_t>(hash >> 32);
+    auto pos = hash & _mask;
+    while (true) {
+        auto &slot = _slots[pos];
+
+        if (slot.index == EMPTY_SLOT) {
+            slot.tag = tag;
+            slot.index = _nb_unique_values;
+            _value_list.emplace_back(normalized);
+            return (_nb_unique_values++);
+        }
+        if (slot.tag == tag &&
+            !std::memcmp(
+              &_value_list[_base + slot.index], &normalized, sizeof(T))) {
+            return (slot.index);
+        }
+        pos = (pos + 1) & _mask;
+    }
+}
+
+template<typename T>
+uint32_t
+WeldTable<T>::getNbUniqueValues() const
+{
+    return (_nb_unique_values);
+}
+
+template<typename T>
+void
+WeldTable<T>::_allocate_slots(size_t nbValues)
+{
+    size_t nb_slots = 16;
+    while (nb_slots * MAX_LOAD_NUMERATOR < nbValues * MAX_LOAD_DENOMINATOR) {
+        nb_slots <<= 1;
+    }
+    if (nb_slots > (static_cast<size_t>(1) << 32)) {
+        throw std::runtime_error("WeldTable: Too many values");
+    }
+    _slots.assign(nb_slots, Slot{});
+    _mask = nb_slots - 1;
+}
+
+template<typename T>
+void
+WeldTable<T>::_grow()
+{
+    _allocate_slots(_slots.size());
+    for (uint32_t i = 0; i < _nb_unique_values; ++i) {
+        auto hash = hashBytes(&_value_list[_base + i], sizeof(T));
+        auto pos = hash & _mask;
+
+        while (_slots[pos].index != EMPTY_SLOT) {
+            pos = (pos + 1) & _mask;
+        }
+        _slots[pos].tag = static_cast<uint32_t>(hash >> 32);
+        _slots[pos].index = i;
+    }
+}
+
+#endif // SCOP_VULKAN_WELDTABLE_HPP
@@ -3,11 +3,9 @@
 
 #include <string>
 #include <vector>
-#include <functional>
+#include <cstdint>
 
 #include "glm/glm.hpp"
-#define GLM_ENABLE_EXPERIMENTAL
-#include <glm/gtx/hash.hpp>
 
 struct Vertex final
 {
@@ -36,6 +34,36 @@ struct Material final
     std::string tex_alpha_name;
 };
 
+static constexpr uint32_t const MAX_MESH_LODS = 8;
+
+// Simplified index range drawn in place of the full mesh, error is the
+// maximum geometric deviation from the full mesh in model space
+struct MeshLod final
+{
+    uint32_t nb_indices{};
+    uint32_t indices_offset{};
+    float error{};
+};
+
+static constexpr uint32_t const MAX_CLUSTER_VERTICES = 64;
+static constexpr uint32_t const MAX_CLUSTER_TRIANGLES = 124;
+
+// Contiguous part of a full mesh index range, laid out to be uploaded
+// as is in a std430 buffer. Backfacing when seen from a camera at c:
+// dot(center - c, cone_axis) > cone_cutoff * length(center - c) + radius
+struct MeshCluster final
+{
+    glm::vec3 center{};
+    float radius{};
+    glm::vec3 cone_axis{};
+    float cone_cutoff{};
+    uint32_t indices_offset{};
+    uint32_t nb_indices{};
+    uint32_t mesh_index{};
+    // Added to indices, 0 while indices are model wide
+    int32_t vertex_offset{};
+};
+
 struct Mesh final
 {
     void printMesh() const;
@@ -47,31 +75,30 @@ struct Mesh final
     uint32_t nb_faces{};
     uint32_t nb_indices{};
     uint32_t indices_offset{};
+    // Coarser levels first to last, full mesh is not part of it
+    std::vector<MeshLod> lods;
+    // Range in the model cluster list
+    uint32_t nb_clusters{};
+    uint32_t clusters_offset{};
     std::string mesh_name;
 };
 
-size_t constexpr hash_combine(size_t h1, size_t h2)
-{
-    return (h1 ^ (h2 << 1));
-}
-
-namespace std {
-template<>
-struct hash<Vertex> final
+// Meshes sharing a material, contiguous in the mesh list. Their full
+// ranges, each lod level and their clusters are contiguous as well so a
+// batch is drawn at once. Meshes with less levels repeat their coarsest
+// one in the lods of the batch.
+struct MeshBatch final
 {
-    size_t
-    operator()(Vertex const &vertex) const noexcept
-    {
-        using namespace glm;
-        auto h1 = hash_combine(hash<vec3>()(vertex.position),
-                               hash<vec3>()(vertex.normal)) >>
-                  1;
-        auto h2 = hash_combine(h1, hash<vec2>()(vertex.tex_coords)) >> 1;
-        auto h3 = hash_combine(h2, hash<vec3>()(vertex.tangent)) >> 1;
-        auto h4 = hash_combine(h3, hash<vec3>()(vertex.bitangent));
-        return (h4);
-    }
+    uint32_t first_mesh{};
+    uint32_t nb_meshes{};
+    uint32_t nb_indices{};
+    uint32_t indices_offset{};
+    uint32_t nb_lods{};
+    MeshLod lods[MAX_MESH_LODS]{};
+    uint32_t nb_clusters{};
+    uint32_t clusters_offset{};
+    glm::vec3 min_point{};
+    glm::vec3 max_point{};
 };
-}
 
 #endif
@@ -0,0 +1,30 @@
+#ifndef SCOP_VULKAN_MESHINDEXBLOCK_HPP
+#define SCOP_VULKAN_MESHINDEXBLOCK_HPP
+
+#include <span>
+#include <vector>
+#include <cstdint>
+
+#include "Mesh.hpp"
+
+// Indices of a mesh, full detail range followed by its lods. Meshes
+// referencing less than 65536 vertices get 16 bits indices relative to
+// their first vertex.
+struct MeshIndexBlock final
+{
+    // In bytes from the start of the index data, multiple of 4
+    uint64_t offset;
+    // 2 or 4
+    uint32_t index_size;
+    // Added to every index of the block
+    int32_t vertex_offset;
+    // Block relative first index of each level, 0 is the full mesh
+    uint32_t levels_offset[MAX_MESH_LODS + 1];
+};
+
+void buildMeshIndexBlocks(std::span<uint32_t const> indices_list,
+                          std::vector<Mesh> const &mesh_list,
+                          std::vector<MeshIndexBlock> &blocks,
+                          std::vector<uint8_t> &index_data);
+
+#endif // SCOP_VULKAN_MESHINDEXBLOCK_HPP
@@ -2,10 +2,15 @@
 #define SCOP_VULKAN_MODEL_HPP
 
 #include <vector>
+#include <span>
+#include <memory>
 
 #include "glm/glm.hpp"
 
 #include "Mesh.hpp"
+#include "ModelLoadingOption.hpp"
+
+class MappedFile;
 
 struct ModelInfo
 {
@@ -14,26 +19,48 @@ struct ModelInfo
     uint32_t nbFaces{};
 };
 
+// Vertex cache efficiency of the last import, ACMR is transformed
+// vertices per triangle, ATVR is transforms per unique vertex
+struct ModelOptimizationInfo
+{
+    bool optimized{};
+    float acmrBefore{};
+    float acmrAfter{};
+    float atvrBefore{};
+    float atvrAfter{};
+};
+
 class Model final
 {
   public:
     Model() = default;
-    explicit Model(std::string const &model_path);
-    explicit Model(char const *model_path);
+    explicit Model(std::string const &model_path,
+                   ModelLoadingOption const &option = {});
+    explicit Model(char const *model_path,
+                   ModelLoadingOption const &option = {});
     Model(Model const &src) = default;
     Model &operator=(Model const &rhs) = default;
     Model(Model &&src) noexcept = default;
     Model &operator=(Model &&rhs) noexcept = default;
     ~Model() = default;
 
-    void loadModel(std::string const &model_path);
-    void loadModel(char const *model_path);
+    void loadModel(std::string const &model_path,
+                   ModelLoadingOption const &option = {});
+    void loadModel(char const *model_path,
+                   ModelLoadingOption const &option = {});
     void printModel() const;
     [[nodiscard]] ModelInfo getModelInfo() const;
+    [[nodiscard]] ModelOptimizationInfo const &getOptimizationInfo() const;
 
-    [[nodiscard]] std::vector<Vertex> const &getVertexList() const;
-    [[nodiscard]] std::vector<uint32_t> const &getIndicesList() const;
+    // Point into the model cache mapping when loaded from cache
+    [[nodiscard]] std::span<Vertex const> getVertexList() const;
+    [[nodiscard]] std::span<uint32_t const> getIndicesList() const;
+    [[nodiscard]] std::span<MeshCluster const> getClusterList() const;
     [[nodiscard]] std::vector<Mesh> const &getMeshList() const;
+    [[nodiscard]] std::span<MeshBatch const> getMeshBatchList() const;
+    // One mesh per batch, what renderers draw. Per mesh data stays in
+    // the mesh list.
+    [[nodiscard]] std::vector<Mesh> const &getBatchedMeshList() const;
     [[nodiscard]] std::string const &getDirectory() const;
     [[nodiscard]] glm::vec3 const &getCenter() const;
 
@@ -41,13 +68,24 @@ class Model final
     std::vector<Vertex> _vertex_list;
     std::vector<uint32_t> _indices_list;
     std::vector<Mesh> _mesh_list;
+    std::vector<MeshCluster> _cluster_list;
+    std::vector<MeshBatch> _batch_list;
+    std::vector<Mesh> _batched_mesh_list;
     glm::vec3 _center{};
     glm::vec3 _min_point{};
     glm::vec3 _max_point{};
     uint32_t _nb_faces{};
+    ModelOptimizationInfo _optimization_info{};
     std::string _model_path;
     std::string _directory;
+    std::shared_ptr<MappedFile const> _cache_file;
+    std::span<Vertex const> _cached_vertex_list;
+    std::span<uint32_t const> _cached_indices_list;
+    std::span<MeshCluster const> _cached_cluster_list;
+    std::span<MeshBatch const> _cached_batch_list;
 
+    inline void _load_model(ModelLoadingOption const &option);
+    inline void _optimize_meshes(ModelLoadingOption const &option);
     inline void _compute_min_max_points_and_center();
 };
 
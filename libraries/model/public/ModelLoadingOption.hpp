@@ -0,0 +1,50 @@
+#ifndef SCOP_VULKAN_MODELLOADINGOPTION_HPP
+#define SCOP_VULKAN_MODELLOADINGOPTION_HPP
+
+#include <cstdint>
+#include <string>
+
+#include "ModelLoadingProgress.hpp"
+
+struct ModelLoadingOption final
+{
+    // Process meshes on worker threads, output is identical to serial import
+    bool parallel_import = true;
+    // 0 means one thread per hardware thread
+    uint32_t nb_import_threads{};
+
+    // Native OBJ / MTL reader, Assimp handles what it does not support
+    bool use_native_obj_loader = true;
+
+    // Quadric error simplified index ranges per mesh, stored after the
+    // full meshes. Each level keeps lod_reduction_ratio of the triangles
+    // of the previous one, up to MAX_MESH_LODS levels.
+    bool generate_lods = true;
+    uint32_t nb_lods = 4;
+    float lod_reduction_ratio = 0.5f;
+
+    // Triangle reordering for the post-transform vertex cache and
+    // vertex reordering in fetch order, runs after import
+    bool optimize_vertex_cache = true;
+    // Reorders triangle clusters to draw outward facing ones first,
+    // trades some vertex cache efficiency for less overdraw
+    bool optimize_overdraw = false;
+
+    // Groups meshes with identical materials so each material is drawn
+    // at once, runs after vertex cache optimization
+    bool batch_meshes = true;
+
+    // Splits full meshes in clusters of at most MAX_CLUSTER_VERTICES
+    // vertices and MAX_CLUSTER_TRIANGLES triangles with their bounds
+    bool build_clusters = true;
+
+    // Binary cache of the imported model, mapped on the next load
+    bool use_model_cache = true;
+    // Empty means $XDG_CACHE_HOME/scop or $HOME/.cache/scop
+    std::string model_cache_directory;
+
+    // Optional, updated between loading steps. Not part of the cache key.
+    ModelLoadingProgress *progress{};
+};
+
+#endif // SCOP_VULKAN_MODELLOADINGOPTION_HPP
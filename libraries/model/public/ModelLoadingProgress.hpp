@@ -0,0 +1,33 @@
+#ifndef SCOP_VULKAN_MODELLOADINGPROGRESS_HPP
+#define SCOP_VULKAN_MODELLOADINGPROGRESS_HPP
+
+#include <atomic>
+#include <stdexcept>
+
+// Shared between the thread loading a model and the ones watching it
+struct ModelLoadingProgress final
+{
+    // Share of the loading done, in [0, 1]
+    std::atomic<float> progress{};
+    // Loading throws at its next step, mesh or file chunk once set
+    std::atomic<bool> cancel{};
+};
+
+class ModelLoadingCancelled final : public std::runtime_error
+{
+  public:
+    ModelLoadingCancelled()
+      : std::runtime_error("Model: Loading cancelled")
+    {}
+};
+
+// Throws ModelLoadingCancelled once cancel is set, progress may be null
+inline void
+checkModelLoadingCancel(ModelLoadingProgress const *progress)
+{
+    if (progress && progress->cancel) {
+        throw ModelLoadingCancelled();
+    }
+}
+
+#endif // SCOP_VULKAN_MODELLOADINGPROGRESS_HPP
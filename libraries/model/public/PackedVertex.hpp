@@ -0,0 +1,38 @@
+#ifndef SCOP_VULKAN_PACKEDVERTEX_HPP
+#define SCOP_VULKAN_PACKEDVERTEX_HPP
+
+#include <span>
+#include <vector>
+#include <cstdint>
+
+#include "glm/glm.hpp"
+
+#include "Mesh.hpp"
+
+// 20 bytes vertex decoded in model_packed.vert
+struct PackedVertex final
+{
+    // Unorm16 inside the mesh AABB, w is the bitangent sign (0 = -1, 1 = 1)
+    uint16_t position[4];
+    // Octahedral snorm16 x2
+    uint32_t normal;
+    uint32_t tangent;
+    // Half float x2
+    uint32_t tex_coords;
+};
+
+PackedVertex packVertex(Vertex const &vertex,
+                        glm::vec3 const &minPoint,
+                        glm::vec3 const &invExtent);
+uint32_t packOctahedral(glm::vec3 const &vec);
+glm::vec3 getPackingInvExtent(Mesh const &mesh);
+
+// Vertices shared between meshes are duplicated since each mesh has
+// its own quantization range. Mesh and lod index ranges are kept as is.
+void packModelVertices(std::span<Vertex const> vertex_list,
+                       std::span<uint32_t const> indices_list,
+                       std::vector<Mesh> const &mesh_list,
+                       std::vector<PackedVertex> &packed_vertex_list,
+                       std::vector<uint32_t> &packed_indices_list);
+
+#endif // SCOP_VULKAN_PACKEDVERTEX_HPP
@@ -0,0 +1,75 @@
+#ifndef SCOP_VULKAN_PARALLELFOR_HPP
+#define SCOP_VULKAN_PARALLELFOR_HPP
+
+#include <cstdint>
+#include <cstddef>
+#include <atomic>
+#include <thread>
+#include <vector>
+#include <mutex>
+#include <exception>
+
+inline uint32_t
+getNbWorkerThreads()
+{
+    auto nb_threads = std::thread::hardware_concurrency();
+    return ((nb_threads) ? nb_threads : 1);
+}
+
+// Runs fct(taskIndex) for every taskIndex in [0, nbTasks) on a set of
+// worker threads. Tasks are picked in order from a shared counter so
+// big and small tasks get balanced between workers.
+// First exception thrown by a task is rethrown on the calling thread.
+template<typename TaskFct>
+void
+parallelFor(size_t nbTasks, TaskFct &&fct, uint32_t nbThreads = 0)
+{
+    if (!nbTasks) {
+        return;
+    }
+    if (!nbThreads) {
+        nbThreads = getNbWorkerThreads();
+    }
+    if (nbThreads > nbTasks) {
+        nbThreads = static_cast<uint32_t>(nbTasks);
+    }
+    if (nbThreads == 1) {
+        for (size_t i = 0; i < nbTasks; ++i) {
+            fct(i);
+        }
+        return;
+    }
+
+    std::atomic<size_t> next_task{};
+    std::exception_ptr error{};
+    std::mutex error_mutex;
+    auto worker = [&]() -> void {
+        size_t task_index;
+        while ((task_index = next_task.fetch_add(1)) < nbTasks) {
+            try {
+                fct(task_index);
+            } catch (...) {
+                std::scoped_lock lock(error_mutex);
+                if (!error) {
+                    error = std::current_exception();
+                }
+                next_task = nbTasks;
+            }
+        }
+    };
+
+    std::vector<std::thread> workers;
+    workers.reserve(nbThreads - 1);
+    for (uint32_t i = 1; i < nbThreads; ++i) {
+        workers.emplace_back(worker);
+    }
+    worker();
+    for (auto &it : workers) {
+        it.join();
+    }
+    if (error) {
+        std::rethrow_exception(error);
+    }
+}
+
+#endif // SCOP_VULKAN_PARALLELFOR_HPP
@@ -106,10 +106,13 @@ Ui::drawUi()
     }
     _draw_menu_bar();
     _about_window();
-    _info_overview.draw(_show_info_fps, _show_info_model);
+    _info_overview.draw(_show_info_fps, _show_info_model, _show_info_memory);
     _ui_events.events[UET_NEW_MODEL] =
       _open_model_window.drawFilepathWindow(_select_model);
     _open_model_window.drawErrorWindow(_model_loading_error);
+    _ui_events.events[UET_CANCEL_MODEL_LOADING] =
+      _open_model_window.drawLoadingWindow(_model_loading,
+                                           _model_loading_progress);
     _ui_events.events[UET_UPDATE_MODEL_PARAMS] =
       _model_param_window.draw(_model_orientation);
 
@@ -122,12 +125,25 @@ Ui::setModelInfo(uint32_t nbVertices, uint32_t nbIndices, uint32_t nbFaces)
     _info_overview.setModelInfo(nbVertices, nbIndices, nbFaces);
 }
 
+void
+Ui::setMemoryReport(VulkanMemoryReport const &report)
+{
+    _info_overview.setMemoryReport(report);
+}
+
 void
 Ui::setModelLoadingError()
 {
     _model_loading_error = true;
 }
 
+void
+Ui::setModelLoadingProgress(bool loading, float progress)
+{
+    _model_loading = loading;
+    _model_loading_progress = progress;
+}
+
 void
 Ui::resetModelParams()
 {
@@ -164,6 +180,18 @@ Ui::getModelFilepath() const
     return (_open_model_window.getModelFilepath());
 }
 
+ModelRenderingOption
+Ui::getModelRenderingOption() const
+{
+    return (_open_model_window.getRenderingOption());
+}
+
+bool
+Ui::isMemoryInfoDisplayed() const
+{
+    return (_display_ui && _show_info_memory);
+}
+
 void
 Ui::_draw_menu_bar()
 {
@@ -199,6 +227,8 @@ Ui::_draw_menu_bar()
             ImGui::Separator();
             ImGui::MenuItem("Show Fps", "F7", &_show_info_fps);
             ImGui::Separator();
+            ImGui::MenuItem("Memory Info", nullptr, &_show_info_memory);
+            ImGui::Separator();
             _ui_events.events[UET_FULLSCREEN] =
               ImGui::MenuItem("Fullscreen", "F8", &_fullscreen);
             ImGui::Separator();
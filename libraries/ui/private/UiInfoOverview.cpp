@@ -3,7 +3,7 @@
 #include "imgui.h"
 
 void
-UiInfoOverview::draw(bool &fps, bool &model_info) const
+UiInfoOverview::draw(bool &fps, bool &model_info, bool &memory_info) const
 {
     static constexpr float const PADDING = 10.0f;
     static constexpr ImGuiWindowFlags const WIN_FLAGS =
@@ -18,16 +18,19 @@ UiInfoOverview::draw(bool &fps, bool &model_info) const
     static ImVec4 const YELLOW = { 255, 255, 0, 255 };
     static ImVec4 const GREEN = { 0, 255, 0, 255 };
 
-    if (model_info || fps) {
+    if (model_info || fps || memory_info) {
         ImGuiViewport const *viewport = ImGui::GetMainViewport();
         ImVec2 work_pos = viewport->WorkPos;
         ImVec2 work_size = viewport->WorkSize;
         ImVec2 window_pos{ (work_pos.x + work_size.x - PADDING),
                            (work_pos.y + PADDING) };
 
-        ImGui::SetNextWindowSize(WIN_SIZE_SIMPLE);
-        if (fps && model_info) {
-            ImGui::SetNextWindowSize(WIN_SIZE_BOTH);
+        // Memory info sizes the window on its own
+        if (!memory_info) {
+            ImGui::SetNextWindowSize(WIN_SIZE_SIMPLE);
+            if (fps && model_info) {
+                ImGui::SetNextWindowSize(WIN_SIZE_BOTH);
+            }
         }
         ImGui::SetNextWindowPos(window_pos, ImGuiCond_Always, WIN_POS_PIVOT);
         ImGui::SetNextWindowBgAlpha(WIN_ALPHA);
@@ -65,6 +68,12 @@ UiInfoOverview::draw(bool &fps, bool &model_info) const
                             _nb_indices,
                             _nb_faces);
             }
+            if ((fps || model_info) && memory_info) {
+                ImGui::Separator();
+            }
+            if (memory_info) {
+                _draw_memory_info();
+            }
             ImGui::End();
         }
     }
@@ -91,3 +100,47 @@ UiInfoOverview::setModelInfo(uint32_t nbVertices,
     _nb_faces = nbFaces;
     _nb_indices = nbIndices;
 }
+
+void
+UiInfoOverview::setMemoryReport(VulkanMemoryReport const &report)
+{
+    _memory_report = report;
+}
+
+void
+UiInfoOverview::_draw_memory_info() const
+{
+    static constexpr float const MIB = 1024.0f * 1024.0f;
+
+    ImGui::Text("GPU Memory (MiB)");
+    for (size_t i = 0; i < VMC_TOTAL_NB; ++i) {
+        ImGui::Text("%s: %.2f",
+                    MEMORY_CATEGORY_NAMES[i],
+                    _memory_report.categories[i] / MIB);
+    }
+    ImGui::Separator();
+    ImGui::Text("Allocated: %.2f (Peak: %.2f)",
+                _memory_report.current.allocated_size / MIB,
+                _memory_report.peak.allocated_size / MIB);
+    ImGui::Text("Used: %.2f (Peak: %.2f)",
+                _memory_report.current.used_size / MIB,
+                _memory_report.peak.used_size / MIB);
+    ImGui::Text("Blocks: %u (Peak: %u)",
+                _memory_report.current.nb_blocks,
+                _memory_report.peak.nb_blocks);
+    ImGui::Text("Allocations: %u (Peak: %u)",
+                _memory_report.current.nb_allocations,
+                _memory_report.peak.nb_allocations);
+    ImGui::Separator();
+    if (!_memory_report.has_memory_budget) {
+        ImGui::Text("No driver budget, app usage only");
+    }
+    for (size_t i = 0; i < _memory_report.heaps.size(); ++i) {
+        auto const &heap = _memory_report.heaps[i];
+        ImGui::Text("Heap %zu%s: %.2f / %.2f",
+                    i,
+                    (heap.device_local) ? " (Device)" : "",
+                    heap.usage / MIB,
+                    heap.budget / MIB);
+    }
+}
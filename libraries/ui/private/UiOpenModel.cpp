@@ -8,7 +8,7 @@ UiOpenModel::drawFilepathWindow(bool &open)
     static constexpr ImGuiWindowFlags const WIN_FLAGS =
       ImGuiWindowFlags_NoCollapse | ImGuiWindowFlags_NoResize |
       ImGuiWindowFlags_NoSavedSettings | ImGuiWindowFlags_NoMove;
-    static ImVec2 const WIN_SIZE = ImVec2(400, 80);
+    static ImVec2 const WIN_SIZE = ImVec2(400, 190);
     static ImVec2 const WIN_POS_PIVOT = { 0.5f, 0.5f };
     static constexpr ImGuiInputTextFlags const INPUT_TEXT_FLAGS =
       ImGuiInputTextFlags_EnterReturnsTrue | ImGuiInputTextFlags_NoUndoRedo;
@@ -36,6 +36,17 @@ UiOpenModel::drawFilepathWindow(bool &open)
             open = false;
             _force_focus = true;
         }
+        // Unsupported options are disabled by the renderer
+        ImGui::Checkbox("Packed vertices", &_rendering_option.packed_vertices);
+        ImGui::Checkbox("Lod selection", &_rendering_option.lod_selection);
+        ImGui::Checkbox("Cluster culling", &_rendering_option.cluster_culling);
+        if (_rendering_option.cluster_culling) {
+            ImGui::SameLine();
+            ImGui::Checkbox("Backface culling",
+                            &_rendering_option.cluster_backface_culling);
+        }
+        ImGui::Checkbox("Bindless materials",
+                        &_rendering_option.bindless_materials);
         bool ok_pressed = ImGui::Button("Ok");
         ImGui::SameLine();
         if (ImGui::Button("Cancel")) {
@@ -73,8 +84,39 @@ UiOpenModel::drawErrorWindow(bool &open)
     }
 }
 
+bool
+UiOpenModel::drawLoadingWindow(bool open, float progress)
+{
+    static constexpr ImGuiWindowFlags const WIN_FLAGS =
+      ImGuiWindowFlags_NoCollapse | ImGuiWindowFlags_NoResize |
+      ImGuiWindowFlags_NoSavedSettings | ImGuiWindowFlags_NoMove;
+    static ImVec2 const WIN_SIZE = ImVec2(400, 80);
+    static ImVec2 const WIN_POS_PIVOT = { 0.5f, 0.5f };
+    bool trigger = false;
+
+    if (open) {
+        ImGuiViewport const *viewport = ImGui::GetMainViewport();
+        auto viewport_center = viewport->GetCenter();
+        ImVec2 window_pos{ viewport_center.x, viewport_center.y };
+
+        ImGui::SetNextWindowSize(WIN_SIZE);
+        ImGui::SetNextWindowPos(window_pos, ImGuiCond_Always, WIN_POS_PIVOT);
+        ImGui::Begin("Loading Model", nullptr, WIN_FLAGS);
+        ImGui::ProgressBar(progress);
+        trigger = ImGui::Button("Cancel");
+        ImGui::End();
+    }
+    return (trigger);
+}
+
 std::string
 UiOpenModel::getModelFilepath() const
 {
     return (_filepath);
+}
+
+ModelRenderingOption
+UiOpenModel::getRenderingOption() const
+{
+    return (_rendering_option);
 }
\ No newline at end of file
@@ -23,6 +23,7 @@ enum UiEventTypes
     UET_MOUSE_EXCLUSIVE,
     UET_INVERT_MOUSE_AXIS,
     UET_FULLSCREEN,
+    UET_CANCEL_MODEL_LOADING,
     UET_TOTAL_NB,
 };
 
@@ -65,22 +66,29 @@ class Ui final
                       uint32_t nbFaces);
     void resetModelParams();
     void setModelLoadingError();
+    void setModelLoadingProgress(bool loading, float progress);
+    void setMemoryReport(VulkanMemoryReport const &report);
 
     [[nodiscard]] float getModelYaw() const;
     [[nodiscard]] float getModelPitch() const;
     [[nodiscard]] float getModelRoll() const;
     [[nodiscard]] float getModelScale() const;
     [[nodiscard]] std::string getModelFilepath() const;
+    [[nodiscard]] ModelRenderingOption getModelRenderingOption() const;
+    [[nodiscard]] bool isMemoryInfoDisplayed() const;
 
   private:
     bool _show_info_model = false;
     bool _show_info_fps = false;
+    bool _show_info_memory = false;
     bool _about = false;
     bool _controls = false;
     bool _fullscreen = false;
     bool _display_ui = true;
     bool _select_model = false;
     bool _model_loading_error = false;
+    bool _model_loading = false;
+    float _model_loading_progress{};
     bool _close_app = false;
     bool _toggle_camera_mvt = false;
     bool _model_orientation = false;
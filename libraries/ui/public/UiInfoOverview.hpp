@@ -3,6 +3,8 @@
 
 #include <string>
 
+#include "VulkanMemoryReport.hpp"
+
 class UiInfoOverview final
 {
   public:
@@ -13,12 +15,13 @@ class UiInfoOverview final
     UiInfoOverview(UiInfoOverview &&src) = delete;
     UiInfoOverview &operator=(UiInfoOverview &&rhs) = delete;
 
-    void draw(bool &fps, bool &model_info) const;
+    void draw(bool &fps, bool &model_info, bool &memory_info) const;
     void setAvgFps(float avgFps);
     void setCurrentFps(float currentFps);
     void setModelInfo(uint32_t nbVertices,
                       uint32_t nbIndices,
                       uint32_t nbFaces);
+    void setMemoryReport(VulkanMemoryReport const &report);
 
   private:
     float _avg_fps{};
@@ -26,6 +29,9 @@ class UiInfoOverview final
     uint32_t _nb_vertices{};
     uint32_t _nb_indices{};
     uint32_t _nb_faces{};
+    VulkanMemoryReport _memory_report{};
+
+    inline void _draw_memory_info() const;
 };
 
 #endif // SCOP_VULKAN_INFO_OVERVIEW_HPP
@@ -3,6 +3,8 @@
 
 #include <string>
 
+#include "ModelRenderingOption.hpp"
+
 class UiOpenModel final
 {
   public:
@@ -15,10 +17,13 @@ class UiOpenModel final
 
     bool drawFilepathWindow(bool &open);
     void drawErrorWindow(bool &open);
+    bool drawLoadingWindow(bool open, float progress);
     [[nodiscard]] std::string getModelFilepath() const;
+    [[nodiscard]] ModelRenderingOption getRenderingOption() const;
 
   private:
     char _filepath[4096] = { 0 };
+    ModelRenderingOption _rendering_option{};
     bool _force_focus = true;
 };
 
@@ -64,7 +64,11 @@ VulkanInstance::init(VkSurfaceKHR windowSurface)
     _setup_vk_debug_msg();
     _select_physical_device();
     _create_present_and_graphic_queue();
-    modelCommandPool = createCommandPool(device, graphicQueueIndex, 0);
+    // Model command buffers are re-recorded every frame
+    modelCommandPool = createCommandPool(
+      device,
+      graphicQueueIndex,
+      VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT);
 }
 
 void
@@ -85,6 +89,10 @@ VulkanInstance::clear()
     graphicQueue = nullptr;
     presentQueue = nullptr;
     modelCommandPool = nullptr;
+    enabledFeatures = {};
+    enabledFeatures12 = {};
+    enabledFeatures11 = {};
+    memoryBudgetEnabled = VK_FALSE;
 }
 
 void
@@ -142,12 +150,37 @@ VulkanInstance::_create_present_and_graphic_queue()
     VkPhysicalDeviceFeatures physical_device_features{};
     physical_device_features.geometryShader = VK_FALSE;
     physical_device_features.samplerAnisotropy = VK_TRUE;
+    physical_device_features.multiDrawIndirect = dfr.multi_draw_indirect;
+    physical_device_features.drawIndirectFirstInstance =
+      dfr.draw_indirect_first_instance;
+    physical_device_features.textureCompressionBC =
+      dfr.texture_compression_bc;
+    physical_device_features.shaderSampledImageArrayDynamicIndexing =
+      dfr.sampled_image_dynamic_indexing;
+    VkPhysicalDeviceVulkan12Features physical_device_features_12{};
+    physical_device_features_12.sType =
+      VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES;
+    physical_device_features_12.runtimeDescriptorArray =
+      dfr.descriptor_indexing;
+    physical_device_features_12.descriptorBindingPartiallyBound =
+      dfr.descriptor_indexing;
+    physical_device_features_12.drawIndirectCount = dfr.draw_indirect_count;
+    VkPhysicalDeviceVulkan11Features physical_device_features_11{};
+    physical_device_features_11.sType =
+      VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_1_FEATURES;
+    physical_device_features_11.shaderDrawParameters =
+      dfr.shader_draw_parameters;
+    std::vector<char const *> device_extensions(DEVICE_EXTENSIONS.begin(),
+                                                DEVICE_EXTENSIONS.end());
+    if (dfr.memory_budget) {
+        device_extensions.push_back(VK_EXT_MEMORY_BUDGET_EXTENSION_NAME);
+    }
     VkDeviceCreateInfo device_create_info{};
     device_create_info.sType = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO;
     device_create_info.pQueueCreateInfos = vec_queue_create_info.data();
     device_create_info.queueCreateInfoCount = vec_queue_create_info.size();
-    device_create_info.ppEnabledExtensionNames = DEVICE_EXTENSIONS.data();
-    device_create_info.enabledExtensionCount = DEVICE_EXTENSIONS.size();
+    device_create_info.ppEnabledExtensionNames = device_extensions.data();
+    device_create_info.enabledExtensionCount = device_extensions.size();
     if constexpr (ENABLE_VALIDATION_LAYER) {
         device_create_info.enabledLayerCount =
           static_cast<uint32_t>(VALIDATION_LAYERS.size());
@@ -156,6 +189,12 @@ VulkanInstance::_create_present_and_graphic_queue()
         device_create_info.enabledLayerCount = 0;
     }
     device_create_info.pEnabledFeatures = &physical_device_features;
+    // Only chained on 1.2 devices
+    if (dfr.descriptor_indexing || dfr.draw_indirect_count ||
+        dfr.shader_draw_parameters) {
+        physical_device_features_12.pNext = &physical_device_features_11;
+        device_create_info.pNext = &physical_device_features_12;
+    }
 
     // Device creation
     if (vkCreateDevice(physicalDevice, &device_create_info, nullptr, &device) !=
@@ -167,6 +206,11 @@ VulkanInstance::_create_present_and_graphic_queue()
     vkGetDeviceQueue(device, dfr.present_queue_index.value(), 0, &presentQueue);
     graphicQueueIndex = dfr.graphic_queue_index.value();
     presentQueueIndex = dfr.present_queue_index.value();
+    enabledFeatures = physical_device_features;
+    enabledFeatures12 = physical_device_features_12;
+    enabledFeatures12.pNext = nullptr;
+    enabledFeatures11 = physical_device_features_11;
+    memoryBudgetEnabled = dfr.memory_budget;
 }
 
 // Dbg related
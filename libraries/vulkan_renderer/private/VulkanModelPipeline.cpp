@@ -1,36 +1,119 @@
 #include "VulkanModelPipeline.hpp"
 
 #include <stdexcept>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <unordered_set>
+#include <unordered_map>
+
+#include "fmt/core.h"
 
 #include "VulkanShader.hpp"
 #include "VulkanMemory.hpp"
 #include "VulkanPhysicalDevice.hpp"
 #include "VulkanCommandBuffer.hpp"
 #include "VulkanUboStructs.hpp"
+#include "PackedVertex.hpp"
+#include "MeshIndexBlock.hpp"
 
 void
 VulkanModelPipeline::init(VulkanInstance const &vkInstance,
                           VulkanSwapChain const &swapChain,
                           Model const &model,
                           VulkanTextureManager &texManager,
+                          VulkanMemoryAllocator &allocator,
+                          VulkanStagingRing &stagingRing,
                           VkBuffer systemUbo,
-                          uint32_t maxModelNb)
+                          uint32_t instanceCapacity,
+                          ModelRenderingOption const &option)
 {
-    _instance_handler.setMaxInstanceNb(maxModelNb);
     _device = vkInstance.device;
     _physical_device = vkInstance.physicalDevice;
+    _allocator = &allocator;
+    _staging_ring = &stagingRing;
     _cmd_pool = vkInstance.modelCommandPool;
     _gfx_queue = vkInstance.graphicQueue;
+    _swap_chain_nb_img = swapChain.currentSwapChainNbImg;
     _model = &model;
-    _pipeline_render_pass.init(vkInstance, swapChain);
+    _upload_batch.init(
+      _physical_device, _device, allocator, _cmd_pool, _gfx_queue);
+    _option = option;
+    if (_option.cluster_culling &&
+        (!vkInstance.enabledFeatures.multiDrawIndirect ||
+         !vkInstance.enabledFeatures.drawIndirectFirstInstance ||
+         !vkInstance.enabledFeatures12.drawIndirectCount ||
+         model.getClusterList().empty())) {
+        fmt::print(stderr,
+                   "VulkanModelPipeline: Cluster culling not available, "
+                   "using regular draws\n");
+        _option.cluster_culling = false;
+    }
+    if (_option.cluster_culling) {
+        _option.lod_selection = false;
+        _cull_max_group_count = getMaxComputeWorkGroupCount(_physical_device);
+    }
+    _load_textures(model, texManager);
+    if (_option.bindless_materials) {
+        _max_bindless_textures =
+          std::min(MODEL_MAX_BINDLESS_TEXTURES,
+                   getMaxSampledImagesPerSet(_physical_device));
+        // Default texture included
+        std::unordered_set<std::string> textures(_texture_names.begin(),
+                                                 _texture_names.end());
+        auto const &features = vkInstance.enabledFeatures;
+        auto const &features_11 = vkInstance.enabledFeatures11;
+        auto const &features_12 = vkInstance.enabledFeatures12;
+        if (!features.shaderSampledImageArrayDynamicIndexing ||
+            !features.multiDrawIndirect ||
+            !features.drawIndirectFirstInstance ||
+            !features_11.shaderDrawParameters ||
+            !features_12.runtimeDescriptorArray ||
+            !features_12.descriptorBindingPartiallyBound ||
+            textures.size() + 1 > _max_bindless_textures) {
+            fmt::print(stderr,
+                       "VulkanModelPipeline: Bindless materials not "
+                       "available, using per material descriptor sets\n");
+            _option.bindless_materials = false;
+            _max_bindless_textures = 0;
+        }
+    }
+    _pipeline_render_pass.init(vkInstance, allocator, swapChain);
     _create_descriptor_layout();
     _create_pipeline_layout();
     _create_gfx_pipeline(swapChain);
-    auto mesh_list = model.getMeshList();
+    if (_option.cluster_culling) {
+        _create_cull_pipeline();
+    }
+    // Also read as a storage buffer by the cull pass and lod draws
+    _instance_capacity = std::max(instanceCapacity, 1u);
+    _instance_buffer.init(_device,
+                          allocator,
+                          _cmd_pool,
+                          _gfx_queue,
+                          sizeof(glm::mat4) * _instance_capacity,
+                          VK_BUFFER_USAGE_VERTEX_BUFFER_BIT |
+                            VK_BUFFER_USAGE_STORAGE_BUFFER_BIT);
+    if (_option.cluster_culling) {
+        _init_cull_draws(model);
+    }
     _pipeline_model = _create_pipeline_model(
       model, model.getDirectory(), texManager, swapChain.currentSwapChainNbImg);
+    // Model buffer can't be drawn before pollUploads returns true
+    _upload_batch.submitAsync();
     _create_descriptor_pool(swapChain, _pipeline_model);
-    _create_descriptor_sets(swapChain, _pipeline_model, systemUbo);
+    if (_option.bindless_materials) {
+        _create_bindless_descriptor_sets(swapChain, _pipeline_model, systemUbo);
+    } else {
+        _create_descriptor_sets(swapChain, _pipeline_model, systemUbo);
+    }
+    if (_option.lod_selection) {
+        _write_instance_descriptors(_pipeline_model);
+    }
+    if (_option.cluster_culling) {
+        _create_cull_descriptor_sets(_pipeline_model,
+                                     swapChain.currentSwapChainNbImg);
+    }
 }
 
 void
@@ -46,21 +129,35 @@ VulkanModelPipeline::resize(VulkanSwapChain const &swapChain,
 
     _create_pipeline_layout();
     _create_gfx_pipeline(swapChain);
+    _swap_chain_nb_img = swapChain.currentSwapChainNbImg;
     vkDestroyBuffer(_device, _pipeline_model.buffer, nullptr);
-    vkFreeMemory(_device, _pipeline_model.memory, nullptr);
+    _allocator->free(_pipeline_model.allocation);
+    _pipeline_model.lodBuffer.clear();
+    _pipeline_model.cullUbo.clear();
+    _pipeline_model.cullMeshDraws.clear();
+    vkDestroyBuffer(_device, _pipeline_model.cullDrawBuffer, nullptr);
+    _allocator->free(_pipeline_model.cullDrawAllocation);
     vkDestroyDescriptorPool(_device, _pipeline_model.descriptorPool, nullptr);
+    vkDestroyDescriptorPool(
+      _device, _pipeline_model.cullDescriptorPool, nullptr);
     _pipeline_model = _create_pipeline_model(*_model,
                                              _model->getDirectory(),
                                              texManager,
                                              swapChain.currentSwapChainNbImg);
+    _upload_batch.submit();
     _create_descriptor_pool(swapChain, _pipeline_model);
-    _create_descriptor_sets(swapChain, _pipeline_model, systemUbo);
-
-    auto updater = [&](uint32_t index,
-                       ModelInstanceInfo const &inst_info) -> void {
-        _set_instance_matrix_on_gpu(index, inst_info);
-    };
-    _instance_handler.executeUpdateFctOnInstances(updater);
+    if (_option.bindless_materials) {
+        _create_bindless_descriptor_sets(swapChain, _pipeline_model, systemUbo);
+    } else {
+        _create_descriptor_sets(swapChain, _pipeline_model, systemUbo);
+    }
+    if (_option.lod_selection) {
+        _write_instance_descriptors(_pipeline_model);
+    }
+    if (_option.cluster_culling) {
+        _create_cull_descriptor_sets(_pipeline_model,
+                                     swapChain.currentSwapChainNbImg);
+    }
 }
 
 void
@@ -68,20 +165,49 @@ VulkanModelPipeline::clear()
 {
     vkDestroyPipeline(_device, _graphic_pipeline, nullptr);
     vkDestroyPipelineLayout(_device, _pipeline_layout, nullptr);
+    vkDestroyPipeline(_device, _cull_pipeline, nullptr);
+    vkDestroyPipelineLayout(_device, _cull_pipeline_layout, nullptr);
+    vkDestroyDescriptorSetLayout(
+      _device, _cull_descriptor_set_layout, nullptr);
     _pipeline_render_pass.clear();
     vkDestroyDescriptorSetLayout(_device, _descriptor_set_layout, nullptr);
+    _upload_batch.clear();
     vkDestroyBuffer(_device, _pipeline_model.buffer, nullptr);
-    vkFreeMemory(_device, _pipeline_model.memory, nullptr);
+    _allocator->free(_pipeline_model.allocation);
+    _pipeline_model.lodBuffer.clear();
+    _pipeline_model.cullUbo.clear();
+    _pipeline_model.cullMeshDraws.clear();
+    vkDestroyBuffer(_device, _pipeline_model.cullDrawBuffer, nullptr);
+    _allocator->free(_pipeline_model.cullDrawAllocation);
     vkDestroyDescriptorPool(_device, _pipeline_model.descriptorPool, nullptr);
+    vkDestroyDescriptorPool(
+      _device, _pipeline_model.cullDescriptorPool, nullptr);
+    _staging_ring->cancelUploads(_instance_buffer.getBuffer());
+    _instance_buffer.clear();
+    _instance_capacity = 0;
+    _cull_mesh_max_draws.clear();
     _instance_handler.clear();
+    _release_textures();
     _model = nullptr;
+    _option = {};
     _device = nullptr;
     _physical_device = nullptr;
+    _allocator = nullptr;
+    _staging_ring = nullptr;
     _cmd_pool = nullptr;
     _gfx_queue = nullptr;
+    _swap_chain_nb_img = 0;
     _descriptor_set_layout = nullptr;
     _pipeline_layout = nullptr;
     _graphic_pipeline = nullptr;
+    _cull_descriptor_set_layout = nullptr;
+    _cull_pipeline_layout = nullptr;
+    _cull_pipeline = nullptr;
+    _cull_draws_limit = 0;
+    _cull_max_group_count = {};
+    _max_bindless_textures = 0;
+    _draw_commands_buffer = nullptr;
+    _draw_commands_offset = 0;
     _pipeline_model.clear();
 }
 
@@ -93,6 +219,7 @@ VulkanModelPipeline::addInstance(ModelInstanceInfo const &info)
         _set_instance_matrix_on_gpu(index, inst_info);
     };
 
+    _reserve_instances(_instance_handler.getCurrentInstanceNb() + 1);
     return (_instance_handler.addInstance(info, updater));
 }
 
@@ -141,43 +268,510 @@ VulkanModelPipeline::isInit() const
     return (false);
 }
 
+bool
+VulkanModelPipeline::pollUploads()
+{
+    return (_upload_batch.poll());
+}
+
+void
+VulkanModelPipeline::addMemoryUsage(VulkanMemoryReport &report) const
+{
+    auto const &data = _pipeline_model;
+    auto buffer_size = [](VulkanMappedBuffer const &buffer) -> VkDeviceSize {
+        return (buffer.getFrameStride() * buffer.getNbFrames());
+    };
+
+    report.categories[VMC_VERTEX] += data.verticesSize;
+    // Clusters are index ranges of meshes
+    report.categories[VMC_INDEX] += data.indicesSize + data.clustersSize;
+    // Lod and cull draw buffers hold per instance matrices and draws
+    report.categories[VMC_INSTANCE] += _instance_buffer.getSize() +
+                                       buffer_size(data.lodBuffer) +
+                                       data.cullDrawAllocation.size +
+                                       buffer_size(data.cullMeshDraws);
+    report.categories[VMC_UBO] +=
+      ((_option.bindless_materials)
+         ? data.materialsSize
+         : data.singleSwapChainUboSize * data.nbMaterials) +
+      buffer_size(data.cullUbo);
+    report.categories[VMC_DEPTH] +=
+      _pipeline_render_pass.depthImgAllocation.size;
+}
+
+std::vector<std::string>
+VulkanModelPipeline::getTexturePaths(Model const &model)
+{
+    std::vector<std::string> texture_paths;
+    for (auto const &it : model.getBatchedMeshList()) {
+        if (!it.material.tex_diffuse_name.empty()) {
+            texture_paths.emplace_back(model.getDirectory() + "/" +
+                                       it.material.tex_diffuse_name);
+        }
+    }
+    return (texture_paths);
+}
+
+VkDeviceSize
+VulkanModelPipeline::estimateBuffersMemory(Model const &model,
+                                           ModelRenderingOption const &option,
+                                           uint32_t instanceCapacity,
+                                           uint32_t currentSwapChainNbImg)
+{
+    VkDeviceSize vertex_size =
+      (option.packed_vertices) ? sizeof(PackedVertex) : sizeof(Vertex);
+    VkDeviceSize size = vertex_size * model.getVertexList().size() +
+                        sizeof(uint32_t) * model.getIndicesList().size() +
+                        sizeof(glm::mat4) * instanceCapacity;
+    // Cull draws are the biggest, initial areas have room for every
+    // cluster of each instance and image
+    if (option.cluster_culling) {
+        auto nb_clusters = model.getClusterList().size();
+        size += sizeof(MeshCluster) * nb_clusters +
+                sizeof(VkDrawIndexedIndirectCommand) * nb_clusters *
+                  instanceCapacity * currentSwapChainNbImg;
+    }
+    return (size);
+}
+
 void
 VulkanModelPipeline::generateCommands(VkCommandBuffer cmdBuffer,
                                       size_t descriptorSetIndex,
-                                      uint32_t currentSwapChainNbImg)
+                                      uint32_t currentSwapChainNbImg,
+                                      uint32_t systemUboOffset)
 {
     // Vertex related values
     VkBuffer vertex_buffer[] = { _pipeline_model.buffer,
-                                 _pipeline_model.buffer };
-    VkDeviceSize offsets[] = { 0, _pipeline_model.instanceMatricesOffset };
+                                 _instance_buffer.getBuffer() };
+    VkDeviceSize offsets[] = { 0, 0 };
 
     vkCmdBindPipeline(
       cmdBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, _graphic_pipeline);
     vkCmdBindVertexBuffers(cmdBuffer, 0, 2, vertex_buffer, offsets);
-    vkCmdBindIndexBuffer(cmdBuffer,
-                         _pipeline_model.buffer,
-                         _pipeline_model.indicesOffset,
-                         VK_INDEX_TYPE_UINT32);
-
-    for (size_t i = 0; i < _pipeline_model.nbMaterials; ++i) {
+    // Single set per swapchain image, materials are picked by index
+    if (_option.bindless_materials) {
         vkCmdBindDescriptorSets(
           cmdBuffer,
           VK_PIPELINE_BIND_POINT_GRAPHICS,
           _pipeline_layout,
           0,
           1,
-          &_pipeline_model
-             .descriptorSets[descriptorSetIndex + i * currentSwapChainNbImg],
-          0,
-          nullptr);
+          &_pipeline_model.descriptorSets[descriptorSetIndex],
+          1,
+          &systemUboOffset);
+    }
+
+    for (auto const &group : _pipeline_model.drawGroups) {
+        vkCmdBindIndexBuffer(cmdBuffer,
+                             _pipeline_model.buffer,
+                             _pipeline_model.indicesOffset,
+                             group.indexType);
+        // Bindless meshes of a group share each indirect call, their
+        // material is picked from the draw index
+        if (_option.bindless_materials && !_option.cluster_culling) {
+            _generate_group_draws(cmdBuffer, descriptorSetIndex, group);
+            continue;
+        }
+
+        auto last_draw = group.firstDraw + group.nbDraws;
+        for (uint32_t p = group.firstDraw; p < last_draw; ++p) {
+            auto i = _pipeline_model.drawMeshes[p];
+            if (_option.bindless_materials) {
+                ModelPipelineDrawOffset draw_offset = { p };
+                vkCmdPushConstants(cmdBuffer,
+                                   _pipeline_layout,
+                                   VK_SHADER_STAGE_VERTEX_BIT,
+                                   0,
+                                   sizeof(ModelPipelineDrawOffset),
+                                   &draw_offset);
+            } else {
+                auto set_index =
+                  descriptorSetIndex + i * currentSwapChainNbImg;
+                vkCmdBindDescriptorSets(
+                  cmdBuffer,
+                  VK_PIPELINE_BIND_POINT_GRAPHICS,
+                  _pipeline_layout,
+                  0,
+                  1,
+                  &_pipeline_model.descriptorSets[set_index],
+                  1,
+                  &systemUboOffset);
+            }
+            if (_option.packed_vertices && !_option.bindless_materials) {
+                auto const &mesh = _model->getBatchedMeshList()[i];
+                ModelPipelineMeshBounds bounds = { mesh.min_point,
+                                                   mesh.max_point -
+                                                     mesh.min_point };
+                vkCmdPushConstants(cmdBuffer,
+                                   _pipeline_layout,
+                                   VK_SHADER_STAGE_VERTEX_BIT,
+                                   0,
+                                   sizeof(ModelPipelineMeshBounds),
+                                   &bounds);
+            }
+
+            if (_option.cluster_culling) {
+                // Visible clusters were appended to the mesh area by the
+                // cull pass, which also wrote the draw count
+                auto const &mesh_draws = _pipeline_model.cullMeshDraws;
+                VkDeviceSize draws_offset =
+                  _pipeline_model.cullDrawSingleSwapChainSize *
+                    descriptorSetIndex +
+                  sizeof(VkDrawIndexedIndirectCommand) *
+                    static_cast<VkDeviceSize>(
+                      _pipeline_model.cullFirstDraws[i]);
+                vkCmdDrawIndexedIndirectCount(
+                  cmdBuffer,
+                  _pipeline_model.cullDrawBuffer,
+                  draws_offset,
+                  mesh_draws.getBuffer(),
+                  mesh_draws.getFrameOffset(descriptorSetIndex) +
+                    sizeof(ModelPipelineCullMeshDraws) * i,
+                  _cull_mesh_max_draws[i],
+                  sizeof(VkDrawIndexedIndirectCommand));
+                continue;
+            }
+
+            if (!_option.lod_selection) {
+                vkCmdDrawIndexed(cmdBuffer,
+                                 _pipeline_model.indicesDrawNb[i],
+                                 _instance_handler.getCurrentInstanceNb(),
+                                 _pipeline_model.indicesDrawOffset[i],
+                                 _pipeline_model.indexBlocks[i].vertex_offset,
+                                 0);
+                continue;
+            }
+
+            // Instance counts and index ranges are written by
+            // updateLodSelection, called right before recording.
+            // Instances of a level start at its offset, empty levels are
+            // skipped.
+            auto lod_buffer = _pipeline_model.lodBuffer.getBuffer();
+            auto image_offset =
+              _pipeline_model.lodBuffer.getFrameOffset(descriptorSetIndex);
+            for (uint32_t j = 0; j < _pipeline_model.nbLodLevels; ++j) {
+                if (!_lod_level_counts[j]) {
+                    continue;
+                }
+                VkDeviceSize level_offset =
+                  image_offset + sizeof(uint32_t) * _lod_level_offsets[j];
+                vkCmdBindVertexBuffers(
+                  cmdBuffer, 1, 1, &lod_buffer, &level_offset);
+                vkCmdDrawIndexedIndirect(
+                  cmdBuffer,
+                  lod_buffer,
+                  image_offset + _pipeline_model.lodIndirectOffset +
+                    sizeof(VkDrawIndexedIndirectCommand) *
+                      (j * _pipeline_model.drawMeshes.size() + p),
+                  1,
+                  sizeof(VkDrawIndexedIndirectCommand));
+            }
+        }
+    }
+}
+
+void
+VulkanModelPipeline::_generate_group_draws(VkCommandBuffer cmd_buffer,
+                                           size_t descriptor_set_index,
+                                           VulkanModelDrawGroup const &group)
+{
+    static constexpr VkDeviceSize const CMD_SIZE =
+      sizeof(VkDrawIndexedIndirectCommand);
+
+    ModelPipelineDrawOffset draw_offset = { group.firstDraw };
+    vkCmdPushConstants(cmd_buffer,
+                       _pipeline_layout,
+                       VK_SHADER_STAGE_VERTEX_BIT,
+                       0,
+                       sizeof(ModelPipelineDrawOffset),
+                       &draw_offset);
+    if (!_option.lod_selection) {
+        vkCmdDrawIndexedIndirect(cmd_buffer,
+                                 _draw_commands_buffer,
+                                 _draw_commands_offset +
+                                   CMD_SIZE * group.firstDraw,
+                                 group.nbDraws,
+                                 CMD_SIZE);
+        return;
+    }
+
+    // Written by updateLodSelection, one call per non empty level
+    auto lod_buffer = _pipeline_model.lodBuffer.getBuffer();
+    auto image_offset =
+      _pipeline_model.lodBuffer.getFrameOffset(descriptor_set_index);
+    vkCmdBindVertexBuffers(cmd_buffer, 1, 1, &lod_buffer, &image_offset);
+    for (uint32_t j = 0; j < _pipeline_model.nbLodLevels; ++j) {
+        if (!_lod_level_counts[j]) {
+            continue;
+        }
+        vkCmdDrawIndexedIndirect(
+          cmd_buffer,
+          lod_buffer,
+          image_offset + _pipeline_model.lodIndirectOffset +
+            CMD_SIZE * (j * _pipeline_model.drawMeshes.size() +
+                        group.firstDraw),
+          group.nbDraws,
+          CMD_SIZE);
+    }
+}
+
+void
+VulkanModelPipeline::updateDrawCommands(VulkanFrameAllocator &frameAllocator)
+{
+    if (!_option.bindless_materials || _option.lod_selection ||
+        _option.cluster_culling) {
+        return;
+    }
+
+    // One command per draw, every live instance
+    _draw_commands.resize(_pipeline_model.drawMeshes.size());
+    for (size_t p = 0; p < _draw_commands.size(); ++p) {
+        auto i = _pipeline_model.drawMeshes[p];
+        auto &cmd = _draw_commands[p];
+
+        cmd.indexCount = _pipeline_model.indicesDrawNb[i];
+        cmd.instanceCount = _instance_handler.getCurrentInstanceNb();
+        cmd.firstIndex = _pipeline_model.indicesDrawOffset[i];
+        cmd.vertexOffset = _pipeline_model.indexBlocks[i].vertex_offset;
+        cmd.firstInstance = 0;
+    }
+    auto allocation = frameAllocator.push(
+      _draw_commands.data(),
+      sizeof(VkDrawIndexedIndirectCommand) * _draw_commands.size(),
+      sizeof(uint32_t));
+    _draw_commands_buffer = allocation.buffer;
+    _draw_commands_offset = allocation.offset;
+}
+
+void
+VulkanModelPipeline::updateLodSelection(uint32_t imgIndex,
+                                        glm::vec3 const &cameraPos,
+                                        float pixelsPerUnit)
+{
+    if (!_option.lod_selection) {
+        return;
+    }
+
+    auto const nb_levels = _pipeline_model.nbLodLevels;
+    _lod_instance_levels.resize(_instance_handler.getCurrentInstanceNb());
+    _lod_level_counts.assign(nb_levels, 0);
+    _lod_level_offsets.assign(nb_levels, 0);
+
+    // Coarsest level whose error stays under the pixel threshold
+    auto selector = [&](uint32_t bufferIndex,
+                        ModelInstanceInfo const &info) -> void {
+        auto scale = std::max({ std::abs(info.scale.x),
+                                std::abs(info.scale.y),
+                                std::abs(info.scale.z) });
+        auto distance = glm::length(info.position - cameraPos) -
+                        _pipeline_model.modelRadius * scale;
+        uint32_t level = 0;
+        if (distance > 0.0f) {
+            for (uint32_t j = nb_levels - 1; j > 0; --j) {
+                if (_pipeline_model.lodErrors[j] * scale * pixelsPerUnit <=
+                    _option.lod_pixel_error * distance) {
+                    level = j;
+                    break;
+                }
+            }
+        }
+        _lod_instance_levels[bufferIndex] = level;
+        ++_lod_level_counts[level];
+    };
+    _instance_handler.executeUpdateFctOnInstances(selector);
+
+    // Levels are packed one after the other, only buffer indices of
+    // live instances are written. Their matrices stay in the instance
+    // buffer.
+    uint32_t nb_instances = 0;
+    for (uint32_t j = 0; j < nb_levels; ++j) {
+        _lod_level_offsets[j] = nb_instances;
+        nb_instances += _lod_level_counts[j];
+    }
+    auto instances = static_cast<uint32_t *>(
+      _pipeline_model.lodBuffer.getFrameData(imgIndex));
+    for (uint32_t i = 0; i < nb_instances; ++i) {
+        instances[_lod_level_offsets[_lod_instance_levels[i]]++] = i;
+    }
+    if (nb_instances) {
+        _pipeline_model.lodBuffer.flush(
+          imgIndex, 0, sizeof(uint32_t) * nb_instances);
+    }
+    // Offsets were moved to the end of their level above
+    for (uint32_t j = 0; j < nb_levels; ++j) {
+        _lod_level_offsets[j] -= _lod_level_counts[j];
+    }
+
+    // Commands of a level follow the draw order. Meshes with less levels
+    // use their coarsest one. Bindless draws of a level share the
+    // instance binding, their instances are found from firstInstance.
+    auto const nb_draws = _pipeline_model.drawMeshes.size();
+    _lod_draw_commands.resize(nb_draws * nb_levels);
+    for (size_t p = 0; p < nb_draws; ++p) {
+        auto i = _pipeline_model.drawMeshes[p];
+        auto const &mesh = _model->getBatchedMeshList()[i];
+        auto const &block = _pipeline_model.indexBlocks[i];
+        for (uint32_t j = 0; j < nb_levels; ++j) {
+            auto &cmd = _lod_draw_commands[j * nb_draws + p];
+            auto level = std::min<size_t>(j, mesh.lods.size());
+
+            cmd.indexCount = (level) ? mesh.lods[level - 1].nb_indices
+                                     : mesh.nb_indices;
+            cmd.instanceCount = _lod_level_counts[j];
+            cmd.firstIndex = _pipeline_model.indicesDrawOffset[i] +
+                             block.levels_offset[level];
+            cmd.vertexOffset = block.vertex_offset;
+            cmd.firstInstance =
+              (_option.bindless_materials) ? _lod_level_offsets[j] : 0;
+        }
+    }
+
+    _pipeline_model.lodBuffer.write(
+      imgIndex,
+      _pipeline_model.lodIndirectOffset,
+      _lod_draw_commands.data(),
+      sizeof(VkDrawIndexedIndirectCommand) * _lod_draw_commands.size());
+}
+
+void
+VulkanModelPipeline::generateCullingCommands(VkCommandBuffer cmdBuffer,
+                                             size_t descriptorSetIndex)
+{
+    if (!_option.cluster_culling) {
+        return;
+    }
 
-        vkCmdDrawIndexed(cmdBuffer,
-                         _pipeline_model.indicesDrawNb[i],
-                         _instance_handler.getCurrentInstanceNb(),
-                         _pipeline_model.indicesDrawOffset[i],
+    vkCmdBindPipeline(
+      cmdBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, _cull_pipeline);
+    vkCmdBindDescriptorSets(
+      cmdBuffer,
+      VK_PIPELINE_BIND_POINT_COMPUTE,
+      _cull_pipeline_layout,
+      0,
+      1,
+      &_pipeline_model.cullDescriptorSets[descriptorSetIndex],
+      0,
+      nullptr);
+
+    // One thread per cluster and live instance. Clusters are spread over
+    // x in groups of MODEL_CULL_WORKGROUP_SIZE, instances over y then z.
+    // Counts past the group count limits take several dispatches.
+    uint64_t const nb_instances = _instance_handler.getCurrentInstanceNb();
+    uint64_t const nb_clusters = _pipeline_model.nbClusters;
+    uint64_t const dispatch_clusters =
+      static_cast<uint64_t>(_cull_max_group_count[0]) *
+      MODEL_CULL_WORKGROUP_SIZE;
+    uint64_t const dispatch_instances =
+      static_cast<uint64_t>(_cull_max_group_count[1]) *
+      _cull_max_group_count[2];
+    for (uint64_t i = 0; i < nb_instances; i += dispatch_instances) {
+        auto chunk_instances = std::min(nb_instances - i, dispatch_instances);
+        auto groups_y = static_cast<uint32_t>(
+          std::min<uint64_t>(chunk_instances, _cull_max_group_count[1]));
+        auto groups_z =
+          static_cast<uint32_t>((chunk_instances + groups_y - 1) / groups_y);
+        for (uint64_t j = 0; j < nb_clusters; j += dispatch_clusters) {
+            ModelPipelineCullDispatch dispatch = {
+                static_cast<uint32_t>(j), static_cast<uint32_t>(i)
+            };
+            vkCmdPushConstants(cmdBuffer,
+                               _cull_pipeline_layout,
+                               VK_SHADER_STAGE_COMPUTE_BIT,
+                               0,
+                               sizeof(ModelPipelineCullDispatch),
+                               &dispatch);
+            auto groups_x = (std::min(nb_clusters - j, dispatch_clusters) +
+                             MODEL_CULL_WORKGROUP_SIZE - 1) /
+                            MODEL_CULL_WORKGROUP_SIZE;
+            vkCmdDispatch(
+              cmdBuffer, static_cast<uint32_t>(groups_x), groups_y, groups_z);
+        }
+    }
+
+    // Draw commands and counts have to be written before being read by
+    // draws, counts are also read back by the host
+    VkMemoryBarrier barrier{};
+    barrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+    barrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+    barrier.dstAccessMask =
+      VK_ACCESS_INDIRECT_COMMAND_READ_BIT | VK_ACCESS_HOST_READ_BIT;
+    vkCmdPipelineBarrier(cmdBuffer,
+                         VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                         VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT |
+                           VK_PIPELINE_STAGE_HOST_BIT,
+                         0,
+                         1,
+                         &barrier,
                          0,
-                         0);
+                         nullptr,
+                         0,
+                         nullptr);
+}
+
+void
+VulkanModelPipeline::updateClusterCulling(uint32_t imgIndex,
+                                          glm::mat4 const &viewProj,
+                                          glm::vec3 const &cameraPos)
+{
+    if (!_option.cluster_culling) {
+        return;
+    }
+
+    // Planes from view_proj rows. Near plane assumes a [-w, w] depth
+    // range, it stays conservative with a [0, w] one.
+    ModelPipelineCullUbo ubo{};
+    glm::vec4 w_row(
+      viewProj[0][3], viewProj[1][3], viewProj[2][3], viewProj[3][3]);
+    for (uint32_t i = 0; i < 3; ++i) {
+        glm::vec4 row(
+          viewProj[0][i], viewProj[1][i], viewProj[2][i], viewProj[3][i]);
+        ubo.frustum_planes[i * 2] = w_row + row;
+        ubo.frustum_planes[i * 2 + 1] = w_row - row;
+    }
+    for (auto &it : ubo.frustum_planes) {
+        it /= glm::length(glm::vec3(it));
+    }
+    ubo.camera_pos = cameraPos;
+    ubo.nb_clusters = _pipeline_model.nbClusters;
+    ubo.nb_instances = _instance_handler.getCurrentInstanceNb();
+    ubo.backface_culling = _option.cluster_backface_culling;
+
+    _pipeline_model.cullUbo.write(
+      imgIndex, 0, &ubo, sizeof(ModelPipelineCullUbo));
+
+    // Counts of the previous use of this image are read before being
+    // reset, the image is done executing
+    _grow_cull_draws(imgIndex);
+    auto &mesh_draws_buffer = _pipeline_model.cullMeshDraws;
+    auto mesh_draws = static_cast<ModelPipelineCullMeshDraws *>(
+      mesh_draws_buffer.getFrameData(imgIndex));
+    for (size_t i = 0; i < _cull_mesh_max_draws.size(); ++i) {
+        mesh_draws[i] = { 0,
+                          0,
+                          _pipeline_model.cullFirstDraws[i],
+                          _cull_mesh_max_draws[i] };
+    }
+    mesh_draws_buffer.flush(imgIndex,
+                            0,
+                            sizeof(ModelPipelineCullMeshDraws) *
+                              _cull_mesh_max_draws.size());
+}
+
+bool
+VulkanModelPipeline::updateTextureDescriptors(uint32_t imgIndex)
+{
+    auto version = _tex_manager->getStreamingVersion();
+    if (_pipeline_model.texturesStreamingVersion[imgIndex] == version) {
+        return (false);
     }
+
+    for (size_t i = 0; i < _pipeline_model.diffuseTextures.size(); ++i) {
+        _tex_manager->getTexture(_pipeline_model.diffuseTextureNames[i],
+                                 _pipeline_model.diffuseTextures[i]);
+    }
+    _write_texture_descriptors(_pipeline_model, imgIndex);
+    _pipeline_model.texturesStreamingVersion[imgIndex] = version;
+    return (true);
 }
 
 void
@@ -186,34 +780,66 @@ VulkanModelPipeline::_create_descriptor_layout()
     VkDescriptorSetLayoutBinding system_ubo_layout_binding{};
     system_ubo_layout_binding.binding = 0;
     system_ubo_layout_binding.descriptorType =
-      VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+      VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC;
     system_ubo_layout_binding.descriptorCount = 1;
     system_ubo_layout_binding.stageFlags = VK_SHADER_STAGE_VERTEX_BIT;
     system_ubo_layout_binding.pImmutableSamplers = nullptr;
 
+    // Bindless materials are stored in a storage buffer
     VkDescriptorSetLayoutBinding model_ubo_layout_binding{};
     model_ubo_layout_binding.binding = 1;
-    model_ubo_layout_binding.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+    model_ubo_layout_binding.descriptorType =
+      (_option.bindless_materials) ? VK_DESCRIPTOR_TYPE_STORAGE_BUFFER
+                                   : VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
     model_ubo_layout_binding.descriptorCount = 1;
-    model_ubo_layout_binding.stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT;
+    // Packed bindless vertex shader reads mesh bounds from it
+    model_ubo_layout_binding.stageFlags =
+      (_option.bindless_materials)
+        ? VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT
+        : VK_SHADER_STAGE_FRAGMENT_BIT;
     model_ubo_layout_binding.pImmutableSamplers = nullptr;
 
     VkDescriptorSetLayoutBinding sampler_layout_binding{};
     sampler_layout_binding.binding = 2;
     sampler_layout_binding.descriptorType =
       VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
-    sampler_layout_binding.descriptorCount = 1;
+    sampler_layout_binding.descriptorCount =
+      (_option.bindless_materials) ? _max_bindless_textures : 1;
     sampler_layout_binding.stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT;
     sampler_layout_binding.pImmutableSamplers = nullptr;
 
-    std::array bindings{ system_ubo_layout_binding,
-                         model_ubo_layout_binding,
-                         sampler_layout_binding };
+    // Lod vertex shaders read matrices of the instances they are given
+    // the buffer index of
+    VkDescriptorSetLayoutBinding instance_layout_binding{};
+    instance_layout_binding.binding = 3;
+    instance_layout_binding.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+    instance_layout_binding.descriptorCount = 1;
+    instance_layout_binding.stageFlags = VK_SHADER_STAGE_VERTEX_BIT;
+    instance_layout_binding.pImmutableSamplers = nullptr;
+
+    std::vector bindings{ system_ubo_layout_binding,
+                          model_ubo_layout_binding,
+                          sampler_layout_binding };
+    if (_option.lod_selection) {
+        bindings.emplace_back(instance_layout_binding);
+    }
+
+    // Texture array entries past the model textures are never written
+    std::vector<VkDescriptorBindingFlags> binding_flags(bindings.size(), 0);
+    binding_flags[2] = VK_DESCRIPTOR_BINDING_PARTIALLY_BOUND_BIT;
+    VkDescriptorSetLayoutBindingFlagsCreateInfo binding_flags_info{};
+    binding_flags_info.sType =
+      VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_BINDING_FLAGS_CREATE_INFO;
+    binding_flags_info.bindingCount = binding_flags.size();
+    binding_flags_info.pBindingFlags = binding_flags.data();
 
     VkDescriptorSetLayoutCreateInfo layout_info{};
     layout_info.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
     layout_info.bindingCount = bindings.size();
     layout_info.pBindings = bindings.data();
+    if (_option.bindless_materials) {
+        layout_info.pNext = &binding_flags_info;
+    }
 
     if (vkCreateDescriptorSetLayout(
           _device, &layout_info, nullptr, &_descriptor_set_layout) !=
@@ -226,12 +852,21 @@ VulkanModelPipeline::_create_descriptor_layout()
 void
 VulkanModelPipeline::_create_pipeline_layout()
 {
+    // Draw offset of bindless vertex shaders, mesh bounds of the packed
+    // one otherwise
+    VkPushConstantRange push_constant_range{};
+    push_constant_range.stageFlags = VK_SHADER_STAGE_VERTEX_BIT;
+    push_constant_range.offset = 0;
+    push_constant_range.size = (_option.bindless_materials)
+                                 ? sizeof(ModelPipelineDrawOffset)
+                                 : sizeof(ModelPipelineMeshBounds);
+
     VkPipelineLayoutCreateInfo pipeline_layout_info{};
     pipeline_layout_info.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
     pipeline_layout_info.setLayoutCount = 1;
     pipeline_layout_info.pSetLayouts = &_descriptor_set_layout;
-    pipeline_layout_info.pushConstantRangeCount = 0;
-    pipeline_layout_info.pPushConstantRanges = nullptr;
+    pipeline_layout_info.pushConstantRangeCount = 1;
+    pipeline_layout_info.pPushConstantRanges = &push_constant_range;
     if (vkCreatePipelineLayout(
           _device, &pipeline_layout_info, nullptr, &_pipeline_layout) !=
         VK_SUCCESS) {
@@ -244,10 +879,22 @@ void
 VulkanModelPipeline::_create_gfx_pipeline(VulkanSwapChain const &swapChain)
 {
     // Shaders
-    auto vert_shader =
-      loadShader(_device, "resources/shaders/model/model.vert.spv");
-    auto frag_shader =
-      loadShader(_device, "resources/shaders/model/model.frag.spv");
+    std::string vert_shader_path = "resources/shaders/model/model";
+    if (_option.packed_vertices) {
+        vert_shader_path += "_packed";
+    }
+    if (_option.bindless_materials) {
+        vert_shader_path += "_bindless";
+    }
+    if (_option.lod_selection) {
+        vert_shader_path += "_lod";
+    }
+    auto vert_shader = loadShader(_device, vert_shader_path + ".vert.spv");
+    auto frag_shader = loadShader(
+      _device,
+      (_option.bindless_materials)
+        ? "resources/shaders/model/model_bindless.frag.spv"
+        : "resources/shaders/model/model.frag.spv");
 
     VkPipelineShaderStageCreateInfo vert_shader_info{};
     vert_shader_info.sType =
@@ -255,6 +902,21 @@ VulkanModelPipeline::_create_gfx_pipeline(VulkanSwapChain const &swapChain)
     vert_shader_info.stage = VK_SHADER_STAGE_VERTEX_BIT;
     vert_shader_info.module = vert_shader;
     vert_shader_info.pName = "main";
+    // Culled draws of a mesh are in their own call, PER_DRAW_MATERIAL of
+    // bindless vertex shaders
+    VkBool32 per_draw_material = !_option.cluster_culling;
+    VkSpecializationMapEntry spec_entry{};
+    spec_entry.constantID = 0;
+    spec_entry.offset = 0;
+    spec_entry.size = sizeof(VkBool32);
+    VkSpecializationInfo spec_info{};
+    spec_info.mapEntryCount = 1;
+    spec_info.pMapEntries = &spec_entry;
+    spec_info.dataSize = sizeof(VkBool32);
+    spec_info.pData = &per_draw_material;
+    if (_option.bindless_materials) {
+        vert_shader_info.pSpecializationInfo = &spec_info;
+    }
 
     VkPipelineShaderStageCreateInfo frag_shader_info{};
     frag_shader_info.sType =
@@ -269,9 +931,28 @@ VulkanModelPipeline::_create_gfx_pipeline(VulkanSwapChain const &swapChain)
     // Vertex input
     VkPipelineVertexInputStateCreateInfo vertex_input_info{};
     auto binding_description =
-      VulkanModelPipelineData::getInputBindingDescription();
-    auto attribute_description =
-      VulkanModelPipelineData::getInputAttributeDescription();
+      (_option.packed_vertices)
+        ? VulkanModelPipelineData::getPackedInputBindingDescription()
+        : VulkanModelPipelineData::getInputBindingDescription();
+    std::vector<VkVertexInputAttributeDescription> attribute_description;
+    if (_option.packed_vertices) {
+        auto packed_description =
+          VulkanModelPipelineData::getPackedInputAttributeDescription();
+        attribute_description.assign(packed_description.begin(),
+                                     packed_description.end());
+    } else {
+        auto full_description =
+          VulkanModelPipelineData::getInputAttributeDescription();
+        attribute_description.assign(full_description.begin(),
+                                     full_description.end());
+    }
+    // Lod draws are given a buffer index per instance instead of the
+    // 4 columns of its matrix
+    if (_option.lod_selection) {
+        binding_description[1].stride = sizeof(uint32_t);
+        attribute_description.resize(attribute_description.size() - 3);
+        attribute_description.back().format = VK_FORMAT_R32_UINT;
+    }
     vertex_input_info.sType =
       VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
     vertex_input_info.vertexBindingDescriptionCount =
@@ -407,6 +1088,99 @@ VulkanModelPipeline::_create_gfx_pipeline(VulkanSwapChain const &swapChain)
     vkDestroyShaderModule(_device, frag_shader, nullptr);
 }
 
+void
+VulkanModelPipeline::_create_cull_pipeline()
+{
+    // Cull ubo, clusters, instance matrices, draw commands then mesh
+    // draw counts
+    std::array<VkDescriptorSetLayoutBinding, 5> bindings{};
+    for (uint32_t i = 0; i < bindings.size(); ++i) {
+        bindings[i].binding = i;
+        bindings[i].descriptorType = (i) ? VK_DESCRIPTOR_TYPE_STORAGE_BUFFER
+                                         : VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+        bindings[i].descriptorCount = 1;
+        bindings[i].stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+        bindings[i].pImmutableSamplers = nullptr;
+    }
+
+    VkDescriptorSetLayoutCreateInfo layout_info{};
+    layout_info.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+    layout_info.bindingCount = bindings.size();
+    layout_info.pBindings = bindings.data();
+    if (vkCreateDescriptorSetLayout(
+          _device, &layout_info, nullptr, &_cull_descriptor_set_layout) !=
+        VK_SUCCESS) {
+        throw std::runtime_error(
+          "VulkanModelPipeline: failed to create cull descriptor set layout");
+    }
+
+    // First instance of the dispatch
+    VkPushConstantRange push_constant_range{};
+    push_constant_range.stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+    push_constant_range.offset = 0;
+    push_constant_range.size = sizeof(ModelPipelineCullDispatch);
+
+    VkPipelineLayoutCreateInfo pipeline_layout_info{};
+    pipeline_layout_info.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+    pipeline_layout_info.setLayoutCount = 1;
+    pipeline_layout_info.pSetLayouts = &_cull_descriptor_set_layout;
+    pipeline_layout_info.pushConstantRangeCount = 1;
+    pipeline_layout_info.pPushConstantRanges = &push_constant_range;
+    if (vkCreatePipelineLayout(
+          _device, &pipeline_layout_info, nullptr, &_cull_pipeline_layout) !=
+        VK_SUCCESS) {
+        throw std::runtime_error(
+          "VulkanModelPipeline: Failed to create cull pipeline layout");
+    }
+
+    auto comp_shader =
+      loadShader(_device, "resources/shaders/model/model_cull.comp.spv");
+    VkComputePipelineCreateInfo cull_pipeline_info{};
+    cull_pipeline_info.sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO;
+    cull_pipeline_info.stage.sType =
+      VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+    cull_pipeline_info.stage.stage = VK_SHADER_STAGE_COMPUTE_BIT;
+    cull_pipeline_info.stage.module = comp_shader;
+    cull_pipeline_info.stage.pName = "main";
+    cull_pipeline_info.layout = _cull_pipeline_layout;
+    cull_pipeline_info.basePipelineHandle = VK_NULL_HANDLE;
+    cull_pipeline_info.basePipelineIndex = -1;
+    if (vkCreateComputePipelines(_device,
+                                 VK_NULL_HANDLE,
+                                 1,
+                                 &cull_pipeline_info,
+                                 nullptr,
+                                 &_cull_pipeline) != VK_SUCCESS) {
+        throw std::runtime_error(
+          "VulkanModelPipeline: Failed to create cull pipeline");
+    }
+
+    vkDestroyShaderModule(_device, comp_shader, nullptr);
+}
+
+void
+VulkanModelPipeline::_load_textures(Model const &model,
+                                    VulkanTextureManager &textureManager)
+{
+    auto texture_paths = getTexturePaths(model);
+    // Decoding all textures of the model at once
+    textureManager.loadTextures(texture_paths);
+    _tex_manager = &textureManager;
+    _texture_names = std::move(texture_paths);
+}
+
+void
+VulkanModelPipeline::_release_textures()
+{
+    if (_tex_manager) {
+        for (auto const &it : _texture_names) {
+            _tex_manager->releaseTexture(it);
+        }
+    }
+    _tex_manager = nullptr;
+    _texture_names.clear();
+}
+
 VulkanModelPipelineData
 VulkanModelPipeline::_create_pipeline_model(
   Model const &model,
@@ -419,141 +1193,471 @@ VulkanModelPipeline::_create_pipeline_model(
     pipeline_model.modelCenter = model.getCenter();
 
     // Material + Texture related
-    pipeline_model.nbMaterials = model.getMeshList().size();
-    for (auto &it : model.getMeshList()) {
+    pipeline_model.nbMaterials = model.getBatchedMeshList().size();
+    std::unordered_map<std::string, uint32_t> texture_indices;
+    for (auto &it : model.getBatchedMeshList()) {
         pipeline_model.indicesDrawNb.emplace_back(it.nb_indices);
-        pipeline_model.indicesDrawOffset.emplace_back(it.indices_offset);
-        if (!it.material.tex_diffuse_name.empty()) {
-            pipeline_model.diffuseTextures.emplace_back(
-              textureManager.loadAndGetTexture(modelFolder + "/" +
-                                               it.material.tex_diffuse_name));
-        } else {
-            Texture def_tex{};
-            if (textureManager.getTexture(SCOP_DEFAULT_TEXTURE, def_tex)) {
-                throw std::runtime_error(
-                  "VulkanModelPipeline: Default texture not loaded");
+        // Textures are referenced by _load_textures
+        auto tex_name = (it.material.tex_diffuse_name.empty())
+                          ? std::string(SCOP_DEFAULT_TEXTURE)
+                          : modelFolder + "/" + it.material.tex_diffuse_name;
+        auto tex_index = texture_indices.find(tex_name);
+        if (tex_index != texture_indices.end()) {
+            pipeline_model.diffuseTextureIndices.emplace_back(
+              tex_index->second);
+            continue;
+        }
+
+        Texture tex{};
+        if (textureManager.getTexture(tex_name, tex)) {
+            throw std::runtime_error(
+              "VulkanModelPipeline: Texture not loaded: " + tex_name);
+        }
+        auto new_index =
+          static_cast<uint32_t>(pipeline_model.diffuseTextures.size());
+        texture_indices.emplace(tex_name, new_index);
+        pipeline_model.diffuseTextureIndices.emplace_back(new_index);
+        pipeline_model.diffuseTextures.emplace_back(tex);
+        pipeline_model.diffuseTextureNames.emplace_back(tex_name);
+    }
+
+    // Packed format duplicates vertices shared across meshes
+    std::vector<PackedVertex> packed_vertex_list;
+    std::vector<uint32_t> packed_indices_list;
+    if (_option.packed_vertices) {
+        packModelVertices(model.getVertexList(),
+                          model.getIndicesList(),
+                          model.getBatchedMeshList(),
+                          packed_vertex_list,
+                          packed_indices_list);
+    }
+    void const *vertices_data = (_option.packed_vertices)
+                                  ? static_cast<void const *>(
+                                      packed_vertex_list.data())
+                                  : model.getVertexList().data();
+    // 16 bits indices for meshes with less than 65536 vertices
+    std::vector<uint8_t> index_data;
+    buildMeshIndexBlocks((_option.packed_vertices)
+                           ? std::span<uint32_t const>(packed_indices_list)
+                           : model.getIndicesList(),
+                         model.getBatchedMeshList(),
+                         pipeline_model.indexBlocks,
+                         index_data);
+    // Full detail range starts its mesh index block
+    for (auto const &it : pipeline_model.indexBlocks) {
+        pipeline_model.indicesDrawOffset.emplace_back(it.offset /
+                                                      it.index_size);
+    }
+    // 16 bits meshes are drawn first, draws of a group share the index
+    // buffer binding
+    for (auto index_size : { sizeof(uint16_t), sizeof(uint32_t) }) {
+        VulkanModelDrawGroup group{};
+        group.indexType = (index_size == sizeof(uint16_t))
+                            ? VK_INDEX_TYPE_UINT16
+                            : VK_INDEX_TYPE_UINT32;
+        group.firstDraw = pipeline_model.drawMeshes.size();
+        for (size_t i = 0; i < pipeline_model.indexBlocks.size(); ++i) {
+            if (pipeline_model.indexBlocks[i].index_size == index_size) {
+                pipeline_model.drawMeshes.emplace_back(i);
             }
-            pipeline_model.diffuseTextures.emplace_back(def_tex);
+        }
+        group.nbDraws = pipeline_model.drawMeshes.size() - group.firstDraw;
+        if (group.nbDraws) {
+            pipeline_model.drawGroups.emplace_back(group);
         }
     }
 
     // Computing sizes and offsets
-    pipeline_model.verticesSize = sizeof(Vertex) * model.getVertexList().size();
-    pipeline_model.indicesSize =
-      sizeof(uint32_t) * model.getIndicesList().size();
-    VkDeviceSize instance_matrices_size =
-      sizeof(glm::mat4) * _instance_handler.getMaxInstanceNb();
-    pipeline_model.instanceMatricesOffset = pipeline_model.verticesSize;
-    pipeline_model.indicesOffset =
-      pipeline_model.verticesSize + instance_matrices_size;
-    pipeline_model.uboOffset = pipeline_model.verticesSize +
-                               instance_matrices_size +
-                               pipeline_model.indicesSize;
-    // UBO offset are required to be aligned with
-    // minUniformBufferOffsetAlignment prop
-    auto ubo_alignment = getMinUniformBufferOffsetAlignment(_physical_device);
-    pipeline_model.singleUboSize =
-      (sizeof(ModelPipelineUbo) > ubo_alignment)
-        ? sizeof(ModelPipelineUbo) + sizeof(ModelPipelineUbo) % ubo_alignment
-        : ubo_alignment;
-    pipeline_model.singleSwapChainUboSize =
-      pipeline_model.singleUboSize * currentSwapChainNbImg;
-    pipeline_model.uboOffset +=
-      ubo_alignment - (pipeline_model.uboOffset % ubo_alignment);
-    VkDeviceSize total_size =
-      pipeline_model.uboOffset +
-      pipeline_model.singleSwapChainUboSize * pipeline_model.nbMaterials;
-
-    // Creating transfer buffer CPU to GPU
-    VkBuffer staging_buffer{};
-    VkDeviceMemory staging_buffer_memory{};
-    createBuffer(
-      _device, staging_buffer, total_size, VK_BUFFER_USAGE_TRANSFER_SRC_BIT);
-    allocateBuffer(_physical_device,
-                   _device,
-                   staging_buffer,
-                   staging_buffer_memory,
-                   VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT |
-                     VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
-
-    // Copying data into staging buffer
-    copyOnCpuCoherentMemory(_device,
-                            staging_buffer_memory,
-                            0,
-                            pipeline_model.verticesSize,
-                            model.getVertexList().data());
-    copyOnCpuCoherentMemory(_device,
-                            staging_buffer_memory,
-                            pipeline_model.indicesOffset,
-                            pipeline_model.indicesSize,
-                            model.getIndicesList().data());
-    for (size_t j = 0; j < pipeline_model.nbMaterials; ++j) {
-        // Ubo values
-        ModelPipelineUbo m_ubo = { model.getMeshList()[j].material.diffuse,
-                                   model.getMeshList()[j].material.specular,
-                                   model.getMeshList()[j].material.shininess };
-
-        for (size_t i = 0; i < currentSwapChainNbImg; ++i) {
-            copyOnCpuCoherentMemory(_device,
-                                    staging_buffer_memory,
-                                    pipeline_model.uboOffset +
-                                      pipeline_model.singleUboSize * i +
-                                      pipeline_model.singleSwapChainUboSize * j,
-                                    sizeof(ModelPipelineUbo),
-                                    &m_ubo);
-        }
+    pipeline_model.verticesSize =
+      (_option.packed_vertices)
+        ? sizeof(PackedVertex) * packed_vertex_list.size()
+        : sizeof(Vertex) * model.getVertexList().size();
+    pipeline_model.indicesSize = index_data.size();
+    // Clusters are also bound as storage buffers
+    auto storage_alignment =
+      getMinStorageBufferOffsetAlignment(_physical_device);
+    auto storage_align = [&](VkDeviceSize offset) -> VkDeviceSize {
+        return ((offset + storage_alignment - 1) / storage_alignment *
+                storage_alignment);
+    };
+    if (_option.cluster_culling) {
+        pipeline_model.nbClusters = model.getClusterList().size();
+        pipeline_model.clustersSize =
+          sizeof(MeshCluster) * pipeline_model.nbClusters;
+    }
+    pipeline_model.indicesOffset = storage_align(pipeline_model.verticesSize);
+    pipeline_model.clustersOffset =
+      storage_align(pipeline_model.indicesOffset + pipeline_model.indicesSize);
+    VkDeviceSize total_size{};
+    if (_option.bindless_materials) {
+        // Materials never change, shared by every swapchain image
+        pipeline_model.materialsOffset = storage_align(
+          pipeline_model.clustersOffset + pipeline_model.clustersSize);
+        pipeline_model.materialsSize =
+          sizeof(ModelPipelineMaterial) * pipeline_model.nbMaterials;
+        total_size =
+          pipeline_model.materialsOffset + pipeline_model.materialsSize;
+    } else {
+        pipeline_model.uboOffset =
+          pipeline_model.clustersOffset + pipeline_model.clustersSize;
+        // UBO offset are required to be aligned with
+        // minUniformBufferOffsetAlignment prop
+        auto ubo_alignment =
+          getMinUniformBufferOffsetAlignment(_physical_device);
+        pipeline_model.singleUboSize =
+          (sizeof(ModelPipelineUbo) > ubo_alignment)
+            ? sizeof(ModelPipelineUbo) +
+                sizeof(ModelPipelineUbo) % ubo_alignment
+            : ubo_alignment;
+        pipeline_model.singleSwapChainUboSize =
+          pipeline_model.singleUboSize * currentSwapChainNbImg;
+        pipeline_model.uboOffset +=
+          ubo_alignment - (pipeline_model.uboOffset % ubo_alignment);
+        total_size =
+          pipeline_model.uboOffset +
+          pipeline_model.singleSwapChainUboSize * pipeline_model.nbMaterials;
     }
 
-    // Creating GPU buffer + copying transfer buffer
+    // Creating GPU buffer, data is copied by the upload batch
     createBuffer(
       _device,
       pipeline_model.buffer,
       total_size,
       VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_VERTEX_BUFFER_BIT |
-        VK_BUFFER_USAGE_INDEX_BUFFER_BIT | VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT);
-    allocateBuffer(_physical_device,
-                   _device,
-                   pipeline_model.buffer,
-                   pipeline_model.memory,
-                   VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
-    copyBufferOnGpu(_device,
-                    _cmd_pool,
-                    _gfx_queue,
-                    pipeline_model.buffer,
-                    staging_buffer,
-                    total_size);
-
-    vkDestroyBuffer(_device, staging_buffer, nullptr);
-    vkFreeMemory(_device, staging_buffer_memory, nullptr);
+        VK_BUFFER_USAGE_INDEX_BUFFER_BIT | VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT |
+        VK_BUFFER_USAGE_STORAGE_BUFFER_BIT);
+    pipeline_model.allocation = _allocator->allocateBuffer(
+      pipeline_model.buffer, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+    _upload_batch.uploadBuffer(
+      pipeline_model.buffer, 0, vertices_data, pipeline_model.verticesSize);
+    _upload_batch.uploadBuffer(pipeline_model.buffer,
+                               pipeline_model.indicesOffset,
+                               index_data.data(),
+                               pipeline_model.indicesSize);
+    if (pipeline_model.nbClusters) {
+        // Draws use the index block of their batch and are appended to
+        // its draw area
+        std::vector<MeshCluster> clusters(model.getClusterList().begin(),
+                                          model.getClusterList().end());
+        for (size_t i = 0; i < model.getBatchedMeshList().size(); ++i) {
+            auto const &mesh = model.getBatchedMeshList()[i];
+            auto const &block = pipeline_model.indexBlocks[i];
+            for (uint32_t j = 0; j < mesh.nb_clusters; ++j) {
+                auto &cluster = clusters[mesh.clusters_offset + j];
+                cluster.indices_offset -= mesh.indices_offset;
+                cluster.indices_offset += pipeline_model.indicesDrawOffset[i];
+                cluster.vertex_offset = block.vertex_offset;
+                cluster.mesh_index = i;
+            }
+        }
+        _upload_batch.uploadBuffer(pipeline_model.buffer,
+                                   pipeline_model.clustersOffset,
+                                   clusters.data(),
+                                   pipeline_model.clustersSize);
+    }
+    if (_option.bindless_materials) {
+        std::vector<ModelPipelineMaterial> materials(
+          pipeline_model.nbMaterials);
+        for (size_t j = 0; j < pipeline_model.nbMaterials; ++j) {
+            auto mesh_index = pipeline_model.drawMeshes[j];
+            auto const &mesh = model.getBatchedMeshList()[mesh_index];
+            materials[j].diffuse_color = mesh.material.diffuse;
+            materials[j].texture_index =
+              pipeline_model.diffuseTextureIndices[mesh_index];
+            materials[j].min_point = mesh.min_point;
+            materials[j].extent = mesh.max_point - mesh.min_point;
+        }
+        _upload_batch.uploadBuffer(pipeline_model.buffer,
+                                   pipeline_model.materialsOffset,
+                                   materials.data(),
+                                   pipeline_model.materialsSize);
+    } else {
+        // Ubos of every material and swapchain image in a single upload
+        std::vector<uint8_t> ubo_data(pipeline_model.singleSwapChainUboSize *
+                                      pipeline_model.nbMaterials);
+        for (size_t j = 0; j < pipeline_model.nbMaterials; ++j) {
+            // Ubo values
+            auto const &material = model.getBatchedMeshList()[j].material;
+            ModelPipelineUbo m_ubo = { material.diffuse,
+                                       material.specular,
+                                       material.shininess };
+
+            for (size_t i = 0; i < currentSwapChainNbImg; ++i) {
+                std::memcpy(ubo_data.data() + pipeline_model.singleUboSize * i +
+                              pipeline_model.singleSwapChainUboSize * j,
+                            &m_ubo,
+                            sizeof(ModelPipelineUbo));
+            }
+        }
+        _upload_batch.uploadBuffer(pipeline_model.buffer,
+                                   pipeline_model.uboOffset,
+                                   ubo_data.data(),
+                                   ubo_data.size());
+    }
+
+    if (_option.lod_selection) {
+        _create_lod_buffer(model, pipeline_model, currentSwapChainNbImg);
+    }
+    if (_option.cluster_culling) {
+        _create_cull_buffers(pipeline_model, currentSwapChainNbImg);
+    }
 
     return (pipeline_model);
 }
 
+void
+VulkanModelPipeline::_create_lod_buffer(
+  Model const &model,
+  VulkanModelPipelineData &pipelineData,
+  uint32_t currentSwapChainNbImg)
+{
+    // Model wide level errors, meshes with less levels keep their
+    // coarsest one and its error
+    size_t nb_levels = 1;
+    for (auto const &it : model.getBatchedMeshList()) {
+        nb_levels = std::max(nb_levels, it.lods.size() + 1);
+    }
+    pipelineData.nbLodLevels = nb_levels;
+    pipelineData.lodErrors.assign(nb_levels, 0.0f);
+    for (auto const &it : model.getBatchedMeshList()) {
+        for (size_t i = 1; i < nb_levels; ++i) {
+            if (it.lods.empty()) {
+                break;
+            }
+            auto level = std::min(i, it.lods.size());
+            pipelineData.lodErrors[i] =
+              std::max(pipelineData.lodErrors[i], it.lods[level - 1].error);
+        }
+        pipelineData.modelRadius =
+          std::max(pipelineData.modelRadius,
+                   std::max(glm::length(it.min_point - model.getCenter()),
+                            glm::length(it.max_point - model.getCenter())));
+    }
+
+    // Per swapchain image: buffer index of every instance, grouped by
+    // level, then indirect commands
+    pipelineData.lodInstancesSize = sizeof(uint32_t) * _instance_capacity;
+    pipelineData.lodIndirectOffset = pipelineData.lodInstancesSize;
+    pipelineData.lodBuffer.init(
+      _device,
+      *_allocator,
+      pipelineData.lodIndirectOffset + sizeof(VkDrawIndexedIndirectCommand) *
+                                         nb_levels *
+                                         model.getBatchedMeshList().size(),
+      currentSwapChainNbImg,
+      VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT,
+      sizeof(uint32_t));
+}
+
+void
+VulkanModelPipeline::_init_cull_draws(Model const &model)
+{
+    // Room for every cluster of the initial instances, areas are grown
+    // when the cull pass reports more visible clusters
+    _cull_draws_limit =
+      std::min<VkDeviceSize>(getMaxDrawIndirectCount(_physical_device),
+                             getMaxStorageBufferRange(_physical_device) /
+                               sizeof(VkDrawIndexedIndirectCommand));
+    _cull_mesh_max_draws.clear();
+    VkDeviceSize nb_draws = 0;
+    for (auto const &it : model.getBatchedMeshList()) {
+        auto max_draws =
+          std::min<VkDeviceSize>(static_cast<VkDeviceSize>(it.nb_clusters) *
+                                   _instance_capacity,
+                                 _cull_draws_limit - nb_draws);
+        _cull_mesh_max_draws.emplace_back(max_draws);
+        nb_draws += max_draws;
+    }
+}
+
+void
+VulkanModelPipeline::_create_cull_buffers(
+  VulkanModelPipelineData &pipelineData,
+  uint32_t currentSwapChainNbImg)
+{
+    auto ubo_alignment = getMinUniformBufferOffsetAlignment(_physical_device);
+    auto storage_alignment =
+      getMinStorageBufferOffsetAlignment(_physical_device);
+
+    // Cull ubo, updated every frame
+    pipelineData.cullUbo.init(_device,
+                              *_allocator,
+                              sizeof(ModelPipelineCullUbo),
+                              currentSwapChainNbImg,
+                              VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT,
+                              ubo_alignment);
+
+    // Draw counts of each mesh, read back before being reset
+    VkDeviceSize mesh_draws_size =
+      sizeof(ModelPipelineCullMeshDraws) * _cull_mesh_max_draws.size();
+    pipelineData.cullMeshDraws.init(_device,
+                                    *_allocator,
+                                    mesh_draws_size,
+                                    currentSwapChainNbImg,
+                                    VK_BUFFER_USAGE_STORAGE_BUFFER_BIT |
+                                      VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT,
+                                    storage_alignment);
+    std::vector<ModelPipelineCullMeshDraws> mesh_draws(
+      _cull_mesh_max_draws.size());
+    for (uint32_t i = 0; i < currentSwapChainNbImg; ++i) {
+        pipelineData.cullMeshDraws.write(
+          i, 0, mesh_draws.data(), mesh_draws_size);
+    }
+
+    _create_cull_draw_buffer(pipelineData, currentSwapChainNbImg);
+}
+
+void
+VulkanModelPipeline::_create_cull_draw_buffer(
+  VulkanModelPipelineData &pipelineData,
+  uint32_t currentSwapChainNbImg)
+{
+    auto storage_alignment =
+      getMinStorageBufferOffsetAlignment(_physical_device);
+
+    // Draw areas of each mesh, only accessed by the gpu
+    VkDeviceSize nb_draws = 0;
+    pipelineData.cullFirstDraws.resize(_cull_mesh_max_draws.size());
+    for (size_t i = 0; i < _cull_mesh_max_draws.size(); ++i) {
+        pipelineData.cullFirstDraws[i] = nb_draws;
+        nb_draws += _cull_mesh_max_draws[i];
+    }
+    VkDeviceSize draws_size = sizeof(VkDrawIndexedIndirectCommand) * nb_draws;
+    pipelineData.cullDrawSingleSwapChainSize =
+      (draws_size + storage_alignment - 1) / storage_alignment *
+      storage_alignment;
+    createBuffer(_device,
+                 pipelineData.cullDrawBuffer,
+                 pipelineData.cullDrawSingleSwapChainSize *
+                   currentSwapChainNbImg,
+                 VK_BUFFER_USAGE_STORAGE_BUFFER_BIT |
+                   VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT);
+    pipelineData.cullDrawAllocation = _allocator->allocateBuffer(
+      pipelineData.cullDrawBuffer, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+}
+
+void
+VulkanModelPipeline::_create_cull_descriptor_sets(
+  VulkanModelPipelineData &pipelineData,
+  uint32_t currentSwapChainNbImg)
+{
+    auto const nb_img = currentSwapChainNbImg;
+
+    std::array<VkDescriptorPoolSize, 2> pool_size{};
+    pool_size[0].type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+    pool_size[0].descriptorCount = nb_img;
+    pool_size[1].type = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+    pool_size[1].descriptorCount = nb_img * 4;
+
+    VkDescriptorPoolCreateInfo pool_info{};
+    pool_info.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+    pool_info.poolSizeCount = pool_size.size();
+    pool_info.pPoolSizes = pool_size.data();
+    pool_info.maxSets = nb_img;
+    if (vkCreateDescriptorPool(
+          _device, &pool_info, nullptr, &pipelineData.cullDescriptorPool) !=
+        VK_SUCCESS) {
+        throw std::runtime_error(
+          "VulkanModelPipeline: failed to create cull descriptor pool");
+    }
+
+    std::vector<VkDescriptorSetLayout> layouts(nb_img,
+                                               _cull_descriptor_set_layout);
+    VkDescriptorSetAllocateInfo alloc_info{};
+    alloc_info.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+    alloc_info.descriptorPool = pipelineData.cullDescriptorPool;
+    alloc_info.descriptorSetCount = nb_img;
+    alloc_info.pSetLayouts = layouts.data();
+    pipelineData.cullDescriptorSets.resize(nb_img);
+    if (vkAllocateDescriptorSets(
+          _device, &alloc_info, pipelineData.cullDescriptorSets.data()) !=
+        VK_SUCCESS) {
+        throw std::runtime_error(
+          "VulkanModelPipeline: failed to create cull descriptor sets");
+    }
+    _write_cull_descriptor_sets(pipelineData);
+}
+
+void
+VulkanModelPipeline::_write_cull_descriptor_sets(
+  VulkanModelPipelineData const &pipelineData)
+{
+    auto const max_instances = _instance_capacity;
+    for (size_t i = 0; i < pipelineData.cullDescriptorSets.size(); ++i) {
+        std::array<VkDescriptorBufferInfo, 5> buffer_info{};
+        buffer_info[0].buffer = pipelineData.cullUbo.getBuffer();
+        buffer_info[0].offset = pipelineData.cullUbo.getFrameOffset(i);
+        buffer_info[0].range = sizeof(ModelPipelineCullUbo);
+        buffer_info[1].buffer = pipelineData.buffer;
+        buffer_info[1].offset = pipelineData.clustersOffset;
+        buffer_info[1].range = pipelineData.clustersSize;
+        buffer_info[2].buffer = _instance_buffer.getBuffer();
+        buffer_info[2].offset = 0;
+        buffer_info[2].range = sizeof(glm::mat4) * max_instances;
+        buffer_info[3].buffer = pipelineData.cullDrawBuffer;
+        buffer_info[3].offset = pipelineData.cullDrawSingleSwapChainSize * i;
+        buffer_info[3].range = pipelineData.cullDrawSingleSwapChainSize;
+        buffer_info[4].buffer = pipelineData.cullMeshDraws.getBuffer();
+        buffer_info[4].offset = pipelineData.cullMeshDraws.getFrameOffset(i);
+        buffer_info[4].range = pipelineData.cullMeshDraws.getFrameStride();
+
+        std::array<VkWriteDescriptorSet, 5> descriptor_write{};
+        for (uint32_t j = 0; j < descriptor_write.size(); ++j) {
+            descriptor_write[j].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+            descriptor_write[j].dstSet = pipelineData.cullDescriptorSets[i];
+            descriptor_write[j].dstBinding = j;
+            descriptor_write[j].dstArrayElement = 0;
+            descriptor_write[j].descriptorType =
+              (j) ? VK_DESCRIPTOR_TYPE_STORAGE_BUFFER
+                  : VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+            descriptor_write[j].descriptorCount = 1;
+            descriptor_write[j].pBufferInfo = &buffer_info[j];
+            descriptor_write[j].pImageInfo = nullptr;
+            descriptor_write[j].pTexelBufferView = nullptr;
+        }
+        vkUpdateDescriptorSets(_device,
+                               descriptor_write.size(),
+                               descriptor_write.data(),
+                               0,
+                               nullptr);
+    }
+}
+
 void
 VulkanModelPipeline::_create_descriptor_pool(
   VulkanSwapChain const &swapChain,
   VulkanModelPipelineData &pipelineData)
 {
-    std::array<VkDescriptorPoolSize, 3> pool_size{};
-    // System Ubo
-    pool_size[0].type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
-    pool_size[0].descriptorCount =
-      swapChain.currentSwapChainNbImg * pipelineData.nbMaterials;
-    // Material Ubo
-    pool_size[1].type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
-    pool_size[1].descriptorCount =
-      swapChain.currentSwapChainNbImg * pipelineData.nbMaterials;
+    // Bindless uses a single set per swapchain image whatever the model
+    uint32_t nb_sets = (_option.bindless_materials)
+                         ? swapChain.currentSwapChainNbImg
+                         : swapChain.currentSwapChainNbImg *
+                             pipelineData.nbMaterials;
+
+    std::vector<VkDescriptorPoolSize> pool_size(3);
+    // System Ubo, offset given at bind time
+    pool_size[0].type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC;
+    pool_size[0].descriptorCount = nb_sets;
+    // Material Ubo or storage buffer
+    pool_size[1].type = (_option.bindless_materials)
+                          ? VK_DESCRIPTOR_TYPE_STORAGE_BUFFER
+                          : VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+    pool_size[1].descriptorCount = nb_sets;
     // Texture Sampler
     pool_size[2].type = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
     pool_size[2].descriptorCount =
-      swapChain.currentSwapChainNbImg * pipelineData.nbMaterials;
+      (_option.bindless_materials) ? nb_sets * _max_bindless_textures
+                                   : nb_sets;
+    // Instance matrices of lod draws
+    if (_option.lod_selection) {
+        pool_size.push_back({ VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, nb_sets });
+    }
 
     VkDescriptorPoolCreateInfo pool_info{};
     pool_info.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
     pool_info.poolSizeCount = pool_size.size();
     pool_info.pPoolSizes = pool_size.data();
-    pool_info.maxSets =
-      swapChain.currentSwapChainNbImg * pipelineData.nbMaterials;
+    pool_info.maxSets = nb_sets;
 
     if (vkCreateDescriptorPool(
           _device, &pool_info, nullptr, &pipelineData.descriptorPool) !=
@@ -582,6 +1686,8 @@ VulkanModelPipeline::_create_descriptor_sets(
 
     pipelineData.descriptorSets.resize(swapChain.currentSwapChainNbImg *
                                        pipelineData.nbMaterials);
+    pipelineData.texturesStreamingVersion.assign(
+      swapChain.currentSwapChainNbImg, 0);
     if (vkAllocateDescriptorSets(
           _device, &alloc_info, pipelineData.descriptorSets.data()) !=
         VK_SUCCESS) {
@@ -604,7 +1710,7 @@ VulkanModelPipeline::_create_descriptor_sets(
             descriptor_write[0].dstBinding = 0;
             descriptor_write[0].dstArrayElement = 0;
             descriptor_write[0].descriptorType =
-              VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+              VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC;
             descriptor_write[0].descriptorCount = 1;
             descriptor_write[0].pBufferInfo = &system_buffer_info;
             descriptor_write[0].pImageInfo = nullptr;
@@ -613,8 +1719,9 @@ VulkanModelPipeline::_create_descriptor_sets(
             // Model UBO
             VkDescriptorBufferInfo model_buffer_info{};
             model_buffer_info.buffer = pipelineData.buffer;
-            model_buffer_info.offset =
-              pipelineData.uboOffset + pipelineData.singleUboSize * i;
+            model_buffer_info.offset = pipelineData.uboOffset +
+                                       pipelineData.singleUboSize * i +
+                                       pipelineData.singleSwapChainUboSize * j;
             model_buffer_info.range = sizeof(ModelPipelineUbo);
             descriptor_write[1].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
             descriptor_write[1].dstSet = pipelineData.descriptorSets[ds_index];
@@ -630,9 +1737,11 @@ VulkanModelPipeline::_create_descriptor_sets(
             // Texture
             VkDescriptorImageInfo img_info{};
             img_info.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
-            img_info.imageView =
-              pipelineData.diffuseTextures[j].texture_img_view;
-            img_info.sampler = pipelineData.diffuseTextures[j].texture_sampler;
+            auto const &tex =
+              pipelineData
+                .diffuseTextures[pipelineData.diffuseTextureIndices[j]];
+            img_info.imageView = tex.texture_img_view;
+            img_info.sampler = tex.texture_sampler;
             descriptor_write[2].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
             descriptor_write[2].dstSet = pipelineData.descriptorSets[ds_index];
             descriptor_write[2].dstBinding = 2;
@@ -653,6 +1762,208 @@ VulkanModelPipeline::_create_descriptor_sets(
     }
 }
 
+void
+VulkanModelPipeline::_create_bindless_descriptor_sets(
+  VulkanSwapChain const &swapChain,
+  VulkanModelPipelineData &pipelineData,
+  VkBuffer systemUbo)
+{
+    std::vector<VkDescriptorSetLayout> layouts(swapChain.currentSwapChainNbImg,
+                                               _descriptor_set_layout);
+
+    VkDescriptorSetAllocateInfo alloc_info{};
+    alloc_info.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+    alloc_info.descriptorPool = pipelineData.descriptorPool;
+    alloc_info.descriptorSetCount = swapChain.currentSwapChainNbImg;
+    alloc_info.pSetLayouts = layouts.data();
+
+    pipelineData.descriptorSets.resize(swapChain.currentSwapChainNbImg);
+    pipelineData.texturesStreamingVersion.assign(
+      swapChain.currentSwapChainNbImg, 0);
+    if (vkAllocateDescriptorSets(
+          _device, &alloc_info, pipelineData.descriptorSets.data()) !=
+        VK_SUCCESS) {
+        throw std::runtime_error(
+          "VulkanModelPipeline: failed to create descriptor sets");
+    }
+
+    for (uint32_t i = 0; i < swapChain.currentSwapChainNbImg; ++i) {
+        std::array<VkWriteDescriptorSet, 2> descriptor_write{};
+
+        // System UBO
+        VkDescriptorBufferInfo system_buffer_info{};
+        system_buffer_info.buffer = systemUbo;
+        system_buffer_info.offset = 0;
+        system_buffer_info.range = sizeof(SystemUbo);
+        descriptor_write[0].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+        descriptor_write[0].dstSet = pipelineData.descriptorSets[i];
+        descriptor_write[0].dstBinding = 0;
+        descriptor_write[0].dstArrayElement = 0;
+        descriptor_write[0].descriptorType =
+          VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC;
+        descriptor_write[0].descriptorCount = 1;
+        descriptor_write[0].pBufferInfo = &system_buffer_info;
+
+        // Materials
+        VkDescriptorBufferInfo materials_buffer_info{};
+        materials_buffer_info.buffer = pipelineData.buffer;
+        materials_buffer_info.offset = pipelineData.materialsOffset;
+        materials_buffer_info.range = pipelineData.materialsSize;
+        descriptor_write[1].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+        descriptor_write[1].dstSet = pipelineData.descriptorSets[i];
+        descriptor_write[1].dstBinding = 1;
+        descriptor_write[1].dstArrayElement = 0;
+        descriptor_write[1].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+        descriptor_write[1].descriptorCount = 1;
+        descriptor_write[1].pBufferInfo = &materials_buffer_info;
+
+        vkUpdateDescriptorSets(_device,
+                               descriptor_write.size(),
+                               descriptor_write.data(),
+                               0,
+                               nullptr);
+        _write_texture_descriptors(pipelineData, i);
+    }
+}
+
+void
+VulkanModelPipeline::_write_texture_descriptors(
+  VulkanModelPipelineData const &pipelineData,
+  uint32_t imgIndex)
+{
+    std::vector<VkDescriptorImageInfo> img_infos(
+      pipelineData.diffuseTextures.size());
+    for (size_t i = 0; i < img_infos.size(); ++i) {
+        auto const &tex = pipelineData.diffuseTextures[i];
+        img_infos[i].imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+        img_infos[i].imageView = tex.texture_img_view;
+        img_infos[i].sampler = tex.texture_sampler;
+    }
+
+    // Bindless writes the whole texture array at once
+    std::vector<VkWriteDescriptorSet> descriptor_writes(
+      (_option.bindless_materials) ? 1 : pipelineData.nbMaterials);
+    auto nb_img = pipelineData.texturesStreamingVersion.size();
+    for (size_t j = 0; j < descriptor_writes.size(); ++j) {
+        auto &write = descriptor_writes[j];
+        write.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+        write.dstBinding = 2;
+        write.dstArrayElement = 0;
+        write.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+        if (_option.bindless_materials) {
+            write.dstSet = pipelineData.descriptorSets[imgIndex];
+            write.descriptorCount = img_infos.size();
+            write.pImageInfo = img_infos.data();
+        } else {
+            write.dstSet = pipelineData.descriptorSets[imgIndex + nb_img * j];
+            write.descriptorCount = 1;
+            write.pImageInfo =
+              &img_infos[pipelineData.diffuseTextureIndices[j]];
+        }
+    }
+    vkUpdateDescriptorSets(_device,
+                           descriptor_writes.size(),
+                           descriptor_writes.data(),
+                           0,
+                           nullptr);
+}
+
+void
+VulkanModelPipeline::_write_instance_descriptors(
+  VulkanModelPipelineData const &pipelineData)
+{
+    VkDescriptorBufferInfo instance_buffer_info{};
+    instance_buffer_info.buffer = _instance_buffer.getBuffer();
+    instance_buffer_info.offset = 0;
+    instance_buffer_info.range = sizeof(glm::mat4) * _instance_capacity;
+
+    std::vector<VkWriteDescriptorSet> descriptor_writes(
+      pipelineData.descriptorSets.size());
+    for (size_t i = 0; i < descriptor_writes.size(); ++i) {
+        auto &write = descriptor_writes[i];
+        write.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+        write.dstSet = pipelineData.descriptorSets[i];
+        write.dstBinding = 3;
+        write.dstArrayElement = 0;
+        write.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+        write.descriptorCount = 1;
+        write.pBufferInfo = &instance_buffer_info;
+    }
+    vkUpdateDescriptorSets(_device,
+                           descriptor_writes.size(),
+                           descriptor_writes.data(),
+                           0,
+                           nullptr);
+}
+
+void
+VulkanModelPipeline::_reserve_instances(uint32_t nb_instances)
+{
+    if (nb_instances <= _instance_capacity) {
+        return;
+    }
+
+    // Pending matrices are copied along with the rest of the buffer
+    _staging_ring->submitUploads();
+    _instance_buffer.reserve(sizeof(glm::mat4) * nb_instances);
+    _instance_capacity = _instance_buffer.getSize() / sizeof(glm::mat4);
+
+    // Queue is idle, lod instance lists are sized by the capacity. Cull
+    // draw areas grow on their own, only the instance buffer is rebound.
+    if (_option.lod_selection) {
+        _pipeline_model.lodBuffer.clear();
+        _create_lod_buffer(*_model, _pipeline_model, _swap_chain_nb_img);
+        _write_instance_descriptors(_pipeline_model);
+    }
+    if (_option.cluster_culling) {
+        _write_cull_descriptor_sets(_pipeline_model);
+    }
+}
+
+void
+VulkanModelPipeline::_grow_cull_draws(uint32_t imgIndex)
+{
+    auto &mesh_draws_buffer = _pipeline_model.cullMeshDraws;
+    mesh_draws_buffer.invalidate(imgIndex,
+                                 0,
+                                 sizeof(ModelPipelineCullMeshDraws) *
+                                   _cull_mesh_max_draws.size());
+    auto mesh_draws = static_cast<ModelPipelineCullMeshDraws const *>(
+      mesh_draws_buffer.getFrameData(imgIndex));
+
+    // Areas short of draws are at least doubled while the total stays
+    // under the device limits, clusters past them are not drawn
+    VkDeviceSize nb_draws = 0;
+    for (auto const &it : _cull_mesh_max_draws) {
+        nb_draws += it;
+    }
+    bool grown = false;
+    for (size_t i = 0; i < _cull_mesh_max_draws.size(); ++i) {
+        auto &max_draws = _cull_mesh_max_draws[i];
+        if (mesh_draws[i].needed_draws <= max_draws ||
+            nb_draws >= _cull_draws_limit) {
+            continue;
+        }
+        auto new_max_draws = std::min<VkDeviceSize>(
+          std::max<VkDeviceSize>(mesh_draws[i].needed_draws,
+                                 static_cast<VkDeviceSize>(max_draws) * 2),
+          max_draws + (_cull_draws_limit - nb_draws));
+        nb_draws += new_max_draws - max_draws;
+        max_draws = new_max_draws;
+        grown = true;
+    }
+    if (!grown) {
+        return;
+    }
+
+    // Areas of other images may still be read by frames in flight
+    vkQueueWaitIdle(_gfx_queue);
+    vkDestroyBuffer(_device, _pipeline_model.cullDrawBuffer, nullptr);
+    _allocator->free(_pipeline_model.cullDrawAllocation);
+    _create_cull_draw_buffer(_pipeline_model, _swap_chain_nb_img);
+    _write_cull_descriptor_sets(_pipeline_model);
+}
+
 void
 VulkanModelPipeline::_set_instance_matrix_on_gpu(uint32_t bufferIndex,
                                                  ModelInstanceInfo const &info)
@@ -660,17 +1971,8 @@ VulkanModelPipeline::_set_instance_matrix_on_gpu(uint32_t bufferIndex,
     auto instance_mat =
       computeInstanceMatrix(_pipeline_model.modelCenter, info);
 
-    VkBufferCopy copy_region{};
-    copy_region.size = sizeof(glm::mat4);
-    copy_region.dstOffset =
-      _pipeline_model.instanceMatricesOffset + sizeof(glm::mat4) * bufferIndex;
-    copy_region.srcOffset = 0;
-
-    copyCpuBufferToGpu(_device,
-                       _physical_device,
-                       _cmd_pool,
-                       _gfx_queue,
-                       _pipeline_model.buffer,
-                       &instance_mat,
-                       copy_region);
+    _staging_ring->upload(_instance_buffer.getBuffer(),
+                          sizeof(glm::mat4) * bufferIndex,
+                          &instance_mat,
+                          sizeof(glm::mat4));
 }
\ No newline at end of file
@@ -1,6 +1,7 @@
 #include "VulkanModelPipelineData.hpp"
 
 #include "Mesh.hpp"
+#include "PackedVertex.hpp"
 
 std::array<VkVertexInputBindingDescription, 2>
 VulkanModelPipelineData::getInputBindingDescription()
@@ -69,24 +70,90 @@ VulkanModelPipelineData::getInputAttributeDescription()
     return (attribute_description);
 }
 
+std::array<VkVertexInputBindingDescription, 2>
+VulkanModelPipelineData::getPackedInputBindingDescription()
+{
+    auto binding_description = getInputBindingDescription();
+    binding_description[0].stride = sizeof(PackedVertex);
+
+    return (binding_description);
+}
+
+std::array<VkVertexInputAttributeDescription, 8>
+VulkanModelPipelineData::getPackedInputAttributeDescription()
+{
+    std::array<VkVertexInputAttributeDescription, 8> attribute_description{};
+
+    attribute_description[0].binding = 0;
+    attribute_description[0].location = 0;
+    attribute_description[0].offset = offsetof(PackedVertex, position);
+    attribute_description[0].format = VK_FORMAT_R16G16B16A16_UNORM;
+
+    attribute_description[1].binding = 0;
+    attribute_description[1].location = 1;
+    attribute_description[1].offset = offsetof(PackedVertex, normal);
+    attribute_description[1].format = VK_FORMAT_R16G16_SNORM;
+
+    attribute_description[2].binding = 0;
+    attribute_description[2].location = 2;
+    attribute_description[2].offset = offsetof(PackedVertex, tex_coords);
+    attribute_description[2].format = VK_FORMAT_R16G16_SFLOAT;
+
+    attribute_description[3].binding = 0;
+    attribute_description[3].location = 3;
+    attribute_description[3].offset = offsetof(PackedVertex, tangent);
+    attribute_description[3].format = VK_FORMAT_R16G16_SNORM;
+
+    // Instance matrix, same as full precision vertices
+    auto full_attribute_description = getInputAttributeDescription();
+    for (size_t i = 4; i < attribute_description.size(); ++i) {
+        attribute_description[i] = full_attribute_description[i + 1];
+    }
+    return (attribute_description);
+}
+
 void
 VulkanModelPipelineData::clear()
 {
     buffer = nullptr;
-    memory = nullptr;
+    allocation = {};
     descriptorPool = nullptr;
     verticesSize = 0;
     indicesSize = 0;
     singleUboSize = 0;
     singleSwapChainUboSize = 0;
-    instanceMatricesOffset = 0;
     indicesOffset = 0;
     uboOffset = 0;
+    materialsOffset = 0;
+    materialsSize = 0;
     verticesSize = 0;
     descriptorSets.clear();
     diffuseTextures.clear();
+    diffuseTextureNames.clear();
+    diffuseTextureIndices.clear();
+    texturesStreamingVersion.clear();
     indicesDrawOffset.clear();
     indicesDrawNb.clear();
+    indexBlocks.clear();
+    drawMeshes.clear();
+    drawGroups.clear();
+    lodBuffer = {};
+    lodInstancesSize = 0;
+    lodIndirectOffset = 0;
+    nbLodLevels = 0;
+    lodErrors.clear();
+    modelRadius = 0.0f;
+    clustersOffset = 0;
+    clustersSize = 0;
+    nbClusters = 0;
+    cullUbo = {};
+    cullMeshDraws = {};
+    cullFirstDraws.clear();
+    cullDrawBuffer = nullptr;
+    cullDrawAllocation = {};
+    cullDrawSingleSwapChainSize = 0;
+    cullDescriptorPool = nullptr;
+    cullDescriptorSets.clear();
     nbMaterials = 0;
     modelCenter = glm::vec3(0.0f);
 }
@@ -8,10 +8,12 @@
 
 void
 VulkanModelRenderPass::init(VulkanInstance const &vkInstance,
+                            VulkanMemoryAllocator &allocator,
                             VulkanSwapChain const &swapChain)
 {
     _device = vkInstance.device;
     _physical_device = vkInstance.physicalDevice;
+    _allocator = &allocator;
     _command_pool = vkInstance.modelCommandPool;
     _gfx_queue = vkInstance.graphicQueue;
     _create_render_pass(swapChain);
@@ -34,7 +36,7 @@ VulkanModelRenderPass::clear()
     size_t i = 0;
     vkDestroyImageView(_device, depthImgView, nullptr);
     vkDestroyImage(_device, depthImage, nullptr);
-    vkFreeMemory(_device, depthImgMemory, nullptr);
+    _allocator->free(depthImgAllocation);
     for (auto &it : framebuffers) {
         vkDestroyFramebuffer(_device, it, nullptr);
         ++i;
@@ -129,11 +131,8 @@ VulkanModelRenderPass::_create_depth_resources(VulkanSwapChain const &swapChain)
                              depthFormat,
                              VK_IMAGE_TILING_OPTIMAL,
                              VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT);
-    allocateImage(_physical_device,
-                  _device,
-                  depthImage,
-                  depthImgMemory,
-                  VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+    depthImgAllocation = _allocator->allocateImage(
+      depthImage, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
     depthImgView = createImageView(
       depthImage, depthFormat, 1, _device, VK_IMAGE_ASPECT_DEPTH_BIT);
     transitionImageLayout(_device,
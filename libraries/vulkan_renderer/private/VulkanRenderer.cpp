@@ -1,14 +1,18 @@
 #include "VulkanRenderer.hpp"
 
+#include <algorithm>
 #include <cstdint>
 #include <stdexcept>
 #include <cassert>
 #include <cstring>
 
+#include "fmt/core.h"
+
 #include "VulkanDebug.hpp"
 #include "VulkanSwapChainUtils.hpp"
 #include "VulkanCommandBuffer.hpp"
 #include "VulkanMemory.hpp"
+#include "VulkanPhysicalDevice.hpp"
 #include "VulkanUboStructs.hpp"
 
 void
@@ -45,10 +49,18 @@ VulkanRenderer::init(VkSurfaceKHR surface, uint32_t win_w, uint32_t win_h)
     assert(surface);
 
     _vk_instance.init(surface);
-    _tex_manager.init(_vk_instance);
+    _memory_allocator.init(_vk_instance.physicalDevice,
+                           _vk_instance.device,
+                           _vk_instance.memoryBudgetEnabled);
+    _staging_ring.init(_vk_instance.device,
+                       _memory_allocator,
+                       _vk_instance.modelCommandPool,
+                       _vk_instance.graphicQueue,
+                       VulkanSync::MAX_FRAME_INFLIGHT);
+    _create_frame_allocator();
+    _tex_manager.init(_vk_instance, _memory_allocator);
     _swap_chain.init(_vk_instance, win_w, win_h);
     _sync.init(_vk_instance, _swap_chain.swapChainImageViews.size());
-    _create_system_uniform_buffer();
     _ui.init(_vk_instance, _swap_chain);
 }
 
@@ -56,34 +68,42 @@ void
 VulkanRenderer::resize(uint32_t win_w, uint32_t win_h)
 {
     vkDeviceWaitIdle(_vk_instance.device);
+    _clear_retired_models();
     if (win_w <= 0 || win_h <= 0) {
         return;
     }
 
     _swap_chain.resize(win_w, win_h);
     _sync.resize(_swap_chain.currentSwapChainNbImg);
-    vkDestroyBuffer(_vk_instance.device, _system_uniform, nullptr);
-    vkFreeMemory(_vk_instance.device, _system_uniform_memory, nullptr);
-    _create_system_uniform_buffer();
     _ui.resize(_swap_chain);
-    if (_model_pipeline.isInit()) {
-        _model_pipeline.resize(_swap_chain, _tex_manager, _system_uniform);
-        _create_model_command_buffers();
+    if (!_model.pipeline && !_loading_model.pipeline) {
+        return;
+    }
+    if (_model.pipeline) {
+        _model.pipeline->resize(
+          _swap_chain, _tex_manager, _frame_allocator.getBuffer());
     }
+    if (_loading_model.pipeline) {
+        _loading_model.pipeline->resize(
+          _swap_chain, _tex_manager, _frame_allocator.getBuffer());
+    }
+    _create_model_command_buffers();
 }
 
 void
 VulkanRenderer::clear()
 {
     _ui.clear();
-    if (_model_pipeline.isInit()) {
-        _model_pipeline.clear();
-    }
+    _free_model_command_buffers();
+    _clear_model(_loading_model);
+    _clear_model(_model);
+    _clear_retired_models();
     _sync.clear();
     _swap_chain.clear();
     _tex_manager.clear();
-    vkDestroyBuffer(_vk_instance.device, _system_uniform, nullptr);
-    vkFreeMemory(_vk_instance.device, _system_uniform_memory, nullptr);
+    _frame_allocator.clear();
+    _staging_ring.clear();
+    _memory_allocator.clear();
     _vk_instance.clear();
 }
 
@@ -113,66 +133,158 @@ VulkanRenderer::getEngineVersion() const
 
 // Model Related
 void
-VulkanRenderer::loadModel(Model const &model)
+VulkanRenderer::loadModel(Model &&model,
+                          ModelRenderingOption const &option,
+                          VulkanTextureManager::DecodedTextures &&textures)
 {
-    deviceWaitIdle();
-    if (_model_pipeline.isInit()) {
-        _model_pipeline.clear();
+    // Previous load was never drawn but instance copies to it may be in
+    // flight
+    _retire_model(_loading_model);
+
+    _loading_model.model = std::make_unique<Model>(std::move(model));
+    auto const &loaded_model = *_loading_model.model;
+    auto fitted_option = option;
+    auto texture_paths = VulkanModelPipeline::getTexturePaths(loaded_model);
+    try {
+        _fit_model_in_memory(loaded_model, fitted_option);
+        _tex_manager.loadDecodedTextures(texture_paths, textures);
+    } catch (std::exception const &e) {
+        _loading_model = {};
+        throw;
     }
-    _tex_manager.unloadAllTextures();
+
+    // Textures referenced by loadDecodedTextures are found in cache
+    _loading_model.pipeline = std::make_unique<VulkanModelPipeline>();
     try {
-        _model_pipeline.init(_vk_instance,
-                             _swap_chain,
-                             model,
-                             _tex_manager,
-                             _system_uniform,
-                             MAX_MODEL_INSTANCE);
+        _loading_model.pipeline->init(_vk_instance,
+                                      _swap_chain,
+                                      loaded_model,
+                                      _tex_manager,
+                                      _memory_allocator,
+                                      _staging_ring,
+                                      _frame_allocator.getBuffer(),
+                                      INITIAL_MODEL_INSTANCE_CAPACITY,
+                                      fitted_option);
     } catch (std::exception const &e) {
-        _model_pipeline.clear();
+        for (auto const &it : texture_paths) {
+            _tex_manager.releaseTexture(it);
+        }
+        _clear_model(_loading_model);
         throw;
     }
+    // Pipeline holds its own references
+    for (auto const &it : texture_paths) {
+        _tex_manager.releaseTexture(it);
+    }
 
-    // Drawing related
-    _create_model_command_buffers();
+    // Drawing related, buffers of the previous model may be pending
+    if (_model_command_buffers.empty()) {
+        _create_model_command_buffers();
+    }
 }
 
 uint32_t
 VulkanRenderer::addModelInstance(ModelInstanceInfo const &info)
 {
-    auto index = _model_pipeline.addInstance(info);
-    _create_model_command_buffers();
-    return (index);
+    auto &slot = _get_instance_model();
+    assert(slot.pipeline);
+    return (slot.pipeline->addInstance(info));
 }
 
 bool
 VulkanRenderer::removeModelInstance(uint32_t index)
 {
-    auto ret = _model_pipeline.removeInstance(index);
-    _create_model_command_buffers();
-    return (ret);
+    auto &slot = _get_instance_model();
+    if (!slot.pipeline) {
+        return (false);
+    }
+    return (slot.pipeline->removeInstance(index));
 }
 bool
 VulkanRenderer::updateModelInstance(uint32_t index,
                                     ModelInstanceInfo const &info)
 {
-    return (_model_pipeline.updateInstance(index, info));
+    auto &slot = _get_instance_model();
+    if (!slot.pipeline) {
+        return (false);
+    }
+    return (slot.pipeline->updateInstance(index, info));
 }
 
 bool
 VulkanRenderer::getModelInstance(uint32_t index, ModelInstanceInfo &info)
 {
-    return (_model_pipeline.getInstance(index, info));
+    auto &slot = _get_instance_model();
+    if (!slot.pipeline) {
+        return (false);
+    }
+    return (slot.pipeline->getInstance(index, info));
+}
+
+// Texture Related
+void
+VulkanRenderer::setTextureMemoryBudget(VkDeviceSize budget)
+{
+    _tex_manager.setMemoryBudget(budget);
+}
+
+void
+VulkanRenderer::setTextureStreamingBudget(VkDeviceSize budget)
+{
+    _tex_manager.setStreamingBudget(budget);
+}
+
+bool
+VulkanRenderer::isTextureCompressionSupported() const
+{
+    return (_tex_manager.isCompressionSupported());
+}
+
+// Memory Related
+VulkanMemoryReport
+VulkanRenderer::getMemoryReport() const
+{
+    // Swapchain images are allocated by the driver, 32 bits formats
+    static constexpr VkDeviceSize const SWAPCHAIN_PIXEL_SIZE = 4;
+
+    VulkanMemoryReport report{};
+    auto add_model_usage = [&](ModelSlot const &slot) -> void {
+        if (slot.pipeline) {
+            slot.pipeline->addMemoryUsage(report);
+        }
+    };
+    add_model_usage(_model);
+    add_model_usage(_loading_model);
+    for (auto const &it : _retired_models) {
+        add_model_usage(it);
+    }
+    report.categories[VMC_UBO] +=
+      _frame_allocator.getFrameSize() * VulkanSync::MAX_FRAME_INFLIGHT;
+    report.categories[VMC_TEXTURE] += _tex_manager.getUsedMemory();
+    report.categories[VMC_SWAPCHAIN] +=
+      SWAPCHAIN_PIXEL_SIZE * _swap_chain.swapChainExtent.width *
+      _swap_chain.swapChainExtent.height * _swap_chain.currentSwapChainNbImg;
+    report.categories[VMC_STAGING] += _staging_ring.getSize();
+    report.current = _memory_allocator.getStatistics();
+    report.peak = _memory_allocator.getPeakStatistics();
+    report.has_memory_budget = _memory_allocator.hasMemoryBudget();
+    report.heaps = _memory_allocator.getHeapBudgets();
+    return (report);
 }
 
 // Render Related
 void
-VulkanRenderer::draw(glm::mat4 const &view_proj_mat)
+VulkanRenderer::draw(glm::mat4 const &view_proj_mat,
+                     glm::mat4 const &proj_mat,
+                     glm::vec3 const &camera_pos)
 {
     vkWaitForFences(_vk_instance.device,
                     1,
                     &_sync.inflightFence[_sync.currentFrame],
                     VK_TRUE,
                     UINT64_MAX);
+    _frame_allocator.reset(_sync.currentFrame);
+    _update_models();
 
     uint32_t img_index;
     auto result =
@@ -197,8 +309,8 @@ VulkanRenderer::draw(glm::mat4 const &view_proj_mat)
     _sync.imgsInflightFence[img_index] =
       _sync.inflightFence[_sync.currentFrame];
 
-    if (_model_pipeline.isInit()) {
-        _emit_model_ui_cmds(img_index, view_proj_mat);
+    if (_model.pipeline) {
+        _emit_model_ui_cmds(img_index, view_proj_mat, proj_mat, camera_pos);
     } else {
         _emit_ui_cmds(img_index);
     }
@@ -226,9 +338,12 @@ VulkanRenderer::deviceWaitIdle() const
     vkDeviceWaitIdle(_vk_instance.device);
 }
 
+// Allocated once per model load and per swap chain resize, buffers are
+// re-recorded each frame
 void
 VulkanRenderer::_create_model_command_buffers()
 {
+    _free_model_command_buffers();
     _model_command_buffers.resize(_swap_chain.swapChainImageViews.size());
 
     VkCommandBufferAllocateInfo cb_allocate_info{};
@@ -240,72 +355,259 @@ VulkanRenderer::_create_model_command_buffers()
     if (vkAllocateCommandBuffers(_vk_instance.device,
                                  &cb_allocate_info,
                                  _model_command_buffers.data()) != VK_SUCCESS) {
+        _model_command_buffers.clear();
         throw std::runtime_error(
           "VulkanRenderer: Failed to allocate model command buffers");
     }
+}
+
+void
+VulkanRenderer::_free_model_command_buffers()
+{
+    if (_model_command_buffers.empty()) {
+        return;
+    }
+    vkFreeCommandBuffers(_vk_instance.device,
+                         _vk_instance.modelCommandPool,
+                         _model_command_buffers.size(),
+                         _model_command_buffers.data());
+    _model_command_buffers.clear();
+}
+
+void
+VulkanRenderer::_record_model_command_buffer(size_t img_index,
+                                             uint32_t system_ubo_offset)
+{
+    auto cmd_buffer = _model_command_buffers[img_index];
+    auto &pipeline = *_model.pipeline;
+    auto const &model_render_pass = pipeline.getVulkanModelRenderPass();
+
+    VkCommandBufferBeginInfo cb_begin_info{};
+    cb_begin_info.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+    cb_begin_info.flags = 0;
+    cb_begin_info.pInheritanceInfo = nullptr;
+    if (vkBeginCommandBuffer(cmd_buffer, &cb_begin_info) != VK_SUCCESS) {
+        throw std::runtime_error(
+          "VulkanRenderer: Failed to begin recording model command buffer");
+    }
+
+    // Begin render pass values
+    std::array<VkClearValue, 2> clear_vals{};
+    clear_vals[0].color = { { 0.2f, 0.2f, 0.2f, 1.0f } };
+    clear_vals[1].depthStencil = { 1.0f, 0 };
+    VkRenderPassBeginInfo rp_begin_info{};
+    rp_begin_info.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
+    rp_begin_info.renderPass = model_render_pass.renderPass;
+    rp_begin_info.framebuffer = model_render_pass.framebuffers[img_index];
+    rp_begin_info.renderArea.offset = { 0, 0 };
+    rp_begin_info.renderArea.extent = _swap_chain.swapChainExtent;
+    rp_begin_info.clearValueCount = clear_vals.size();
+    rp_begin_info.pClearValues = clear_vals.data();
+
+    pipeline.generateCullingCommands(cmd_buffer, img_index);
+    vkCmdBeginRenderPass(
+      cmd_buffer, &rp_begin_info, VK_SUBPASS_CONTENTS_INLINE);
+    pipeline.generateCommands(cmd_buffer,
+                              img_index,
+                              _swap_chain.currentSwapChainNbImg,
+                              system_ubo_offset);
+    vkCmdEndRenderPass(cmd_buffer);
+    if (vkEndCommandBuffer(cmd_buffer) != VK_SUCCESS) {
+        throw std::runtime_error(
+          "VulkanRenderer: Failed to record model command Buffer");
+    }
+}
 
-    size_t i = 0;
-    auto const &model_render_pass = _model_pipeline.getVulkanModelRenderPass();
-    for (auto &it : _model_command_buffers) {
-        VkCommandBufferBeginInfo cb_begin_info{};
-        cb_begin_info.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
-        cb_begin_info.flags = 0;
-        cb_begin_info.pInheritanceInfo = nullptr;
-        if (vkBeginCommandBuffer(it, &cb_begin_info) != VK_SUCCESS) {
-            throw std::runtime_error(
-              "VulkanRenderer: Failed to begin recording model command buffer");
+// Instances go to the model loaded last
+VulkanRenderer::ModelSlot &
+VulkanRenderer::_get_instance_model()
+{
+    if (_loading_model.pipeline) {
+        return (_loading_model);
+    }
+    return (_model);
+}
+
+void
+VulkanRenderer::_retire_model(ModelSlot &slot)
+{
+    if (!slot.pipeline) {
+        return;
+    }
+    slot.inflight_frames.fill(true);
+    _retired_models.emplace_back(std::move(slot));
+    slot = {};
+}
+
+// Device has to be done with the pipeline
+void
+VulkanRenderer::_clear_model(ModelSlot &slot)
+{
+    if (slot.pipeline) {
+        slot.pipeline->clear();
+    }
+    slot = {};
+}
+
+void
+VulkanRenderer::_clear_retired_models()
+{
+    for (auto &it : _retired_models) {
+        _clear_model(it);
+    }
+    _retired_models.clear();
+}
+
+// Called once the fence of the current frame is signaled
+void
+VulkanRenderer::_update_models()
+{
+    // Textures of the loaded model are uploaded by the texture manager
+    if (_loading_model.pipeline && _loading_model.pipeline->pollUploads() &&
+        _tex_manager.pollUploads()) {
+        _retire_model(_model);
+        _model = std::move(_loading_model);
+        _loading_model = {};
+    }
+
+    // Previous use of the current frame is done
+    for (auto it = _retired_models.begin(); it != _retired_models.end();) {
+        it->inflight_frames[_sync.currentFrame] = false;
+        if (std::find(it->inflight_frames.begin(),
+                      it->inflight_frames.end(),
+                      true) != it->inflight_frames.end()) {
+            ++it;
+            continue;
         }
+        _clear_model(*it);
+        it = _retired_models.erase(it);
+    }
+}
 
-        // Begin render pass values
-        std::array<VkClearValue, 2> clear_vals{};
-        clear_vals[0].color = { { 0.2f, 0.2f, 0.2f, 1.0f } };
-        clear_vals[1].depthStencil = { 1.0f, 0 };
-        VkRenderPassBeginInfo rp_begin_info{};
-        rp_begin_info.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
-        rp_begin_info.renderPass = model_render_pass.renderPass;
-        rp_begin_info.framebuffer = model_render_pass.framebuffers[i];
-        rp_begin_info.renderArea.offset = { 0, 0 };
-        rp_begin_info.renderArea.extent = _swap_chain.swapChainExtent;
-        rp_begin_info.clearValueCount = clear_vals.size();
-        rp_begin_info.pClearValues = clear_vals.data();
-
-        vkCmdBeginRenderPass(it, &rp_begin_info, VK_SUBPASS_CONTENTS_INLINE);
-        _model_pipeline.generateCommands(
-          it, i, _swap_chain.currentSwapChainNbImg);
-        vkCmdEndRenderPass(it);
-        if (vkEndCommandBuffer(it) != VK_SUCCESS) {
-            throw std::runtime_error(
-              "VulkanRenderer: Failed to record model command Buffer");
+void
+VulkanRenderer::_create_frame_allocator()
+{
+    auto alignment = std::max(
+      getMinUniformBufferOffsetAlignment(_vk_instance.physicalDevice),
+      getMinStorageBufferOffsetAlignment(_vk_instance.physicalDevice));
+    _frame_allocator.init(_vk_instance.device,
+                          _memory_allocator,
+                          VulkanSync::MAX_FRAME_INFLIGHT,
+                          VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT |
+                            VK_BUFFER_USAGE_STORAGE_BUFFER_BIT |
+                            VK_BUFFER_USAGE_VERTEX_BUFFER_BIT |
+                            VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT,
+                          alignment);
+}
+VkDeviceSize
+VulkanRenderer::_get_available_device_memory() const
+{
+    VkDeviceSize available{};
+    for (auto const &it : _memory_allocator.getHeapBudgets()) {
+        if (it.device_local && it.budget > it.usage) {
+            available += it.budget - it.usage;
         }
-        ++i;
     }
+    return (available);
 }
 
 void
-VulkanRenderer::_create_system_uniform_buffer()
-{
-    createBuffer(_vk_instance.device,
-                 _system_uniform,
-                 sizeof(SystemUbo) * _swap_chain.currentSwapChainNbImg,
-                 VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT);
-    allocateBuffer(_vk_instance.physicalDevice,
-                   _vk_instance.device,
-                   _system_uniform,
-                   _system_uniform_memory,
-                   VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT |
-                     VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+VulkanRenderer::_fit_model_in_memory(Model const &model,
+                                     ModelRenderingOption &option)
+{
+    // 32 bits depth format
+    static constexpr VkDeviceSize const DEPTH_PIXEL_SIZE = 4;
+
+    _tex_manager.setMaxTextureSize(0);
+    auto texture_paths = VulkanModelPipeline::getTexturePaths(model);
+    auto required = [&]() -> VkDeviceSize {
+        return (VulkanModelPipeline::estimateBuffersMemory(
+                  model,
+                  option,
+                  INITIAL_MODEL_INSTANCE_CAPACITY,
+                  _swap_chain.currentSwapChainNbImg) +
+                _tex_manager.estimateTexturesMemory(
+                  texture_paths, _tex_manager.getMaxTextureSize()) +
+                DEPTH_PIXEL_SIZE * _swap_chain.swapChainExtent.width *
+                  _swap_chain.swapChainExtent.height);
+    };
+    auto available = _get_available_device_memory();
+    if (required() <= available) {
+        return;
+    }
+
+    // Least visible loss first
+    _tex_manager.releaseUnusedTextures();
+    available = _get_available_device_memory();
+    if (required() > available &&
+        (_model.pipeline || !_retired_models.empty())) {
+        // Previous model is dropped before degrading the loaded one
+        deviceWaitIdle();
+        _clear_model(_model);
+        _clear_retired_models();
+        _tex_manager.releaseUnusedTextures();
+        available = _get_available_device_memory();
+    }
+    if (option.cluster_culling && required() > available) {
+        option.cluster_culling = false;
+        fmt::print(stderr,
+                   "VulkanRenderer: Not enough device memory, cluster "
+                   "culling disabled\n");
+    }
+    if (!option.packed_vertices && required() > available) {
+        option.packed_vertices = true;
+        fmt::print(stderr,
+                   "VulkanRenderer: Not enough device memory, using packed "
+                   "vertices\n");
+    }
+    auto max_size = MAX_TEXTURE_SIZE;
+    while (max_size > MIN_DEGRADED_TEXTURE_SIZE && required() > available) {
+        max_size /= 2;
+        _tex_manager.setMaxTextureSize(max_size);
+    }
+    if (_tex_manager.getMaxTextureSize()) {
+        fmt::print(stderr,
+                   "VulkanRenderer: Not enough device memory, textures "
+                   "limited to {}px\n",
+                   max_size);
+    }
 }
+
 void
 VulkanRenderer::_emit_model_ui_cmds(uint32_t img_index,
-                                    glm::mat4 const &view_proj_mat)
+                                    glm::mat4 const &view_proj_mat,
+                                    glm::mat4 const &proj_mat,
+                                    glm::vec3 const &camera_pos)
 {
-    // Update view_proj matrix
-    copyOnCpuCoherentMemory(_vk_instance.device,
-                            _system_uniform_memory,
-                            img_index * sizeof(SystemUbo) +
-                              offsetof(SystemUbo, view_proj),
-                            sizeof(glm::mat4),
-                            &view_proj_mat);
+    // System uniform lives in the frame allocator
+    SystemUbo system_ubo{};
+    system_ubo.view_proj = view_proj_mat;
+    auto system_ubo_alloc =
+      _frame_allocator.push(&system_ubo, sizeof(SystemUbo));
+
+    // Update lod of each instance
+    auto &pipeline = *_model.pipeline;
+    pipeline.updateLodSelection(
+      img_index,
+      camera_pos,
+      proj_mat[1][1] * _swap_chain.swapChainExtent.height * 0.5f);
+    pipeline.updateClusterCulling(img_index, view_proj_mat, camera_pos);
+    pipeline.updateDrawCommands(_frame_allocator);
+
+    // Texture levels streamed in since last use of this image. Command
+    // buffer is recorded every frame for the system uniform offset.
+    _tex_manager.updateStreaming();
+    pipeline.updateTextureDescriptors(img_index);
+    _record_model_command_buffer(img_index, system_ubo_alloc.offset);
+
+    // Instance uploads staged since last frame are copied first, the
+    // frame fence tells when their staging memory is reusable
+    std::array<VkCommandBuffer, 2> cmd_buffers = {
+        _staging_ring.flush(_sync.currentFrame,
+                            _sync.inflightFence[_sync.currentFrame]),
+        _model_command_buffers[img_index],
+    };
+    uint32_t first_cmd_buffer = (cmd_buffers[0]) ? 0 : 1;
 
     // Send Model rendering
     VkSemaphore finish_model_sig_sems[] = {
@@ -318,8 +620,8 @@ VulkanRenderer::_emit_model_ui_cmds(uint32_t img_index,
     submit_info.waitSemaphoreCount = 0;
     submit_info.pSignalSemaphores = finish_model_sig_sems;
     submit_info.signalSemaphoreCount = 1;
-    submit_info.pCommandBuffers = &_model_command_buffers[img_index];
-    submit_info.commandBufferCount = 1;
+    submit_info.pCommandBuffers = cmd_buffers.data() + first_cmd_buffer;
+    submit_info.commandBufferCount = cmd_buffers.size() - first_cmd_buffer;
     if (vkQueueSubmit(
           _vk_instance.graphicQueue, 1, &submit_info, VK_NULL_HANDLE) !=
         VK_SUCCESS) {
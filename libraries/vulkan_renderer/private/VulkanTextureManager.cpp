@@ -3,67 +3,100 @@
 #include <stdexcept>
 #include <cmath>
 #include <cstring>
+#include <algorithm>
 
 #include "VulkanImage.hpp"
 #include "VulkanMemory.hpp"
+#include "VulkanPhysicalDevice.hpp"
+#include "VulkanTextureCache.hpp"
+#include "ParallelFor.hpp"
 
 void
-VulkanTextureManager::init(VulkanInstance const &vkInstance)
+VulkanTextureManager::init(VulkanInstance const &vkInstance,
+                           VulkanMemoryAllocator &allocator,
+                           VkDeviceSize memoryBudget)
 {
     _device = vkInstance.device;
     _physical_device = vkInstance.physicalDevice;
+    _allocator = &allocator;
     _gfx_queue = vkInstance.graphicQueue;
     _command_pool = vkInstance.modelCommandPool;
+    _memory_budget = memoryBudget;
+    _compression_supported =
+      vkInstance.enabledFeatures.textureCompressionBC &&
+      getLinearBlittingSupport(_physical_device,
+                               VK_FORMAT_BC1_RGB_SRGB_BLOCK) &&
+      getLinearBlittingSupport(_physical_device, VK_FORMAT_BC3_SRGB_BLOCK);
+    _streaming_budget = DEFAULT_STREAMING_BUDGET;
+
+    VkPhysicalDeviceProperties properties{};
+    vkGetPhysicalDeviceProperties(_physical_device, &properties);
+    _max_sampler_anisotropy =
+      std::min(properties.limits.maxSamplerAnisotropy, 16.0f);
+
+    _upload_batch.init(
+      _physical_device, _device, *_allocator, _command_pool, _gfx_queue);
+    _stream_batch.init(
+      _physical_device, _device, *_allocator, _command_pool, _gfx_queue);
     _load_default_texture();
 }
 
 void
 VulkanTextureManager::clear()
 {
+    _upload_batch.clear();
+    _stream_batch.clear();
+    _streamed_textures.clear();
     for (auto &it : _textures) {
-        vkDestroySampler(_device, it.second.texture_sampler, nullptr);
-        vkDestroyImageView(_device, it.second.texture_img_view, nullptr);
-        vkDestroyImage(_device, it.second.texture_img, nullptr);
-        vkFreeMemory(_device, it.second.texture_img_memory, nullptr);
+        _destroy_texture(it.second);
     }
     _textures.clear();
+    _lru.clear();
+    for (auto &it : _samplers) {
+        vkDestroySampler(_device, it.sampler, nullptr);
+    }
+    _samplers.clear();
+    _max_sampler_anisotropy = 0.0f;
     _device = nullptr;
     _physical_device = nullptr;
+    _allocator = nullptr;
     _gfx_queue = nullptr;
     _command_pool = nullptr;
+    _memory_budget = 0;
+    _used_memory = 0;
+    _max_texture_size = 0;
+    _compression_supported = false;
+    _streaming_budget = 0;
+    _streaming_version = 0;
 }
 
 void
 VulkanTextureManager::loadTexture(std::string const &texturePath)
+{
+    loadAndGetTexture(texturePath);
+}
+
+void
+VulkanTextureManager::releaseTexture(std::string const &texturePath)
 {
     auto existing_tex = _textures.find(texturePath);
-    if (existing_tex != _textures.end()) {
-        return;
+    if (existing_tex != _textures.end() && existing_tex->second.nb_refs) {
+        --existing_tex->second.nb_refs;
     }
-
-    Texture tex{};
-
-    tex.texture_img = _create_texture_image(texturePath,
-                                            tex.texture_img_memory,
-                                            tex.width,
-                                            tex.height,
-                                            tex.mip_level);
-    tex.texture_img_view =
-      _create_texture_image_view(tex.texture_img, tex.mip_level);
-    tex.texture_sampler = _create_texture_sampler(tex.mip_level);
-    _textures.emplace(texturePath, tex);
 }
 
 void
 VulkanTextureManager::unloadAllTextures()
 {
+    _upload_batch.wait();
+    _stream_batch.wait();
+    _streamed_textures.clear();
     for (auto &it : _textures) {
-        vkDestroySampler(_device, it.second.texture_sampler, nullptr);
-        vkDestroyImageView(_device, it.second.texture_img_view, nullptr);
-        vkDestroyImage(_device, it.second.texture_img, nullptr);
-        vkFreeMemory(_device, it.second.texture_img_memory, nullptr);
+        _destroy_texture(it.second);
     }
     _textures.clear();
+    _lru.clear();
+    _used_memory = 0;
     _load_default_texture();
 }
 
@@ -72,7 +105,7 @@ VulkanTextureManager::getTexture(std::string const &texturePath, Texture &tex)
 {
     auto existing_tex = _textures.find(texturePath);
     if (existing_tex != _textures.end()) {
-        tex = existing_tex->second;
+        tex = existing_tex->second.tex;
         return (false);
     }
     return (true);
@@ -81,208 +114,700 @@ VulkanTextureManager::getTexture(std::string const &texturePath, Texture &tex)
 Texture
 VulkanTextureManager::loadAndGetTexture(std::string const &texturePath)
 {
-    auto existing_tex = _textures.find(texturePath);
+    auto existing_tex = _find_texture(texturePath);
     if (existing_tex != _textures.end()) {
-        return (existing_tex->second);
+        _acquire_texture(existing_tex->second);
+        return (existing_tex->second.tex);
+    }
+
+    DecodedTexture decoded;
+    _decode_texture(
+      texturePath, _compression_supported, _max_texture_size, decoded);
+    _insert_decoded_texture(texturePath, decoded, 1);
+    _upload_batch.submit();
+    return (_textures.at(texturePath).tex);
+}
+
+void
+VulkanTextureManager::loadTextures(
+  std::vector<std::string> const &texturePaths)
+{
+    auto to_load = _acquire_cached_textures(texturePaths);
+
+    try {
+        auto chunk_size = static_cast<size_t>(getNbWorkerThreads());
+        std::vector<DecodedTexture> decoded(
+          std::min(chunk_size, to_load.size()));
+        for (size_t i = 0; i < to_load.size(); i += chunk_size) {
+            auto nb_decoded = std::min(chunk_size, to_load.size() - i);
+
+            parallelFor(nb_decoded, [&](size_t j) -> void {
+                _decode_texture(to_load[i + j],
+                                _compression_supported,
+                                _max_texture_size,
+                                decoded[j]);
+            });
+            // Vulkan queue and command pool are used from this thread only
+            for (size_t j = 0; j < nb_decoded; ++j) {
+                auto nb_refs = static_cast<uint32_t>(std::count(
+                  texturePaths.begin(), texturePaths.end(), to_load[i + j]));
+                _insert_decoded_texture(to_load[i + j], decoded[j], nb_refs);
+            }
+            // One submission per chunk bounds the staging memory
+            _upload_batch.submit();
+        }
+    } catch (...) {
+        // Recorded uploads are flushed before any texture can be evicted
+        _upload_batch.submit();
+        // Giving back every reference taken by this call
+        for (auto const &it : texturePaths) {
+            releaseTexture(it);
+        }
+        throw;
+    }
+}
+
+void
+VulkanTextureManager::decodeTextures(
+  std::vector<std::string> const &texturePaths,
+  bool compress,
+  std::atomic<bool> const &cancel,
+  DecodedTextures &decoded)
+{
+    decoded.paths.clear();
+    for (auto const &it : texturePaths) {
+        if (std::find(decoded.paths.begin(), decoded.paths.end(), it) ==
+            decoded.paths.end()) {
+            decoded.paths.emplace_back(it);
+        }
+    }
+    decoded.textures.clear();
+    decoded.textures.resize(decoded.paths.size());
+    parallelFor(decoded.paths.size(), [&](size_t i) -> void {
+        if (!cancel) {
+            _decode_texture(decoded.paths[i], compress, 0, decoded.textures[i]);
+        }
+    });
+}
+
+void
+VulkanTextureManager::loadDecodedTextures(
+  std::vector<std::string> const &texturePaths,
+  DecodedTextures &decoded)
+{
+    auto to_load = _acquire_cached_textures(texturePaths);
+
+    try {
+        for (auto const &it : to_load) {
+            auto nb_refs = static_cast<uint32_t>(
+              std::count(texturePaths.begin(), texturePaths.end(), it));
+            auto decoded_it =
+              std::find(decoded.paths.begin(), decoded.paths.end(), it);
+            if (decoded_it == decoded.paths.end()) {
+                DecodedTexture texture;
+                _decode_texture(
+                  it, _compression_supported, _max_texture_size, texture);
+                _insert_decoded_texture(it, texture, nb_refs);
+                continue;
+            }
+
+            // Decoded at full size, reduced now that the limit is known
+            auto &texture =
+              decoded.textures[decoded_it - decoded.paths.begin()];
+            _drop_top_levels(texture, _max_texture_size);
+            _insert_decoded_texture(it, texture, nb_refs);
+            texture = {};
+        }
+        _upload_batch.submitAsync();
+    } catch (...) {
+        // Recorded uploads are flushed before any texture can be evicted
+        _upload_batch.submit();
+        // Giving back every reference taken by this call
+        for (auto const &it : texturePaths) {
+            releaseTexture(it);
+        }
+        throw;
+    }
+}
+
+bool
+VulkanTextureManager::pollUploads()
+{
+    return (_upload_batch.poll());
+}
+
+bool
+VulkanTextureManager::isCompressionSupported() const
+{
+    return (_compression_supported);
+}
+
+void
+VulkanTextureManager::setMemoryBudget(VkDeviceSize memoryBudget)
+{
+    _memory_budget = memoryBudget;
+    _evict_unused_textures(0);
+}
+
+VkDeviceSize
+VulkanTextureManager::getMemoryBudget() const
+{
+    return (_memory_budget);
+}
+
+VkDeviceSize
+VulkanTextureManager::getUsedMemory() const
+{
+    return (_used_memory);
+}
+
+void
+VulkanTextureManager::releaseUnusedTextures()
+{
+    // In flight uploads and streamed levels may target a destroyed image
+    _upload_batch.wait();
+    _stream_batch.wait();
+    _finish_streamed_levels();
+
+    auto it = _lru.begin();
+    while (it != _lru.end()) {
+        auto &entry = _textures.at(*it);
+        if (entry.nb_refs || entry.pinned) {
+            ++it;
+            continue;
+        }
+        _used_memory -= entry.tex.memory_size;
+        _destroy_texture(entry);
+        _textures.erase(*it);
+        it = _lru.erase(it);
+    }
+}
+
+void
+VulkanTextureManager::setMaxTextureSize(uint32_t maxSize)
+{
+    _max_texture_size = maxSize;
+}
+
+uint32_t
+VulkanTextureManager::getMaxTextureSize() const
+{
+    return (_max_texture_size);
+}
+
+VkDeviceSize
+VulkanTextureManager::estimateTexturesMemory(
+  std::vector<std::string> const &texturePaths,
+  uint32_t maxSize) const
+{
+    // BC1 and BC3 are at most 1 byte per texel, mip chain adds a third
+    VkDeviceSize texel_size = (_compression_supported) ? 1 : 4;
+
+    std::vector<std::string> counted;
+    VkDeviceSize total{};
+    for (auto const &it : texturePaths) {
+        auto existing_tex = _textures.find(it);
+        if ((existing_tex != _textures.end() &&
+             (existing_tex->second.nb_refs ||
+              !_is_reduced(existing_tex->second))) ||
+            std::find(counted.begin(), counted.end(), it) != counted.end()) {
+            continue;
+        }
+        counted.emplace_back(it);
+
+        int width;
+        int height;
+        if (!getImageSize(it, width, height)) {
+            continue;
+        }
+        while (maxSize && static_cast<uint32_t>(std::max(width, height)) >
+                            maxSize) {
+            width = std::max(width / 2, 1);
+            height = std::max(height / 2, 1);
+        }
+        total += static_cast<VkDeviceSize>(width) * height * texel_size * 4 / 3;
+    }
+    return (total);
+}
+
+void
+VulkanTextureManager::updateStreaming()
+{
+    if (!_stream_batch.poll()) {
+        return;
     }
+    _finish_streamed_levels();
+
+    // Only textures in use are refined
+    std::vector<decltype(_textures)::iterator> to_stream;
+    for (auto it = _textures.begin(); it != _textures.end(); ++it) {
+        if (it->second.tex.min_level && it->second.nb_refs) {
+            to_stream.emplace_back(it);
+        }
+    }
+    std::sort(to_stream.begin(),
+              to_stream.end(),
+              [](auto const &a, auto const &b) -> bool {
+                  return (a->second.tex.min_level > b->second.tex.min_level);
+              });
+
+    // At least one level per call, even when bigger than the budget
+    VkDeviceSize streamed_size = 0;
+    for (auto &it : to_stream) {
+        auto &entry = it->second;
+        auto level = entry.tex.min_level - 1;
+        auto size = entry.pending.level_sizes[level];
 
+        if (streamed_size && streamed_size + size > _streaming_budget) {
+            break;
+        }
+        _stream_batch.uploadImageLevel(
+          entry.tex.texture_img,
+          entry.pending.format,
+          entry.pending.data.data() + entry.pending.level_offsets[level],
+          size,
+          entry.tex.width,
+          entry.tex.height,
+          level);
+        _streamed_textures.emplace_back(it->first);
+        streamed_size += size;
+    }
+
+    try {
+        _stream_batch.submitAsync();
+    } catch (...) {
+        _streamed_textures.clear();
+        throw;
+    }
+}
+
+void
+VulkanTextureManager::setStreamingBudget(VkDeviceSize frameBudget)
+{
+    _streaming_budget = frameBudget;
+}
+
+VkDeviceSize
+VulkanTextureManager::getStreamingBudget() const
+{
+    return (_streaming_budget);
+}
+
+uint64_t
+VulkanTextureManager::getStreamingVersion() const
+{
+    return (_streaming_version);
+}
+
+void
+VulkanTextureManager::_decode_texture(std::string const &texturePath,
+                                      bool compress,
+                                      uint32_t max_size,
+                                      DecodedTexture &decoded)
+{
+    decoded.image.reset();
+    decoded.pixels.clear();
+    decoded.max_size = 0;
+    decoded.compressed = {};
+    if (!compress) {
+        decoded.image = decodeImage(texturePath, decoded.width, decoded.height);
+        _drop_top_levels(decoded, max_size);
+        return;
+    }
+
+    // Compressed once, then read back from the cache next to the source
+    if (!textureCacheLoad(texturePath, false, decoded.compressed)) {
+        auto image = decodeImage(texturePath, decoded.width, decoded.height);
+        compressTexture(
+          std::span<uint8_t const>(image.get(),
+                                   static_cast<size_t>(decoded.width) *
+                                     decoded.height * 4),
+          decoded.width,
+          decoded.height,
+          false,
+          decoded.compressed);
+        textureCacheWrite(texturePath, false, decoded.compressed);
+    }
+    decoded.width = decoded.compressed.width;
+    decoded.height = decoded.compressed.height;
+    _drop_top_levels(decoded, max_size);
+}
+
+void
+VulkanTextureManager::_drop_top_levels(DecodedTexture &decoded,
+                                       uint32_t max_size)
+{
+    auto too_big = [&]() -> bool {
+        return (max_size && static_cast<uint32_t>(std::max(
+                              decoded.width, decoded.height)) > max_size);
+    };
+    if (too_big()) {
+        decoded.max_size = max_size;
+    }
+
+    // Compressed mip chain is complete, top levels are skipped
+    auto &compressed = decoded.compressed;
+    if (!compressed.data.empty()) {
+        uint32_t nb_dropped = 0;
+        while (too_big() && compressed.level_offsets.size() - nb_dropped > 1) {
+            decoded.width = std::max(decoded.width / 2, 1);
+            decoded.height = std::max(decoded.height / 2, 1);
+            ++nb_dropped;
+        }
+        compressed.level_offsets.erase(compressed.level_offsets.begin(),
+                                       compressed.level_offsets.begin() +
+                                         nb_dropped);
+        compressed.level_sizes.erase(compressed.level_sizes.begin(),
+                                     compressed.level_sizes.begin() +
+                                       nb_dropped);
+        compressed.width = decoded.width;
+        compressed.height = decoded.height;
+        return;
+    }
+
+    // Pixels are downscaled the way mips are built
+    std::vector<uint8_t> level;
+    while (too_big() && (decoded.width > 1 || decoded.height > 1)) {
+        buildTextureMip(
+          _get_pixels(decoded), decoded.width, decoded.height, true, level);
+        decoded.width = std::max(decoded.width / 2, 1);
+        decoded.height = std::max(decoded.height / 2, 1);
+        decoded.image.reset();
+        decoded.pixels.swap(level);
+    }
+}
+
+std::span<uint8_t const>
+VulkanTextureManager::_get_pixels(DecodedTexture const &decoded)
+{
+    if (decoded.image) {
+        return (std::span<uint8_t const>(
+          decoded.image.get(),
+          static_cast<size_t>(decoded.width) * decoded.height * 4));
+    }
+    return (decoded.pixels);
+}
+
+Texture
+VulkanTextureManager::_create_texture(DecodedTexture const &decoded)
+{
     Texture tex{};
+    auto format = VK_FORMAT_R8G8B8A8_SRGB;
 
-    tex.texture_img = _create_texture_image(texturePath,
-                                            tex.texture_img_memory,
-                                            tex.width,
-                                            tex.height,
-                                            tex.mip_level);
+    tex.width = decoded.width;
+    tex.height = decoded.height;
+    if (decoded.compressed.data.empty()) {
+        tex.texture_img = _create_texture_image(
+          decoded, tex.texture_img_allocation, tex.mip_level);
+    } else {
+        format = decoded.compressed.format;
+        tex.texture_img =
+          _create_compressed_texture_image(decoded.compressed,
+                                           tex.texture_img_allocation,
+                                           tex.mip_level,
+                                           tex.min_level);
+    }
     tex.texture_img_view =
-      _create_texture_image_view(tex.texture_img, tex.mip_level);
-    tex.texture_sampler = _create_texture_sampler(tex.mip_level);
-    _textures.emplace(texturePath, tex);
+      _create_texture_image_view(tex.texture_img, format, tex.mip_level);
+    tex.texture_sampler = _get_texture_sampler(tex.min_level);
+    tex.memory_size = tex.texture_img_allocation.size;
     return (tex);
 }
 
+void
+VulkanTextureManager::_destroy_texture(TextureEntry &entry)
+{
+    vkDestroyImageView(_device, entry.tex.texture_img_view, nullptr);
+    vkDestroyImage(_device, entry.tex.texture_img, nullptr);
+    _allocator->free(entry.tex.texture_img_allocation);
+}
+
+VulkanTextureManager::TextureEntry &
+VulkanTextureManager::_insert_texture(std::string const &texturePath,
+                                      Texture const &tex,
+                                      uint32_t nbRefs)
+{
+    _evict_unused_textures(tex.memory_size);
+
+    _lru.emplace_front(texturePath);
+    TextureEntry entry{};
+    entry.tex = tex;
+    entry.nb_refs = nbRefs;
+    entry.lru_it = _lru.begin();
+    _used_memory += tex.memory_size;
+    return (_textures.emplace(texturePath, entry).first->second);
+}
+
+void
+VulkanTextureManager::_insert_decoded_texture(std::string const &texturePath,
+                                              DecodedTexture &decoded,
+                                              uint32_t nbRefs)
+{
+    auto tex = _create_texture(decoded);
+    auto &entry = _insert_texture(texturePath, tex, nbRefs);
+    entry.max_size = decoded.max_size;
+
+    // Levels not uploaded yet are streamed from the decoded mip chain
+    if (tex.min_level) {
+        entry.pending = std::move(decoded.compressed);
+    }
+}
+
+void
+VulkanTextureManager::_acquire_texture(TextureEntry &entry)
+{
+    ++entry.nb_refs;
+    _lru.splice(_lru.begin(), _lru, entry.lru_it);
+}
+
+std::vector<std::string>
+VulkanTextureManager::_acquire_cached_textures(
+  std::vector<std::string> const &texturePaths)
+{
+    // Referencing cached textures first so they can't be evicted
+    std::vector<std::string> to_load;
+    for (auto const &it : texturePaths) {
+        auto existing_tex = _find_texture(it);
+        if (existing_tex != _textures.end()) {
+            _acquire_texture(existing_tex->second);
+        } else if (std::find(to_load.begin(), to_load.end(), it) ==
+                   to_load.end()) {
+            to_load.emplace_back(it);
+        }
+    }
+    return (to_load);
+}
+
+bool
+VulkanTextureManager::_is_reduced(TextureEntry const &entry) const
+{
+    return (entry.max_size &&
+            (!_max_texture_size || _max_texture_size > entry.max_size));
+}
+
+std::unordered_map<std::string,
+                   VulkanTextureManager::TextureEntry>::iterator
+VulkanTextureManager::_find_texture(std::string const &texturePath)
+{
+    auto existing_tex = _textures.find(texturePath);
+    if (existing_tex == _textures.end() || existing_tex->second.nb_refs ||
+        !_is_reduced(existing_tex->second)) {
+        return (existing_tex);
+    }
+
+    // In flight uploads and streamed levels may target the destroyed
+    // image
+    _upload_batch.wait();
+    _stream_batch.wait();
+    _finish_streamed_levels();
+    _used_memory -= existing_tex->second.tex.memory_size;
+    _destroy_texture(existing_tex->second);
+    _lru.erase(existing_tex->second.lru_it);
+    _textures.erase(existing_tex);
+    return (_textures.end());
+}
+
+void
+VulkanTextureManager::_evict_unused_textures(VkDeviceSize requiredSize)
+{
+    if (_used_memory + requiredSize <= _memory_budget) {
+        return;
+    }
+    // In flight uploads and streamed levels may target an evicted image
+    _upload_batch.wait();
+    _stream_batch.wait();
+    _finish_streamed_levels();
+
+    // Referenced textures are kept even when over budget
+    auto it = _lru.end();
+    while (it != _lru.begin() &&
+           _used_memory + requiredSize > _memory_budget) {
+        --it;
+        auto &entry = _textures.at(*it);
+        if (entry.nb_refs || entry.pinned) {
+            continue;
+        }
+        _used_memory -= entry.tex.memory_size;
+        _destroy_texture(entry);
+        _textures.erase(*it);
+        it = _lru.erase(it);
+    }
+}
+
 VkImage
-VulkanTextureManager::_create_texture_image(std::string const &texturePath,
-                                            VkDeviceMemory &texture_img_memory,
-                                            int32_t &tex_img_w,
-                                            int32_t &tex_img_h,
-                                            uint32_t &mip_level)
-{
-    VkBuffer staging_buffer{};
-    VkDeviceMemory staging_buffer_memory{};
-
-    loadTextureInBuffer(_physical_device,
-                        _device,
-                        texturePath,
-                        staging_buffer,
-                        staging_buffer_memory,
-                        tex_img_w,
-                        tex_img_h);
-    mip_level = static_cast<uint32_t>(
-                  std::floor(std::log2(std::max(tex_img_w, tex_img_h)))) +
-                1;
+VulkanTextureManager::_create_texture_image(
+  DecodedTexture const &decoded,
+  VulkanAllocation &texture_img_allocation,
+  uint32_t &mip_level)
+{
+    mip_level = getTextureMipLevels(decoded.width, decoded.height);
     auto tex_img = createImage(_device,
-                               tex_img_w,
-                               tex_img_h,
+                               decoded.width,
+                               decoded.height,
                                mip_level,
                                VK_FORMAT_R8G8B8A8_SRGB,
                                VK_IMAGE_TILING_OPTIMAL,
                                VK_IMAGE_USAGE_TRANSFER_SRC_BIT |
                                  VK_IMAGE_USAGE_TRANSFER_DST_BIT |
                                  VK_IMAGE_USAGE_SAMPLED_BIT);
-    allocateImage(_physical_device,
-                  _device,
-                  tex_img,
-                  texture_img_memory,
-                  VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
-    transitionImageLayout(_device,
-                          _command_pool,
-                          _gfx_queue,
-                          tex_img,
-                          VK_FORMAT_R8G8B8A8_SRGB,
-                          mip_level,
-                          VK_IMAGE_LAYOUT_UNDEFINED,
-                          VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL);
-    copyBufferToImage(_device,
-                      _command_pool,
-                      _gfx_queue,
-                      staging_buffer,
-                      tex_img,
-                      tex_img_w,
-                      tex_img_h);
-
-    vkDestroyBuffer(_device, staging_buffer, nullptr);
-    vkFreeMemory(_device, staging_buffer_memory, nullptr);
-
-    generateMipmaps(_physical_device,
-                    _device,
-                    _command_pool,
-                    _gfx_queue,
-                    tex_img,
-                    VK_FORMAT_R8G8B8A8_SRGB,
-                    tex_img_w,
-                    tex_img_h,
-                    mip_level);
+    texture_img_allocation =
+      _allocator->allocateImage(tex_img, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+    // Level 0 only, mips are blitted
+    auto pixels = _get_pixels(decoded);
+    _upload_batch.uploadImage(tex_img,
+                              VK_FORMAT_R8G8B8A8_SRGB,
+                              pixels.data(),
+                              pixels.size(),
+                              decoded.width,
+                              decoded.height,
+                              mip_level,
+                              { 0 });
+    return (tex_img);
+}
+
+VkImage
+VulkanTextureManager::_create_compressed_texture_image(
+  CompressedTexture const &compressed,
+  VulkanAllocation &texture_img_allocation,
+  uint32_t &mip_level,
+  uint32_t &min_level)
+{
+    mip_level = compressed.level_offsets.size();
+    min_level = 0;
+    while (min_level + 1 < mip_level &&
+           std::max(compressed.width, compressed.height) >> min_level >
+             STREAMING_RESIDENT_SIZE) {
+        ++min_level;
+    }
 
+    auto tex_img =
+      createImage(_device,
+                  compressed.width,
+                  compressed.height,
+                  mip_level,
+                  compressed.format,
+                  VK_IMAGE_TILING_OPTIMAL,
+                  VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT);
+    texture_img_allocation =
+      _allocator->allocateImage(tex_img, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+    // Small levels only, no blitting, the others are streamed
+    auto data_offset = compressed.level_offsets[min_level];
+    std::vector<VkDeviceSize> level_offsets(
+      compressed.level_offsets.begin() + min_level,
+      compressed.level_offsets.end());
+    for (auto &it : level_offsets) {
+        it -= data_offset;
+    }
+    _upload_batch.uploadImage(tex_img,
+                              compressed.format,
+                              compressed.data.data() + data_offset,
+                              compressed.data.size() - data_offset,
+                              compressed.width,
+                              compressed.height,
+                              mip_level,
+                              level_offsets,
+                              min_level);
     return (tex_img);
 }
 
 VkImageView
 VulkanTextureManager::_create_texture_image_view(VkImage texture_img,
+                                                 VkFormat format,
                                                  uint32_t mip_level)
 {
     return (createImageView(texture_img,
-                            VK_FORMAT_R8G8B8A8_SRGB,
+                            format,
                             mip_level,
                             _device,
                             VK_IMAGE_ASPECT_COLOR_BIT));
 }
 
+void
+VulkanTextureManager::_load_default_texture()
+{
+    DecodedTexture decoded;
+    decoded.pixels = { 255, 255, 255, 255 };
+    decoded.width = 1;
+    decoded.height = 1;
+
+    _insert_decoded_texture(SCOP_DEFAULT_TEXTURE, decoded, 0);
+    _upload_batch.submit();
+    _textures.at(SCOP_DEFAULT_TEXTURE).pinned = true;
+}
+
+void
+VulkanTextureManager::_finish_streamed_levels()
+{
+    for (auto const &it : _streamed_textures) {
+        auto entry = _textures.find(it);
+        if (entry == _textures.end()) {
+            continue;
+        }
+
+        auto &tex = entry->second.tex;
+        --tex.min_level;
+        tex.texture_sampler = _get_texture_sampler(tex.min_level);
+        if (!tex.min_level) {
+            entry->second.pending = {};
+        }
+    }
+    if (!_streamed_textures.empty()) {
+        ++_streaming_version;
+        _streamed_textures.clear();
+    }
+}
+
 VkSampler
-VulkanTextureManager::_create_texture_sampler(uint32_t mip_level)
+VulkanTextureManager::_get_texture_sampler(uint32_t min_level)
 {
-    VkPhysicalDeviceProperties properties{};
-    vkGetPhysicalDeviceProperties(_physical_device, &properties);
-    float aniso = (properties.limits.maxSamplerAnisotropy > 16.0f)
-                    ? 16.0f
-                    : properties.limits.maxSamplerAnisotropy;
+    SamplerKey key{};
+    key.filter = VK_FILTER_LINEAR;
+    key.mipmap_mode = VK_SAMPLER_MIPMAP_MODE_LINEAR;
+    key.address_mode = VK_SAMPLER_ADDRESS_MODE_REPEAT;
+    key.mip_lod_bias = 0.0f;
+    key.max_anisotropy = _max_sampler_anisotropy;
+    key.min_lod = static_cast<float>(min_level);
+    key.max_lod = VK_LOD_CLAMP_NONE;
+    return (_get_sampler(key));
+}
+
+VkSampler
+VulkanTextureManager::_get_sampler(SamplerKey const &key)
+{
+    auto existing_sampler = std::find_if(
+      _samplers.begin(), _samplers.end(), [&key](Sampler const &it) -> bool {
+          return (it.key == key);
+      });
+    if (existing_sampler != _samplers.end()) {
+        return (existing_sampler->sampler);
+    }
 
     VkSamplerCreateInfo sampler_info{};
     sampler_info.sType = VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO;
-    sampler_info.magFilter = VK_FILTER_LINEAR;
-    sampler_info.minFilter = VK_FILTER_LINEAR;
-    sampler_info.addressModeU = VK_SAMPLER_ADDRESS_MODE_REPEAT;
-    sampler_info.addressModeV = VK_SAMPLER_ADDRESS_MODE_REPEAT;
-    sampler_info.addressModeW = VK_SAMPLER_ADDRESS_MODE_REPEAT;
-    sampler_info.anisotropyEnable = VK_TRUE;
-    sampler_info.maxAnisotropy = aniso;
+    sampler_info.magFilter = key.filter;
+    sampler_info.minFilter = key.filter;
+    sampler_info.addressModeU = key.address_mode;
+    sampler_info.addressModeV = key.address_mode;
+    sampler_info.addressModeW = key.address_mode;
+    sampler_info.anisotropyEnable = key.max_anisotropy > 1.0f;
+    sampler_info.maxAnisotropy = key.max_anisotropy;
     sampler_info.borderColor = VK_BORDER_COLOR_INT_OPAQUE_BLACK;
     sampler_info.unnormalizedCoordinates = VK_FALSE;
     sampler_info.compareEnable = VK_FALSE;
     sampler_info.compareOp = VK_COMPARE_OP_ALWAYS;
-    sampler_info.mipmapMode = VK_SAMPLER_MIPMAP_MODE_LINEAR;
-    sampler_info.mipLodBias = 0.0f;
-    sampler_info.minLod = 0.0f;
-    sampler_info.maxLod = static_cast<float>(mip_level);
+    sampler_info.mipmapMode = key.mipmap_mode;
+    sampler_info.mipLodBias = key.mip_lod_bias;
+    sampler_info.minLod = key.min_lod;
+    sampler_info.maxLod = key.max_lod;
 
-    VkSampler texture_sampler;
-    if (vkCreateSampler(_device, &sampler_info, nullptr, &texture_sampler) !=
+    Sampler new_sampler{};
+    new_sampler.key = key;
+    if (vkCreateSampler(
+          _device, &sampler_info, nullptr, &new_sampler.sampler) !=
         VK_SUCCESS) {
         throw std::runtime_error(
           "VkTextureManager: failed to create texture sampler");
     }
-    return (texture_sampler);
+    _samplers.emplace_back(new_sampler);
+    return (new_sampler.sampler);
 }
-
-void
-VulkanTextureManager::_load_default_texture()
-{
-    static uint8_t const white_tex[4] = { 255, 255, 255, 255 };
-    Texture tex{
-        nullptr, nullptr, nullptr, nullptr, 1, 1, 1,
-    };
-
-    // Staging buffer
-    VkBuffer staging_buffer{};
-    VkDeviceMemory staging_buffer_memory{};
-    createBuffer(_device, staging_buffer, 4, VK_BUFFER_USAGE_TRANSFER_SRC_BIT);
-    allocateBuffer(_physical_device,
-                   _device,
-                   staging_buffer,
-                   staging_buffer_memory,
-                   VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT |
-                     VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
-    void *data;
-    vkMapMemory(_device, staging_buffer_memory, 0, 4, 0, &data);
-    memcpy(data, white_tex, 4);
-    vkUnmapMemory(_device, staging_buffer_memory);
-
-    // Texture
-    tex.texture_img = createImage(_device,
-                                  tex.width,
-                                  tex.height,
-                                  tex.mip_level,
-                                  VK_FORMAT_R8G8B8A8_SRGB,
-                                  VK_IMAGE_TILING_OPTIMAL,
-                                  VK_IMAGE_USAGE_TRANSFER_SRC_BIT |
-                                    VK_IMAGE_USAGE_TRANSFER_DST_BIT |
-                                    VK_IMAGE_USAGE_SAMPLED_BIT);
-    allocateImage(_physical_device,
-                  _device,
-                  tex.texture_img,
-                  tex.texture_img_memory,
-                  VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
-    transitionImageLayout(_device,
-                          _command_pool,
-                          _gfx_queue,
-                          tex.texture_img,
-                          VK_FORMAT_R8G8B8A8_SRGB,
-                          1,
-                          VK_IMAGE_LAYOUT_UNDEFINED,
-                          VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL);
-    copyBufferToImage(_device,
-                      _command_pool,
-                      _gfx_queue,
-                      staging_buffer,
-                      tex.texture_img,
-                      1,
-                      1);
-
-    vkDestroyBuffer(_device, staging_buffer, nullptr);
-    vkFreeMemory(_device, staging_buffer_memory, nullptr);
-
-    tex.texture_img_view =
-      _create_texture_image_view(tex.texture_img, tex.mip_level);
-    tex.texture_sampler = _create_texture_sampler(tex.mip_level);
-
-    generateMipmaps(_physical_device,
-                    _device,
-                    _command_pool,
-                    _gfx_queue,
-                    tex.texture_img,
-                    VK_FORMAT_R8G8B8A8_SRGB,
-                    tex.width,
-                    tex.height,
-                    tex.mip_level);
-
-    _textures.emplace(SCOP_DEFAULT_TEXTURE, tex);
-}
\ No newline at end of file
@@ -13,4 +13,56 @@ struct ModelPipelineUbo final
     alignas(16) float shininess{};
 };
 
+// Push constant of model_packed.vert
+struct ModelPipelineMeshBounds final
+{
+    alignas(16) glm::vec3 min_point{};
+    alignas(16) glm::vec3 extent{};
+};
+
+// Storage buffer entry of bindless shaders, std430 layout, one per draw.
+// Mesh bounds are only read by model_packed_bindless.vert.
+struct ModelPipelineMaterial final
+{
+    alignas(16) glm::vec3 diffuse_color{};
+    alignas(4) uint32_t texture_index{};
+    alignas(16) glm::vec3 min_point{};
+    alignas(16) glm::vec3 extent{};
+};
+
+// Push constant of bindless vertex shaders, material of a draw is at
+// first_draw + gl_DrawID
+struct ModelPipelineDrawOffset final
+{
+    alignas(4) uint32_t first_draw{};
+};
+
+// Per swapchain image ubo of model_cull.comp
+struct ModelPipelineCullUbo final
+{
+    alignas(16) glm::vec4 frustum_planes[6]{};
+    alignas(16) glm::vec3 camera_pos{};
+    alignas(4) uint32_t nb_clusters{};
+    alignas(4) uint32_t nb_instances{};
+    alignas(4) uint32_t backface_culling{};
+};
+
+// Push constant of model_cull.comp
+struct ModelPipelineCullDispatch final
+{
+    alignas(4) uint32_t first_cluster{};
+    alignas(4) uint32_t first_instance{};
+};
+
+// Per mesh entry of model_cull.comp, std430 layout. draw_count is the
+// count buffer of the mesh draws and stops at max_draws, needed_draws
+// counts every visible cluster and is read back.
+struct ModelPipelineCullMeshDraws final
+{
+    alignas(4) uint32_t draw_count{};
+    alignas(4) uint32_t needed_draws{};
+    alignas(4) uint32_t first_draw{};
+    alignas(4) uint32_t max_draws{};
+};
+
 #endif // SCOP_VULKAN_VULKANUBOSTRUCTS_HPP
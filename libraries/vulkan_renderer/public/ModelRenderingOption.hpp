@@ -0,0 +1,33 @@
+#ifndef SCOP_VULKAN_MODELRENDERINGOPTION_HPP
+#define SCOP_VULKAN_MODELRENDERINGOPTION_HPP
+
+struct ModelRenderingOption final
+{
+    // 20 bytes quantized vertices instead of 56 bytes, see PackedVertex
+    bool packed_vertices = false;
+
+    // Per instance mesh lod picked every frame from the camera distance,
+    // draws become indirect with instance indices grouped by lod
+    bool lod_selection = true;
+    // Highest accepted lod error once projected on screen, in pixels
+    float lod_pixel_error = 1.0f;
+
+    // Clusters of each instance are frustum culled by a compute pass
+    // appending visible clusters to indirect draws, replaces lod
+    // selection when enabled. Requires multiDrawIndirect,
+    // drawIndirectFirstInstance and Vulkan 1.2 drawIndirectCount.
+    bool cluster_culling = false;
+    // Also drops back facing clusters. Faces are not culled by the
+    // graphic pipeline so only enable for closed models.
+    bool cluster_backface_culling = false;
+
+    // All textures in one descriptor array, materials in a storage
+    // buffer indexed by draw. Descriptor sets are bound once per frame
+    // and meshes sharing an index type are drawn by a single indirect
+    // call. Requires multiDrawIndirect, drawIndirectFirstInstance and a
+    // Vulkan 1.2 device with runtimeDescriptorArray,
+    // descriptorBindingPartiallyBound and shaderDrawParameters.
+    bool bindless_materials = false;
+};
+
+#endif // SCOP_VULKAN_MODELRENDERINGOPTION_HPP
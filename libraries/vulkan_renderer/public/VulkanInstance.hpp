@@ -36,6 +36,12 @@ class VulkanInstance final
     VkQueue presentQueue{};
     uint32_t presentQueueIndex{};
     VkCommandPool modelCommandPool{};
+    VkPhysicalDeviceFeatures enabledFeatures{};
+    // pNext is not kept
+    VkPhysicalDeviceVulkan12Features enabledFeatures12{};
+    VkPhysicalDeviceVulkan11Features enabledFeatures11{};
+    // VK_EXT_memory_budget
+    VkBool32 memoryBudgetEnabled{};
 
   private:
     inline void _setup_vk_debug_msg();
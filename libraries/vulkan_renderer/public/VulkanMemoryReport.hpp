@@ -0,0 +1,43 @@
+#ifndef SCOP_VULKAN_VULKANMEMORYREPORT_HPP
+#define SCOP_VULKAN_VULKANMEMORYREPORT_HPP
+
+#include <array>
+#include <vector>
+
+#include <vulkan/vulkan.h>
+
+#include "VulkanMemoryAllocator.hpp"
+
+enum VulkanMemoryCategory
+{
+    VMC_VERTEX,
+    VMC_INDEX,
+    VMC_INSTANCE,
+    VMC_UBO,
+    VMC_TEXTURE,
+    VMC_DEPTH,
+    VMC_SWAPCHAIN,
+    VMC_STAGING,
+    VMC_TOTAL_NB,
+};
+
+[[maybe_unused]] constexpr std::array<char const *, VMC_TOTAL_NB> const
+  MEMORY_CATEGORY_NAMES{
+      "Vertex",  "Index", "Instance",  "UBO",
+      "Texture", "Depth", "Swapchain", "Staging",
+  };
+
+struct VulkanMemoryReport final
+{
+    // Bytes used by resources of each category, without allocator padding.
+    // Swapchain images are owned by the driver, their size is estimated.
+    std::array<VkDeviceSize, VMC_TOTAL_NB> categories{};
+    // Device memory blocks and allocations from the renderer allocator
+    VulkanMemoryStatistics current{};
+    VulkanMemoryStatistics peak{};
+    // Driver reported budgets when VK_EXT_memory_budget is enabled
+    bool has_memory_budget{};
+    std::vector<VulkanHeapBudget> heaps;
+};
+
+#endif // SCOP_VULKAN_VULKANMEMORYREPORT_HPP
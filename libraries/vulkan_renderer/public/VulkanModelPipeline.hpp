@@ -2,6 +2,7 @@
 #define SCOP_VULKAN_VULKANMODELPIPELINE_HPP
 
 #include <vector>
+#include <array>
 #include <unordered_map>
 
 #include <vulkan/vulkan.h>
@@ -13,10 +14,22 @@
 #include "VulkanSwapChain.hpp"
 #include "VulkanModelRenderPass.hpp"
 #include "VulkanTextureManager.hpp"
+#include "VulkanMemoryAllocator.hpp"
+#include "VulkanStagingRing.hpp"
+#include "VulkanUploadBatch.hpp"
+#include "VulkanGrowableBuffer.hpp"
+#include "VulkanFrameAllocator.hpp"
+#include "VulkanMemoryReport.hpp"
 #include "IndexedBuffer.hpp"
 #include "ModelInstanceInfo.hpp"
 #include "VulkanModelPipelineData.hpp"
 #include "VulkanModelRenderPass.hpp"
+#include "ModelRenderingOption.hpp"
+
+// Must match local_size_x of model_cull.comp
+static constexpr uint32_t const MODEL_CULL_WORKGROUP_SIZE = 64;
+// Size of the bindless texture array, lowered to the device limits
+static constexpr uint32_t const MODEL_MAX_BINDLESS_TEXTURES = 4096;
 
 class VulkanModelPipeline final
 {
@@ -28,12 +41,17 @@ class VulkanModelPipeline final
     VulkanModelPipeline(VulkanModelPipeline &&src) = delete;
     VulkanModelPipeline &operator=(VulkanModelPipeline &&rhs) = delete;
 
+    // Instance storage starts with room for instanceCapacity instances,
+    // its capacity is doubled when full
     void init(VulkanInstance const &vkInstance,
               VulkanSwapChain const &swapChain,
               Model const &model,
               VulkanTextureManager &texManager,
+              VulkanMemoryAllocator &allocator,
+              VulkanStagingRing &stagingRing,
               VkBuffer systemUbo,
-              uint32_t maxModelNb);
+              uint32_t instanceCapacity,
+              ModelRenderingOption const &option = {});
     void resize(VulkanSwapChain const &swapChain,
                 VulkanTextureManager &texManager,
                 VkBuffer systemUbo);
@@ -45,29 +63,103 @@ class VulkanModelPipeline final
     bool getInstance(uint32_t instanceIndex, ModelInstanceInfo &info);
     VulkanModelRenderPass const &getVulkanModelRenderPass() const;
     bool isInit() const;
+    // True once the model buffer uploaded by init is on the device, the
+    // pipeline can't be drawn before
+    bool pollUploads();
+    // Adds bytes of model resources to report categories
+    void addMemoryUsage(VulkanMemoryReport &report) const;
+    // Paths of the textures the model references, one per textured mesh
+    static std::vector<std::string> getTexturePaths(Model const &model);
+    // Device local bytes of model buffers with option, textures and depth
+    // buffer excluded. Index size is an upper bound.
+    static VkDeviceSize estimateBuffersMemory(
+      Model const &model,
+      ModelRenderingOption const &option,
+      uint32_t instanceCapacity,
+      uint32_t currentSwapChainNbImg);
 
+    // systemUbo given at init is read at systemUboOffset
     void generateCommands(VkCommandBuffer cmdBuffer,
                           size_t descriptorSetIndex,
-                          uint32_t currentSwapChainNbImg);
+                          uint32_t currentSwapChainNbImg,
+                          uint32_t systemUboOffset);
+    // Indirect draws of bindless materials without lod selection or
+    // culling, allocated for the frame about to be recorded
+    void updateDrawCommands(VulkanFrameAllocator &frameAllocator);
+    // pixelsPerUnit is the projected size in pixels of one unit at
+    // a distance of one unit from the camera
+    void updateLodSelection(uint32_t imgIndex,
+                            glm::vec3 const &cameraPos,
+                            float pixelsPerUnit);
+    // Compute pass filling indirect draws, recorded outside render pass
+    void generateCullingCommands(VkCommandBuffer cmdBuffer,
+                                 size_t descriptorSetIndex);
+    void updateClusterCulling(uint32_t imgIndex,
+                              glm::mat4 const &viewProj,
+                              glm::vec3 const &cameraPos);
+    // Rewrites samplers of streamed textures, command buffer of imgIndex
+    // has to be done executing. Returns true when descriptor sets were
+    // written, command buffer has then to be recorded again.
+    bool updateTextureDescriptors(uint32_t imgIndex);
 
   private:
     // Model related
     Model const *_model{};
+    ModelRenderingOption _option{};
+
+    // Texture related, one reference per material with a texture
+    VulkanTextureManager *_tex_manager{};
+    std::vector<std::string> _texture_names;
 
     // Vulkan related
     VkDevice _device{};
     VkPhysicalDevice _physical_device{};
+    VulkanMemoryAllocator *_allocator{};
+    // Instance matrices are uploaded with the next frame
+    VulkanStagingRing *_staging_ring{};
     VkCommandPool _cmd_pool{};
     VkQueue _gfx_queue{};
+    uint32_t _swap_chain_nb_img{};
     VkDescriptorSetLayout _descriptor_set_layout{};
     VkPipelineLayout _pipeline_layout{};
     VkPipeline _graphic_pipeline{};
+    VkDescriptorSetLayout _cull_descriptor_set_layout{};
+    VkPipelineLayout _cull_pipeline_layout{};
+    VkPipeline _cull_pipeline{};
+    // Highest number of cull draws of a swapchain image
+    uint32_t _cull_draws_limit{};
+    // Device limits of the cull dispatch group counts
+    std::array<uint32_t, 3> _cull_max_group_count{};
+    uint32_t _max_bindless_textures{};
     VulkanModelPipelineData _pipeline_model;
     VulkanModelRenderPass _pipeline_render_pass;
+    // Model buffer uploads
+    VulkanUploadBatch _upload_batch;
 
-    // Instance related
+    // Instance related, matrices are kept when the pipeline is resized
     IndexedBuffer<ModelInstanceInfo> _instance_handler;
+    VulkanGrowableBuffer _instance_buffer;
+    uint32_t _instance_capacity{};
+    // Cull draw area size of each mesh, kept when the pipeline is resized
+    std::vector<uint32_t> _cull_mesh_max_draws;
 
+    // Lod selection scratch buffers
+    std::vector<uint32_t> _lod_instance_levels;
+    std::vector<uint32_t> _lod_level_counts;
+    std::vector<uint32_t> _lod_level_offsets;
+    std::vector<VkDrawIndexedIndirectCommand> _lod_draw_commands;
+
+    // Bindless draw commands, in the frame allocator
+    std::vector<VkDrawIndexedIndirectCommand> _draw_commands;
+    VkBuffer _draw_commands_buffer{};
+    VkDeviceSize _draw_commands_offset{};
+
+    inline void _generate_group_draws(VkCommandBuffer cmd_buffer,
+                                      size_t descriptor_set_index,
+                                      VulkanModelDrawGroup const &group);
+    inline void _load_textures(Model const &model,
+                               VulkanTextureManager &textureManager);
+    inline void _release_textures();
     inline void _create_descriptor_layout();
     inline void _create_pipeline_layout();
     inline void _create_gfx_pipeline(VulkanSwapChain const &swapChain);
@@ -76,11 +168,36 @@ class VulkanModelPipeline final
       std::string const &modelFolder,
       VulkanTextureManager &textureManager,
       uint32_t currentSwapChainNbImg);
+    inline void _create_lod_buffer(Model const &model,
+                                   VulkanModelPipelineData &pipelineData,
+                                   uint32_t currentSwapChainNbImg);
+    inline void _create_cull_pipeline();
+    inline void _init_cull_draws(Model const &model);
+    inline void _create_cull_buffers(VulkanModelPipelineData &pipelineData,
+                                     uint32_t currentSwapChainNbImg);
+    inline void _create_cull_draw_buffer(VulkanModelPipelineData &pipelineData,
+                                         uint32_t currentSwapChainNbImg);
+    inline void _create_cull_descriptor_sets(
+      VulkanModelPipelineData &pipelineData,
+      uint32_t currentSwapChainNbImg);
+    inline void _write_cull_descriptor_sets(
+      VulkanModelPipelineData const &pipelineData);
+    inline void _grow_cull_draws(uint32_t imgIndex);
     inline void _create_descriptor_pool(VulkanSwapChain const &swapChain,
                                         VulkanModelPipelineData &pipelineData);
     inline void _create_descriptor_sets(VulkanSwapChain const &swapChain,
                                         VulkanModelPipelineData &pipelineData,
                                         VkBuffer systemUbo);
+    inline void _create_bindless_descriptor_sets(
+      VulkanSwapChain const &swapChain,
+      VulkanModelPipelineData &pipelineData,
+      VkBuffer systemUbo);
+    inline void _write_texture_descriptors(
+      VulkanModelPipelineData const &pipelineData,
+      uint32_t imgIndex);
+    inline void _write_instance_descriptors(
+      VulkanModelPipelineData const &pipelineData);
+    inline void _reserve_instances(uint32_t nb_instances);
     inline void _set_instance_matrix_on_gpu(uint32_t bufferIndex,
                                             ModelInstanceInfo const &info);
 };
@@ -3,36 +3,94 @@
 
 #include <array>
 #include <vector>
+#include <string>
 
 #include <vulkan/vulkan.h>
 
 #include "glm/glm.hpp"
 
 #include "VulkanTextureManager.hpp"
+#include "MeshIndexBlock.hpp"
+#include "VulkanMemoryAllocator.hpp"
+#include "VulkanMappedBuffer.hpp"
+
+// Consecutive draws sharing an index buffer binding
+struct VulkanModelDrawGroup final
+{
+    VkIndexType indexType{};
+    uint32_t firstDraw{};
+    uint32_t nbDraws{};
+};
 
 struct VulkanModelPipelineData
 {
     VkBuffer buffer{};
-    VkDeviceMemory memory{};
+    VulkanAllocation allocation{};
     VkDeviceSize verticesSize{};
     VkDeviceSize indicesSize{};
     VkDeviceSize singleUboSize{};
     VkDeviceSize singleSwapChainUboSize{};
-    VkDeviceSize instanceMatricesOffset{};
     VkDeviceSize indicesOffset{};
     VkDeviceSize uboOffset{};
+    // Bindless materials, storage buffer replacing material ubos
+    VkDeviceSize materialsOffset{};
+    VkDeviceSize materialsSize{};
     VkDescriptorPool descriptorPool{};
     std::vector<VkDescriptorSet> descriptorSets;
     glm::vec3 modelCenter{};
     VkDeviceSize nbMaterials{};
+    // One entry per distinct texture, materials refer to them by index
     std::vector<Texture> diffuseTextures;
+    std::vector<std::string> diffuseTextureNames;
+    std::vector<uint32_t> diffuseTextureIndices;
+    // Texture streaming version descriptor sets of each swapchain image
+    // were written with
+    std::vector<uint64_t> texturesStreamingVersion;
+    // First index of each batched mesh, index buffer is bound at
+    // indicesOffset with the index type of its block
     std::vector<VkDeviceSize> indicesDrawOffset;
     std::vector<VkDeviceSize> indicesDrawNb;
+    std::vector<MeshIndexBlock> indexBlocks;
+    // Batched mesh of each draw, meshes are grouped by index type.
+    // Bindless materials are stored in draw order.
+    std::vector<uint32_t> drawMeshes;
+    std::vector<VulkanModelDrawGroup> drawGroups;
+
+    // Lod selection, host visible, one area per swapchain image holding
+    // instance buffer indices packed level after level then indirect
+    // draw commands
+    VulkanMappedBuffer lodBuffer;
+    VkDeviceSize lodInstancesSize{};
+    VkDeviceSize lodIndirectOffset{};
+    uint32_t nbLodLevels{};
+    // Model wide error of each level, level 0 is the full model
+    std::vector<float> lodErrors;
+    float modelRadius{};
+
+    // Cluster culling, clusters are stored in buffer after indices.
+    // Visible clusters of each instance are appended by the compute pass
+    // to the draw area of their mesh, one set of areas per swapchain
+    // image. Draw counts are host visible, areas are grown from them.
+    VkDeviceSize clustersOffset{};
+    VkDeviceSize clustersSize{};
+    uint32_t nbClusters{};
+    VulkanMappedBuffer cullUbo;
+    VulkanMappedBuffer cullMeshDraws;
+    std::vector<uint32_t> cullFirstDraws;
+    VkBuffer cullDrawBuffer{};
+    VulkanAllocation cullDrawAllocation{};
+    VkDeviceSize cullDrawSingleSwapChainSize{};
+    VkDescriptorPool cullDescriptorPool{};
+    std::vector<VkDescriptorSet> cullDescriptorSets;
 
     static std::array<VkVertexInputBindingDescription, 2>
     getInputBindingDescription();
     static std::array<VkVertexInputAttributeDescription, 9>
     getInputAttributeDescription();
+    static std::array<VkVertexInputBindingDescription, 2>
+    getPackedInputBindingDescription();
+    static std::array<VkVertexInputAttributeDescription, 8>
+    getPackedInputAttributeDescription();
 
     void clear();
 };
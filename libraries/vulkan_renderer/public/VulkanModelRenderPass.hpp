@@ -7,6 +7,7 @@
 
 #include "VulkanInstance.hpp"
 #include "VulkanSwapChain.hpp"
+#include "VulkanMemoryAllocator.hpp"
 
 class VulkanModelRenderPass final
 {
@@ -19,6 +20,7 @@ class VulkanModelRenderPass final
     VulkanModelRenderPass &operator=(VulkanModelRenderPass &&rhs) = delete;
 
     void init(VulkanInstance const &vkInstance,
+              VulkanMemoryAllocator &allocator,
               VulkanSwapChain const &swapChain);
     void resize(VulkanSwapChain const &swapChain);
     void clear();
@@ -26,13 +28,14 @@ class VulkanModelRenderPass final
     std::vector<VkFramebuffer> framebuffers;
     VkFormat depthFormat{};
     VkImage depthImage{};
-    VkDeviceMemory depthImgMemory{};
+    VulkanAllocation depthImgAllocation{};
     VkImageView depthImgView{};
     VkRenderPass renderPass{};
 
   private:
     VkDevice _device{};
     VkPhysicalDevice _physical_device{};
+    VulkanMemoryAllocator *_allocator{};
     VkCommandPool _command_pool{};
     VkQueue _gfx_queue{};
 
@@ -6,9 +6,14 @@
 #include <vector>
 #include <array>
 #include <string>
+#include <memory>
 #include <vulkan/vulkan.h>
 
 #include "VulkanInstance.hpp"
+#include "VulkanMemoryAllocator.hpp"
+#include "VulkanStagingRing.hpp"
+#include "VulkanFrameAllocator.hpp"
+#include "VulkanMemoryReport.hpp"
 #include "VulkanTextureManager.hpp"
 #include "VulkanSwapChain.hpp"
 #include "VulkanSync.hpp"
@@ -43,18 +48,55 @@ class VulkanRenderer final
     [[nodiscard]] uint32_t getEngineVersion() const;
 
     // Model Related
-    void loadModel(Model const &model);
+    // Model is uploaded while the previous one is still drawn, it is
+    // swapped in at the first frame after its uploads are done. Instances
+    // are added to the loaded model from this call.
+    // textures are the ones of VulkanTextureManager::decodeTextures, when
+    // empty they are decoded here.
+    // When the model would not fit in device memory, unused cached
+    // textures are released, the previous model is dropped, cluster
+    // culling is disabled, vertices are packed then textures lose their
+    // top mip levels
+    void loadModel(Model &&model,
+                   ModelRenderingOption const &option = {},
+                   VulkanTextureManager::DecodedTextures &&textures = {});
     uint32_t addModelInstance(ModelInstanceInfo const &info);
     bool removeModelInstance(uint32_t index);
     bool updateModelInstance(uint32_t index, ModelInstanceInfo const &info);
     bool getModelInstance(uint32_t index, ModelInstanceInfo &info);
 
+    // Texture related
+    // Unused textures are kept in cache until this budget is exceeded
+    void setTextureMemoryBudget(VkDeviceSize budget);
+    // Bytes of texture levels uploaded per frame
+    void setTextureStreamingBudget(VkDeviceSize budget);
+    [[nodiscard]] bool isTextureCompressionSupported() const;
+
+    // Memory related
+    [[nodiscard]] VulkanMemoryReport getMemoryReport() const;
+
     // Render related
-    void draw(glm::mat4 const &view_proj_mat);
+    // Camera position and projection are used for lod selection
+    void draw(glm::mat4 const &view_proj_mat,
+              glm::mat4 const &proj_mat,
+              glm::vec3 const &camera_pos);
     void deviceWaitIdle() const;
 
   private:
-    static constexpr uint32_t MAX_MODEL_INSTANCE = 10;
+    // Instance storage is doubled whenever it is full
+    static constexpr uint32_t INITIAL_MODEL_INSTANCE_CAPACITY = 16;
+    // Textures are not reduced below this size to fit in memory
+    static constexpr uint32_t MIN_DEGRADED_TEXTURE_SIZE = 256;
+    static constexpr uint32_t MAX_TEXTURE_SIZE = 16384;
+
+    // Pipeline keeps a pointer to the model, both are destroyed together
+    struct ModelSlot final
+    {
+        std::unique_ptr<Model> model;
+        std::unique_ptr<VulkanModelPipeline> pipeline;
+        // Frames that may still use the pipeline once retired
+        std::array<bool, VulkanSync::MAX_FRAME_INFLIGHT> inflight_frames{};
+    };
 
     std::string _app_name;
     std::string _engine_name;
@@ -62,28 +104,51 @@ class VulkanRenderer final
     uint32_t _engine_version{};
 
     VulkanInstance _vk_instance;
+    VulkanMemoryAllocator _memory_allocator;
+    VulkanStagingRing _staging_ring;
+    // Transient data of the frame in flight, system uniform included
+    VulkanFrameAllocator _frame_allocator;
     VulkanTextureManager _tex_manager;
     VulkanSwapChain _swap_chain;
     VulkanSync _sync;
-    VulkanModelPipeline _model_pipeline;
     VulkanUi _ui;
 
-    // Renderer global uniform
-    VkBuffer _system_uniform{};
-    VkDeviceMemory _system_uniform_memory{};
+    // Model related
+    ModelSlot _model;
+    // Uploading, replaces _model once done
+    ModelSlot _loading_model;
+    // Destroyed once every frame in flight using them is done
+    std::vector<ModelSlot> _retired_models;
 
     // Drawing related
     std::vector<VkCommandBuffer> _model_command_buffers;
 
     // Draw related fct
     inline void _create_model_command_buffers();
+    inline void _free_model_command_buffers();
+    inline void _record_model_command_buffer(size_t img_index,
+                                             uint32_t system_ubo_offset);
+
+    // Frame allocator related fct
+    inline void _create_frame_allocator();
+
+    // Model slot related fct
+    inline ModelSlot &_get_instance_model();
+    inline void _retire_model(ModelSlot &slot);
+    inline void _clear_model(ModelSlot &slot);
+    inline void _clear_retired_models();
+    inline void _update_models();
 
-    // Renderer global uniform related fct
-    inline void _create_system_uniform_buffer();
+    // Memory budget related fct
+    inline VkDeviceSize _get_available_device_memory() const;
+    inline void _fit_model_in_memory(Model const &model,
+                                     ModelRenderingOption &option);
 
     // Draw command emission related
     inline void _emit_model_ui_cmds(uint32_t img_index,
-                                    glm::mat4 const &view_proj_mat);
+                                    glm::mat4 const &view_proj_mat,
+                                    glm::mat4 const &proj_mat,
+                                    glm::vec3 const &camera_pos);
     inline void _emit_ui_cmds(uint32_t img_index);
 };
 
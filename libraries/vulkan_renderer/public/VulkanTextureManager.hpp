@@ -2,21 +2,34 @@
 #define SCOP_VULKAN_VULKANTEXTUREMANAGER_HPP
 
 #include <unordered_map>
+#include <list>
 #include <string>
+#include <vector>
+#include <span>
+#include <atomic>
+#include <cstdint>
 
 #include <vulkan/vulkan.h>
 
 #include "VulkanInstance.hpp"
+#include "VulkanImage.hpp"
+#include "VulkanTextureCompression.hpp"
+#include "VulkanUploadBatch.hpp"
+#include "VulkanMemoryAllocator.hpp"
 
 struct Texture final
 {
     VkImage texture_img{};
-    VkDeviceMemory texture_img_memory{};
+    VulkanAllocation texture_img_allocation{};
     VkImageView texture_img_view{};
+    // Shared, owned by the texture manager
     VkSampler texture_sampler{};
     int32_t width{};
     int32_t height{};
     uint32_t mip_level{};
+    // First level that can be sampled, lowered as levels are streamed in
+    uint32_t min_level{};
+    VkDeviceSize memory_size{};
 };
 
 static constexpr char const *SCOP_DEFAULT_TEXTURE = "SCOP_DEFAULT_TEXTURE";
@@ -31,28 +44,199 @@ class VulkanTextureManager final
     VulkanTextureManager &operator=(VulkanTextureManager const &rhs) = delete;
     VulkanTextureManager &operator=(VulkanTextureManager &&rhs) = delete;
 
-    void init(VulkanInstance const &vkInstance);
+    static constexpr VkDeviceSize const DEFAULT_MEMORY_BUDGET =
+      512 * 1024 * 1024;
+    static constexpr VkDeviceSize const DEFAULT_STREAMING_BUDGET =
+      4 * 1024 * 1024;
+
+    // Either RGBA8 pixels or a compressed mip chain when supported.
+    // Decoded pixels are kept in the decoder allocation, downscaled or
+    // generated ones in pixels.
+    struct DecodedTexture final
+    {
+        ImagePixels image;
+        std::vector<uint8_t> pixels;
+        int32_t width{};
+        int32_t height{};
+        // Max texture size top levels were dropped for, 0 when complete
+        uint32_t max_size{};
+        CompressedTexture compressed;
+    };
+
+    // Images decoded ahead of loadDecodedTextures, one per distinct path
+    struct DecodedTextures final
+    {
+        std::vector<std::string> paths;
+        std::vector<DecodedTexture> textures;
+    };
+
+    void init(VulkanInstance const &vkInstance,
+              VulkanMemoryAllocator &allocator,
+              VkDeviceSize memoryBudget = DEFAULT_MEMORY_BUDGET);
     void clear();
+    // Textures are reference counted, every load takes a reference that
+    // has to be given back with releaseTexture. Unreferenced textures
+    // stay cached until the memory budget is exceeded, least recently
+    // used first.
     void loadTexture(std::string const &texturePath);
+    void releaseTexture(std::string const &texturePath);
     void unloadAllTextures();
     bool getTexture(std::string const &texturePath, Texture &tex);
     Texture loadAndGetTexture(std::string const &texturePath);
+    // One reference per path, duplicates included.
+    // Images are decoded concurrently then uploaded one after the other.
+    // Work is split in chunks of worker threads count to keep decoded
+    // images memory bounded.
+    void loadTextures(std::vector<std::string> const &texturePaths);
+    // Decodes texturePaths at full size without any vulkan call, can be
+    // called from any thread. compress has to be isCompressionSupported
+    // of the manager loading them. Every image is held until uploaded,
+    // decoding stops early once cancel is set.
+    static void decodeTextures(std::vector<std::string> const &texturePaths,
+                               bool compress,
+                               std::atomic<bool> const &cancel,
+                               DecodedTextures &decoded);
+    // Same as loadTextures with images from decodeTextures, missing ones
+    // are decoded here. Uploads are submitted without waiting, textures
+    // can't be sampled before pollUploads returns true.
+    void loadDecodedTextures(std::vector<std::string> const &texturePaths,
+                             DecodedTextures &decoded);
+    bool pollUploads();
+    [[nodiscard]] bool isCompressionSupported() const;
+    void setMemoryBudget(VkDeviceSize memoryBudget);
+    [[nodiscard]] VkDeviceSize getMemoryBudget() const;
+    [[nodiscard]] VkDeviceSize getUsedMemory() const;
+    // Destroys every cached texture without reference
+    void releaseUnusedTextures();
+
+    // Textures loaded afterwards bigger than maxSize lose their top mip
+    // levels, 0 means no limit. Unreferenced cached textures reduced
+    // under a lower limit are loaded again, referenced ones are kept.
+    void setMaxTextureSize(uint32_t maxSize);
+    [[nodiscard]] uint32_t getMaxTextureSize() const;
+    // Device memory loading texturePaths would take with maxSize, cached
+    // textures excluded. Read from image headers, nothing is decoded.
+    [[nodiscard]] VkDeviceSize estimateTexturesMemory(
+      std::vector<std::string> const &texturePaths,
+      uint32_t maxSize) const;
+
+    // Compressed textures are created with their small levels only, the
+    // others are uploaded one level per texture per call, coarsest first,
+    // within the streaming budget. To be called once per frame.
+    // A texture sampler changes when one of its levels is made available,
+    // streaming version is then incremented.
+    void updateStreaming();
+    void setStreamingBudget(VkDeviceSize frameBudget);
+    [[nodiscard]] VkDeviceSize getStreamingBudget() const;
+    [[nodiscard]] uint64_t getStreamingVersion() const;
 
   private:
+    // Levels up to this size are uploaded when the texture is created
+    static constexpr uint32_t const STREAMING_RESIDENT_SIZE = 128;
+
     VkDevice _device{};
     VkPhysicalDevice _physical_device{};
+    VulkanMemoryAllocator *_allocator{};
     VkQueue _gfx_queue{};
     VkCommandPool _command_pool{};
-    std::unordered_map<std::string, Texture> _textures;
+    // Image creation records uploads, submitted once per loading call
+    VulkanUploadBatch _upload_batch;
+    // Streamed levels, submitted without waiting
+    VulkanUploadBatch _stream_batch;
+
+    struct TextureEntry final
+    {
+        Texture tex{};
+        uint32_t nb_refs{};
+        // Default texture is never evicted
+        bool pinned{};
+        // Max texture size top levels were dropped for, 0 when complete
+        uint32_t max_size{};
+        std::list<std::string>::iterator lru_it;
+        // Mip chain kept until every level is uploaded
+        CompressedTexture pending;
+    };
+
+    std::unordered_map<std::string, TextureEntry> _textures;
+    // Most recently used first
+    std::list<std::string> _lru;
+    VkDeviceSize _memory_budget{};
+    VkDeviceSize _used_memory{};
+    uint32_t _max_texture_size{};
+    bool _compression_supported{};
+    VkDeviceSize _streaming_budget{};
+    uint64_t _streaming_version{};
+    // Textures with a level in the in flight stream batch
+    std::vector<std::string> _streamed_textures;
+
+    // Samplers are shared between textures, maxLod is VK_LOD_CLAMP_NONE,
+    // image views bound the mip count
+    struct SamplerKey final
+    {
+        VkFilter filter{};
+        VkSamplerMipmapMode mipmap_mode{};
+        VkSamplerAddressMode address_mode{};
+        float mip_lod_bias{};
+        float max_anisotropy{};
+        float min_lod{};
+        float max_lod{};
+
+        bool operator==(SamplerKey const &rhs) const = default;
+    };
+
+    struct Sampler final
+    {
+        SamplerKey key{};
+        VkSampler sampler{};
+    };
+
+    std::vector<Sampler> _samplers;
+    float _max_sampler_anisotropy{};
 
-    inline VkImage _create_texture_image(std::string const &texturePath,
-                                         VkDeviceMemory &texture_img_memory,
-                                         int32_t &tex_img_w,
-                                         int32_t &tex_img_h,
-                                         uint32_t &mip_level);
+    // Called from worker threads, no vulkan call allowed
+    static inline void _decode_texture(std::string const &texturePath,
+                                       bool compress,
+                                       uint32_t max_size,
+                                       DecodedTexture &decoded);
+    static inline void _drop_top_levels(DecodedTexture &decoded,
+                                        uint32_t max_size);
+    static inline std::span<uint8_t const> _get_pixels(
+      DecodedTexture const &decoded);
+    inline Texture _create_texture(DecodedTexture const &decoded);
+    inline void _destroy_texture(TextureEntry &entry);
+    inline TextureEntry &_insert_texture(std::string const &texturePath,
+                                         Texture const &tex,
+                                         uint32_t nbRefs);
+    inline void _insert_decoded_texture(std::string const &texturePath,
+                                        DecodedTexture &decoded,
+                                        uint32_t nbRefs);
+    inline void _acquire_texture(TextureEntry &entry);
+    // References cached textures of texturePaths, returns the others
+    // once each
+    inline std::vector<std::string> _acquire_cached_textures(
+      std::vector<std::string> const &texturePaths);
+    // True when entry was reduced more than the current limit requires
+    [[nodiscard]] inline bool _is_reduced(TextureEntry const &entry) const;
+    // Cached texture of texturePath, unreferenced reduced ones are
+    // destroyed and not returned
+    inline std::unordered_map<std::string, TextureEntry>::iterator
+    _find_texture(std::string const &texturePath);
+    inline void _evict_unused_textures(VkDeviceSize requiredSize);
+    inline VkImage _create_texture_image(
+      DecodedTexture const &decoded,
+      VulkanAllocation &texture_img_allocation,
+      uint32_t &mip_level);
+    inline VkImage _create_compressed_texture_image(
+      CompressedTexture const &compressed,
+      VulkanAllocation &texture_img_allocation,
+      uint32_t &mip_level,
+      uint32_t &min_level);
     inline VkImageView _create_texture_image_view(VkImage texture_img,
+                                                  VkFormat format,
                                                   uint32_t mip_level);
-    inline VkSampler _create_texture_sampler(uint32_t mip_level);
+    inline VkSampler _get_texture_sampler(uint32_t min_level);
+    inline VkSampler _get_sampler(SamplerKey const &key);
+    inline void _finish_streamed_levels();
     inline void _load_default_texture();
 };
 
@@ -0,0 +1,95 @@
+#include "VulkanFrameAllocator.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+void
+VulkanFrameAllocator::init(VkDevice device,
+                           VulkanMemoryAllocator &allocator,
+                           uint32_t nbFrames,
+                           VkBufferUsageFlags usage,
+                           VkDeviceSize minAlignment,
+                           VkDeviceSize frameSize)
+{
+    _min_alignment = minAlignment;
+    _buffer.init(device, allocator, frameSize, nbFrames, usage, minAlignment);
+    _current_frame = 0;
+    _head = 0;
+}
+
+void
+VulkanFrameAllocator::clear()
+{
+    _buffer.clear();
+    _min_alignment = 0;
+    _current_frame = 0;
+    _head = 0;
+}
+
+void
+VulkanFrameAllocator::reset(uint32_t frameIndex)
+{
+    _current_frame = frameIndex;
+    _head = 0;
+}
+
+VulkanFrameAllocation
+VulkanFrameAllocator::allocate(VkDeviceSize size, VkDeviceSize alignment)
+{
+    // Alignment is relative to the buffer start, not the frame area
+    alignment = std::max(alignment, _min_alignment);
+    auto frame_offset = _buffer.getFrameOffset(_current_frame);
+    auto offset =
+      (frame_offset + _head + alignment - 1) / alignment * alignment -
+      frame_offset;
+    if (offset + size > _buffer.getFrameStride()) {
+        throw std::runtime_error("VkFrameAllocator: Frame area is full");
+    }
+    _head = offset + size;
+
+    VulkanFrameAllocation allocation{};
+    allocation.buffer = _buffer.getBuffer();
+    allocation.offset = frame_offset + offset;
+    allocation.data =
+      static_cast<uint8_t *>(_buffer.getFrameData(_current_frame)) + offset;
+    return (allocation);
+}
+
+VulkanFrameAllocation
+VulkanFrameAllocator::push(void const *data,
+                           VkDeviceSize size,
+                           VkDeviceSize alignment)
+{
+    auto allocation = allocate(size, alignment);
+    std::memcpy(allocation.data, data, size);
+    flush(allocation, size);
+    return (allocation);
+}
+
+void
+VulkanFrameAllocator::flush(VulkanFrameAllocation const &allocation,
+                            VkDeviceSize size)
+{
+    _buffer.flush(_current_frame,
+                  allocation.offset - _buffer.getFrameOffset(_current_frame),
+                  size);
+}
+
+VkBuffer
+VulkanFrameAllocator::getBuffer() const
+{
+    return (_buffer.getBuffer());
+}
+
+VkDeviceSize
+VulkanFrameAllocator::getFrameSize() const
+{
+    return (_buffer.getFrameStride());
+}
+
+VkDeviceSize
+VulkanFrameAllocator::getUsedSize() const
+{
+    return (_head);
+}
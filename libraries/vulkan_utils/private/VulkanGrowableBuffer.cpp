@@ -0,0 +1,85 @@
+#include "VulkanGrowableBuffer.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+
+#include "VulkanMemory.hpp"
+
+void
+VulkanGrowableBuffer::init(VkDevice device,
+                           VulkanMemoryAllocator &allocator,
+                           VkCommandPool commandPool,
+                           VkQueue queue,
+                           VkDeviceSize size,
+                           VkBufferUsageFlags usage)
+{
+    _device = device;
+    _allocator = &allocator;
+    _command_pool = commandPool;
+    _queue = queue;
+    _usage = usage | VK_BUFFER_USAGE_TRANSFER_SRC_BIT |
+             VK_BUFFER_USAGE_TRANSFER_DST_BIT;
+    _size = size;
+
+    createBuffer(_device, _buffer, _size, _usage);
+    _allocation =
+      _allocator->allocateBuffer(_buffer, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+}
+
+void
+VulkanGrowableBuffer::clear()
+{
+    if (_allocator) {
+        vkDestroyBuffer(_device, _buffer, nullptr);
+        _allocator->free(_allocation);
+    }
+    _device = nullptr;
+    _allocator = nullptr;
+    _command_pool = nullptr;
+    _queue = nullptr;
+    _usage = 0;
+    _buffer = nullptr;
+    _size = 0;
+}
+
+bool
+VulkanGrowableBuffer::reserve(VkDeviceSize size)
+{
+    if (size <= _size) {
+        return (false);
+    }
+
+    auto new_size = std::max(size, _size * 2);
+    VkBuffer new_buffer{};
+    createBuffer(_device, new_buffer, new_size, _usage);
+    VulkanAllocation new_allocation{};
+    try {
+        new_allocation = _allocator->allocateBuffer(
+          new_buffer, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+    } catch (std::exception const &e) {
+        vkDestroyBuffer(_device, new_buffer, nullptr);
+        throw;
+    }
+
+    // Waits for the queue to be idle, previous buffer is no longer in use
+    copyBufferOnGpu(
+      _device, _command_pool, _queue, new_buffer, _buffer, _size);
+    vkDestroyBuffer(_device, _buffer, nullptr);
+    _allocator->free(_allocation);
+    _buffer = new_buffer;
+    _allocation = new_allocation;
+    _size = new_size;
+    return (true);
+}
+
+VkBuffer
+VulkanGrowableBuffer::getBuffer() const
+{
+    return (_buffer);
+}
+
+VkDeviceSize
+VulkanGrowableBuffer::getSize() const
+{
+    return (_size);
+}
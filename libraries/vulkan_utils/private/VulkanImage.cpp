@@ -1,6 +1,7 @@
 #include "VulkanImage.hpp"
 
 #include <stdexcept>
+#include <algorithm>
 
 #define STB_IMAGE_IMPLEMENTATION
 #include "stb_image.h"
@@ -9,38 +10,29 @@
 #include "VulkanCommandBuffer.hpp"
 #include "VulkanPhysicalDevice.hpp"
 
-VkDeviceSize
-loadTextureInBuffer(VkPhysicalDevice physical_device,
-                    VkDevice device,
-                    std::string const &filepath,
-                    VkBuffer &tex_buffer,
-                    VkDeviceMemory &tex_buffer_memory,
-                    int &tex_w,
-                    int &tex_h)
+void
+ImagePixelsDeleter::operator()(uint8_t *pixels) const
+{
+    stbi_image_free(pixels);
+}
+
+ImagePixels
+decodeImage(std::string const &filepath, int &tex_w, int &tex_h)
 {
     int img_chan;
-    auto pixels =
-      stbi_load(filepath.c_str(), &tex_w, &tex_h, &img_chan, STBI_rgb_alpha);
-    if (!pixels) {
+    ImagePixels img(
+      stbi_load(filepath.c_str(), &tex_w, &tex_h, &img_chan, STBI_rgb_alpha));
+    if (!img) {
         throw std::runtime_error("VkImage: failed to load image: " + filepath);
     }
-    VkDeviceSize img_size = tex_w * tex_h * 4;
-
-    createBuffer(
-      device, tex_buffer, img_size, VK_BUFFER_USAGE_TRANSFER_SRC_BIT);
-    allocateBuffer(physical_device,
-                   device,
-                   tex_buffer,
-                   tex_buffer_memory,
-                   VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT |
-                     VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
-
-    void *data;
-    vkMapMemory(device, tex_buffer_memory, 0, img_size, 0, &data);
-    memcpy(data, pixels, static_cast<size_t>(img_size));
-    vkUnmapMemory(device, tex_buffer_memory);
-    stbi_image_free(pixels);
-    return (img_size);
+    return (img);
+}
+
+bool
+getImageSize(std::string const &filepath, int &tex_w, int &tex_h)
+{
+    int img_chan;
+    return (stbi_info(filepath.c_str(), &tex_w, &tex_h, &img_chan));
 }
 
 VkImage
@@ -74,29 +66,6 @@ createImage(VkDevice device,
     return (img);
 }
 
-void
-allocateImage(VkPhysicalDevice physical_device,
-              VkDevice device,
-              VkImage &image,
-              VkDeviceMemory &image_memory,
-              VkMemoryPropertyFlags properties)
-{
-    VkMemoryRequirements mem_req{};
-    vkGetImageMemoryRequirements(device, image, &mem_req);
-
-    VkMemoryAllocateInfo alloc_info{};
-    alloc_info.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
-    alloc_info.allocationSize = mem_req.size;
-    alloc_info.memoryTypeIndex =
-      findMemoryType(physical_device, mem_req.memoryTypeBits, properties);
-
-    if (vkAllocateMemory(device, &alloc_info, nullptr, &image_memory) !=
-        VK_SUCCESS) {
-        throw std::runtime_error("VkImage: failed to allocate image memory");
-    }
-    vkBindImageMemory(device, image, image_memory, 0);
-}
-
 void
 transitionImageLayout(VkDevice device,
                       VkCommandPool command_pool,
@@ -108,7 +77,20 @@ transitionImageLayout(VkDevice device,
                       VkImageLayout new_layout)
 {
     auto cmd_buffer = beginSingleTimeCommands(device, command_pool);
+    recordImageLayoutTransition(
+      cmd_buffer, image, format, mip_level, old_layout, new_layout);
+    endSingleTimeCommands(device, command_pool, cmd_buffer, gfx_queue);
+}
 
+void
+recordImageLayoutTransition(VkCommandBuffer cmd_buffer,
+                            VkImage image,
+                            VkFormat format,
+                            uint32_t mip_level,
+                            VkImageLayout old_layout,
+                            VkImageLayout new_layout,
+                            uint32_t base_mip_level)
+{
     VkImageMemoryBarrier barrier{};
     barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
     barrier.oldLayout = old_layout;
@@ -116,7 +98,7 @@ transitionImageLayout(VkDevice device,
     barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
     barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
     barrier.image = image;
-    barrier.subresourceRange.baseMipLevel = 0;
+    barrier.subresourceRange.baseMipLevel = base_mip_level;
     barrier.subresourceRange.levelCount = mip_level;
     barrier.subresourceRange.baseArrayLayer = 0;
     barrier.subresourceRange.layerCount = 1;
@@ -146,6 +128,13 @@ transitionImageLayout(VkDevice device,
 
         source_stage = VK_PIPELINE_STAGE_TRANSFER_BIT;
         destination_stage = VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT;
+    } else if (old_layout == VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL &&
+               new_layout == VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL) {
+        barrier.srcAccessMask = VK_ACCESS_SHADER_READ_BIT;
+        barrier.dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+
+        source_stage = VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT;
+        destination_stage = VK_PIPELINE_STAGE_TRANSFER_BIT;
     } else if (old_layout == VK_IMAGE_LAYOUT_UNDEFINED &&
                new_layout == VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL) {
         barrier.srcAccessMask = 0;
@@ -168,7 +157,6 @@ transitionImageLayout(VkDevice device,
                          nullptr,
                          1,
                          &barrier);
-    endSingleTimeCommands(device, command_pool, cmd_buffer, gfx_queue);
 }
 
 void
@@ -201,6 +189,42 @@ copyBufferToImage(VkDevice device,
     endSingleTimeCommands(device, command_pool, cmd_buffer, gfx_queue);
 }
 
+void
+copyBufferToImageLevels(VkDevice device,
+                        VkCommandPool command_pool,
+                        VkQueue gfx_queue,
+                        VkBuffer buffer,
+                        VkImage image,
+                        uint32_t width,
+                        uint32_t height,
+                        std::vector<VkDeviceSize> const &level_offsets)
+{
+    auto cmd_buffer = beginSingleTimeCommands(device, command_pool);
+
+    std::vector<VkBufferImageCopy> regions(level_offsets.size());
+    for (uint32_t i = 0; i < regions.size(); ++i) {
+        auto &region = regions[i];
+        region.bufferOffset = level_offsets[i];
+        region.bufferRowLength = 0;
+        region.bufferImageHeight = 0;
+        region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+        region.imageSubresource.mipLevel = i;
+        region.imageSubresource.baseArrayLayer = 0;
+        region.imageSubresource.layerCount = 1;
+        region.imageOffset = { 0, 0, 0 };
+        region.imageExtent = { std::max(width >> i, 1u),
+                               std::max(height >> i, 1u),
+                               1 };
+    }
+    vkCmdCopyBufferToImage(cmd_buffer,
+                           buffer,
+                           image,
+                           VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                           regions.size(),
+                           regions.data());
+    endSingleTimeCommands(device, command_pool, cmd_buffer, gfx_queue);
+}
+
 VkImageView
 createImageView(VkImage image,
                 VkFormat format,
@@ -276,6 +300,18 @@ generateMipmaps(VkPhysicalDevice physical_device,
                                  "for requested image format");
     }
 
+    VkCommandBuffer cmd_buffer = beginSingleTimeCommands(device, command_pool);
+    recordGenerateMipmaps(cmd_buffer, image, tex_width, tex_height, mip_levels);
+    endSingleTimeCommands(device, command_pool, cmd_buffer, gfx_queue);
+}
+
+void
+recordGenerateMipmaps(VkCommandBuffer cmd_buffer,
+                      VkImage image,
+                      int32_t tex_width,
+                      int32_t tex_height,
+                      uint32_t mip_levels)
+{
     VkImageMemoryBarrier barrier{};
     barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
     barrier.image = image;
@@ -288,7 +324,6 @@ generateMipmaps(VkPhysicalDevice physical_device,
 
     int32_t mip_w = tex_width;
     int32_t mip_h = tex_height;
-    VkCommandBuffer cmd_buffer = beginSingleTimeCommands(device, command_pool);
     for (uint32_t i = 1; i < mip_levels; i++) {
         barrier.subresourceRange.baseMipLevel = i - 1;
         barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
@@ -367,6 +402,4 @@ generateMipmaps(VkPhysicalDevice physical_device,
                          nullptr,
                          1,
                          &barrier);
-
-    endSingleTimeCommands(device, command_pool, cmd_buffer, gfx_queue);
 }
\ No newline at end of file
@@ -0,0 +1,103 @@
+#include "VulkanMappedBuffer.hpp"
+
+#include <cassert>
+#include <cstring>
+
+#include "VulkanMemory.hpp"
+
+void
+VulkanMappedBuffer::init(VkDevice device,
+                         VulkanMemoryAllocator &allocator,
+                         VkDeviceSize frameSize,
+                         uint32_t nbFrames,
+                         VkBufferUsageFlags usage,
+                         VkDeviceSize frameAlignment)
+{
+    _device = device;
+    _allocator = &allocator;
+    _frame_stride =
+      (frameSize + frameAlignment - 1) / frameAlignment * frameAlignment;
+    _nb_frames = nbFrames;
+
+    createBuffer(_device, _buffer, _frame_stride * _nb_frames, usage);
+    _allocation =
+      _allocator->allocateBuffer(_buffer, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT);
+}
+
+void
+VulkanMappedBuffer::clear()
+{
+    if (_allocator) {
+        vkDestroyBuffer(_device, _buffer, nullptr);
+        _allocator->free(_allocation);
+    }
+    _device = nullptr;
+    _allocator = nullptr;
+    _buffer = nullptr;
+    _frame_stride = 0;
+    _nb_frames = 0;
+}
+
+void
+VulkanMappedBuffer::write(uint32_t frameIndex,
+                          VkDeviceSize offset,
+                          void const *data,
+                          VkDeviceSize size)
+{
+    assert(offset + size <= _frame_stride);
+
+    std::memcpy(static_cast<uint8_t *>(getFrameData(frameIndex)) + offset,
+                data,
+                size);
+    flush(frameIndex, offset, size);
+}
+
+void
+VulkanMappedBuffer::flush(uint32_t frameIndex,
+                          VkDeviceSize offset,
+                          VkDeviceSize size)
+{
+    _allocator->flush(_allocation, getFrameOffset(frameIndex) + offset, size);
+}
+
+void
+VulkanMappedBuffer::invalidate(uint32_t frameIndex,
+                               VkDeviceSize offset,
+                               VkDeviceSize size)
+{
+    _allocator->invalidate(
+      _allocation, getFrameOffset(frameIndex) + offset, size);
+}
+
+void *
+VulkanMappedBuffer::getFrameData(uint32_t frameIndex) const
+{
+    assert(frameIndex < _nb_frames);
+
+    return (static_cast<uint8_t *>(_allocation.mapped) +
+            getFrameOffset(frameIndex));
+}
+
+VkBuffer
+VulkanMappedBuffer::getBuffer() const
+{
+    return (_buffer);
+}
+
+VkDeviceSize
+VulkanMappedBuffer::getFrameOffset(uint32_t frameIndex) const
+{
+    return (_frame_stride * frameIndex);
+}
+
+VkDeviceSize
+VulkanMappedBuffer::getFrameStride() const
+{
+    return (_frame_stride);
+}
+
+uint32_t
+VulkanMappedBuffer::getNbFrames() const
+{
+    return (_nb_frames);
+}
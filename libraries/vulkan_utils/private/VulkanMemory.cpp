@@ -40,29 +40,6 @@ createBuffer(VkDevice device,
     }
 }
 
-void
-allocateBuffer(VkPhysicalDevice physical_device,
-               VkDevice device,
-               VkBuffer &buffer,
-               VkDeviceMemory &buffer_memory,
-               VkMemoryPropertyFlags properties)
-{
-    VkMemoryRequirements mem_requirement;
-    vkGetBufferMemoryRequirements(device, buffer, &mem_requirement);
-
-    VkMemoryAllocateInfo alloc_info{};
-    alloc_info.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
-    alloc_info.allocationSize = mem_requirement.size;
-    alloc_info.memoryTypeIndex = findMemoryType(
-      physical_device, mem_requirement.memoryTypeBits, properties);
-
-    if (vkAllocateMemory(device, &alloc_info, nullptr, &buffer_memory) !=
-        VK_SUCCESS) {
-        throw std::runtime_error("VkMemory: Failed to allocate memory");
-    }
-    vkBindBufferMemory(device, buffer, buffer_memory, 0);
-}
-
 void
 copyBufferOnGpu(VkDevice device,
                 VkCommandPool command_pool,
@@ -96,22 +73,19 @@ copyBufferOnGpu(VkDevice device,
 }
 
 void
-copyOnCpuCoherentMemory(VkDevice device,
-                        VkDeviceMemory memory,
+copyOnCpuCoherentMemory(VulkanAllocation const &allocation,
                         VkDeviceSize offset,
                         VkDeviceSize size,
                         void const *dataToCopy)
 {
-    void *mapped_data{};
-
-    vkMapMemory(device, memory, offset, size, 0, &mapped_data);
-    memcpy(mapped_data, dataToCopy, size);
-    vkUnmapMemory(device, memory);
+    memcpy(static_cast<uint8_t *>(allocation.mapped) + offset,
+           dataToCopy,
+           size);
 }
 
 void
 copyCpuBufferToGpu(VkDevice device,
-                   VkPhysicalDevice physicalDevice,
+                   VulkanMemoryAllocator &allocator,
                    VkCommandPool commandPool,
                    VkQueue queue,
                    VkBuffer dstBuffer,
@@ -120,21 +94,17 @@ copyCpuBufferToGpu(VkDevice device,
 {
     // Staging buffer on CPU
     VkBuffer staging_buffer{};
-    VkDeviceMemory staging_buffer_memory{};
     createBuffer(device,
                  staging_buffer,
                  copyRegion.size,
                  VK_BUFFER_USAGE_TRANSFER_SRC_BIT);
-    allocateBuffer(physicalDevice,
-                   device,
-                   staging_buffer,
-                   staging_buffer_memory,
-                   VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT |
-                     VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+    auto staging_allocation = allocator.allocateTransientBuffer(
+      staging_buffer,
+      VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT |
+        VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
 
     // Copy on staging buffer
-    copyOnCpuCoherentMemory(
-      device, staging_buffer_memory, 0, copyRegion.size, srcData);
+    copyOnCpuCoherentMemory(staging_allocation, 0, copyRegion.size, srcData);
 
     // Copy on GPU
     copyBufferOnGpu(
@@ -142,5 +112,5 @@ copyCpuBufferToGpu(VkDevice device,
 
     // Cleaning
     vkDestroyBuffer(device, staging_buffer, nullptr);
-    vkFreeMemory(device, staging_buffer_memory, nullptr);
+    allocator.free(staging_allocation);
 }
@@ -0,0 +1,463 @@
+#include "VulkanMemoryAllocator.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+#include <utility>
+
+#include "VulkanMemory.hpp"
+
+void
+VulkanMemoryAllocator::init(VkPhysicalDevice physicalDevice,
+                            VkDevice device,
+                            bool memoryBudget,
+                            VkDeviceSize blockSize)
+{
+    _physical_device = physicalDevice;
+    _device = device;
+    _block_size = blockSize;
+    _memory_budget = memoryBudget;
+    vkGetPhysicalDeviceMemoryProperties(_physical_device, &_memory_properties);
+
+    VkPhysicalDeviceProperties properties;
+    vkGetPhysicalDeviceProperties(_physical_device, &properties);
+    _buffer_image_granularity = properties.limits.bufferImageGranularity;
+    _non_coherent_atom_size = properties.limits.nonCoherentAtomSize;
+}
+
+void
+VulkanMemoryAllocator::clear()
+{
+    for (auto &pool : _pools) {
+        for (auto &it : pool) {
+            _destroy_block(it);
+        }
+        pool.clear();
+    }
+    _physical_device = nullptr;
+    _device = nullptr;
+    _block_size = 0;
+    _memory_properties = {};
+    _buffer_image_granularity = 0;
+    _non_coherent_atom_size = 0;
+    _memory_budget = false;
+    _peak_statistics = {};
+}
+
+VulkanAllocation
+VulkanMemoryAllocator::allocateBuffer(VkBuffer buffer,
+                                      VkMemoryPropertyFlags properties)
+{
+    VkMemoryRequirements requirements;
+    vkGetBufferMemoryRequirements(_device, buffer, &requirements);
+
+    auto allocation = _allocate(requirements, properties, BlockKind::BUFFER);
+    vkBindBufferMemory(_device, buffer, allocation.memory, allocation.offset);
+    _update_peak_statistics();
+    return (allocation);
+}
+
+VulkanAllocation
+VulkanMemoryAllocator::allocateImage(VkImage image,
+                                     VkMemoryPropertyFlags properties)
+{
+    VkMemoryRequirements requirements;
+    vkGetImageMemoryRequirements(_device, image, &requirements);
+
+    auto kind =
+      (_buffer_image_granularity > 1) ? BlockKind::IMAGE : BlockKind::BUFFER;
+    auto allocation = _allocate(requirements, properties, kind);
+    vkBindImageMemory(_device, image, allocation.memory, allocation.offset);
+    _update_peak_statistics();
+    return (allocation);
+}
+
+VulkanAllocation
+VulkanMemoryAllocator::allocateTransientBuffer(
+  VkBuffer buffer,
+  VkMemoryPropertyFlags properties)
+{
+    VkMemoryRequirements requirements;
+    vkGetBufferMemoryRequirements(_device, buffer, &requirements);
+
+    auto allocation =
+      _allocate(requirements, properties, BlockKind::TRANSIENT);
+    vkBindBufferMemory(_device, buffer, allocation.memory, allocation.offset);
+    _update_peak_statistics();
+    return (allocation);
+}
+
+void
+VulkanMemoryAllocator::free(VulkanAllocation &allocation)
+{
+    if (!allocation.memory) {
+        return;
+    }
+
+    auto &pool = _pools[allocation.memory_type];
+    auto block = std::find_if(pool.begin(),
+                              pool.end(),
+                              [&](Block const &it) -> bool {
+                                  return (it.memory == allocation.memory);
+                              });
+    if (block == pool.end()) {
+        throw std::runtime_error("VkMemoryAllocator: Unknown allocation");
+    }
+
+    block->used -= allocation.size;
+    --block->nb_allocations;
+    if (block->kind == BlockKind::TRANSIENT) {
+        if (!block->nb_allocations) {
+            block->linear_offset = 0;
+        }
+    } else if (!block->dedicated) {
+        _release_range(*block, allocation.offset, allocation.size);
+    }
+    allocation = {};
+
+    // One empty block per kind is kept to avoid allocation thrashing
+    if (block->nb_allocations) {
+        return;
+    }
+    auto kind = block->kind;
+    bool has_other_empty = std::any_of(
+      pool.begin(), pool.end(), [&](Block const &it) -> bool {
+          return (&it != &(*block) && !it.dedicated && it.kind == kind &&
+                  !it.nb_allocations);
+      });
+    if (block->dedicated || has_other_empty) {
+        _destroy_block(*block);
+        pool.erase(block);
+    }
+}
+
+void
+VulkanMemoryAllocator::flush(VulkanAllocation const &allocation,
+                             VkDeviceSize offset,
+                             VkDeviceSize size) const
+{
+    if (isHostCoherent(allocation)) {
+        return;
+    }
+
+    // Non coherent allocations are atom aligned, rounding stays inside
+    auto begin = (allocation.offset + offset) / _non_coherent_atom_size *
+                 _non_coherent_atom_size;
+    auto end = (allocation.offset + offset + size + _non_coherent_atom_size -
+                1) /
+               _non_coherent_atom_size * _non_coherent_atom_size;
+    VkMappedMemoryRange range{};
+    range.sType = VK_STRUCTURE_TYPE_MAPPED_MEMORY_RANGE;
+    range.memory = allocation.memory;
+    range.offset = begin;
+    range.size = end - begin;
+    vkFlushMappedMemoryRanges(_device, 1, &range);
+}
+
+void
+VulkanMemoryAllocator::invalidate(VulkanAllocation const &allocation,
+                                  VkDeviceSize offset,
+                                  VkDeviceSize size) const
+{
+    if (isHostCoherent(allocation)) {
+        return;
+    }
+
+    auto begin = (allocation.offset + offset) / _non_coherent_atom_size *
+                 _non_coherent_atom_size;
+    auto end = (allocation.offset + offset + size + _non_coherent_atom_size -
+                1) /
+               _non_coherent_atom_size * _non_coherent_atom_size;
+    VkMappedMemoryRange range{};
+    range.sType = VK_STRUCTURE_TYPE_MAPPED_MEMORY_RANGE;
+    range.memory = allocation.memory;
+    range.offset = begin;
+    range.size = end - begin;
+    vkInvalidateMappedMemoryRanges(_device, 1, &range);
+}
+
+bool
+VulkanMemoryAllocator::isHostCoherent(VulkanAllocation const &allocation) const
+{
+    return (_memory_properties.memoryTypes[allocation.memory_type]
+              .propertyFlags &
+            VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+}
+
+VulkanMemoryStatistics
+VulkanMemoryAllocator::getStatistics() const
+{
+    VulkanMemoryStatistics stats{};
+
+    for (auto const &pool : _pools) {
+        for (auto const &it : pool) {
+            _add_block_statistics(it, stats);
+        }
+    }
+    return (stats);
+}
+
+VulkanMemoryStatistics
+VulkanMemoryAllocator::getHeapStatistics(uint32_t heapIndex) const
+{
+    VulkanMemoryStatistics stats{};
+
+    for (uint32_t i = 0; i < _memory_properties.memoryTypeCount; ++i) {
+        if (_memory_properties.memoryTypes[i].heapIndex != heapIndex) {
+            continue;
+        }
+        for (auto const &it : _pools[i]) {
+            _add_block_statistics(it, stats);
+        }
+    }
+    return (stats);
+}
+
+VulkanMemoryStatistics
+VulkanMemoryAllocator::getPeakStatistics() const
+{
+    return (_peak_statistics);
+}
+
+uint32_t
+VulkanMemoryAllocator::getNbHeaps() const
+{
+    return (_memory_properties.memoryHeapCount);
+}
+
+bool
+VulkanMemoryAllocator::hasMemoryBudget() const
+{
+    return (_memory_budget);
+}
+
+std::vector<VulkanHeapBudget>
+VulkanMemoryAllocator::getHeapBudgets() const
+{
+    std::vector<VulkanHeapBudget> heaps(_memory_properties.memoryHeapCount);
+
+    VkPhysicalDeviceMemoryBudgetPropertiesEXT budget_props{};
+    budget_props.sType =
+      VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MEMORY_BUDGET_PROPERTIES_EXT;
+    if (_memory_budget) {
+        // Budgets change over time, they are queried on each call
+        VkPhysicalDeviceMemoryProperties2 props_2{};
+        props_2.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MEMORY_PROPERTIES_2;
+        props_2.pNext = &budget_props;
+        vkGetPhysicalDeviceMemoryProperties2(_physical_device, &props_2);
+    }
+    for (uint32_t i = 0; i < heaps.size(); ++i) {
+        auto const &heap = _memory_properties.memoryHeaps[i];
+        heaps[i].size = heap.size;
+        heaps[i].device_local = heap.flags & VK_MEMORY_HEAP_DEVICE_LOCAL_BIT;
+        if (_memory_budget) {
+            heaps[i].budget = budget_props.heapBudget[i];
+            heaps[i].usage = budget_props.heapUsage[i];
+        } else {
+            heaps[i].budget = heap.size;
+            heaps[i].usage = getHeapStatistics(i).allocated_size;
+        }
+    }
+    return (heaps);
+}
+
+VulkanAllocation
+VulkanMemoryAllocator::_allocate(VkMemoryRequirements requirements,
+                                 VkMemoryPropertyFlags properties,
+                                 BlockKind kind)
+{
+    VulkanAllocation allocation{};
+    allocation.memory_type = findMemoryType(
+      _physical_device, requirements.memoryTypeBits, properties);
+    auto &pool = _pools[allocation.memory_type];
+
+    // Flushed ranges are rounded to atoms, they must not reach neighbours
+    auto flags = _memory_properties.memoryTypes[allocation.memory_type]
+                   .propertyFlags;
+    if ((flags & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT) &&
+        !(flags & VK_MEMORY_PROPERTY_HOST_COHERENT_BIT)) {
+        requirements.alignment =
+          std::max(requirements.alignment, _non_coherent_atom_size);
+        requirements.size = (requirements.size + _non_coherent_atom_size - 1) /
+                            _non_coherent_atom_size * _non_coherent_atom_size;
+    }
+
+    // Big resources would waste most of a block, they get their own
+    if (requirements.size > _block_size / 2) {
+        auto index = _create_block(
+          allocation.memory_type, requirements.size, kind, true);
+        auto &block = pool[index];
+        block.used = requirements.size;
+        block.nb_allocations = 1;
+        allocation.memory = block.memory;
+        allocation.size = requirements.size;
+        allocation.mapped = block.mapped;
+        return (allocation);
+    }
+
+    for (auto &it : pool) {
+        if (!it.dedicated && it.kind == kind &&
+            _sub_allocate(it, requirements, allocation)) {
+            return (allocation);
+        }
+    }
+    auto index =
+      _create_block(allocation.memory_type, _block_size, kind, false);
+    _sub_allocate(pool[index], requirements, allocation);
+    return (allocation);
+}
+
+size_t
+VulkanMemoryAllocator::_create_block(uint32_t memory_type,
+                                     VkDeviceSize size,
+                                     BlockKind kind,
+                                     bool dedicated)
+{
+    Block block{};
+    block.size = size;
+    block.kind = kind;
+    block.dedicated = dedicated;
+    if (!dedicated && kind != BlockKind::TRANSIENT) {
+        block.free_ranges.push_back({ 0, size });
+    }
+
+    VkMemoryAllocateInfo alloc_info{};
+    alloc_info.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+    alloc_info.allocationSize = size;
+    alloc_info.memoryTypeIndex = memory_type;
+    if (vkAllocateMemory(_device, &alloc_info, nullptr, &block.memory) !=
+        VK_SUCCESS) {
+        throw std::runtime_error("VkMemoryAllocator: Failed to allocate "
+                                 "memory");
+    }
+    if (_memory_properties.memoryTypes[memory_type].propertyFlags &
+        VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT) {
+        if (vkMapMemory(_device, block.memory, 0, size, 0, &block.mapped) !=
+            VK_SUCCESS) {
+            vkFreeMemory(_device, block.memory, nullptr);
+            throw std::runtime_error("VkMemoryAllocator: Failed to map "
+                                     "memory");
+        }
+    }
+
+    auto &pool = _pools[memory_type];
+    pool.emplace_back(std::move(block));
+    return (pool.size() - 1);
+}
+
+void
+VulkanMemoryAllocator::_destroy_block(Block &block)
+{
+    if (block.mapped) {
+        vkUnmapMemory(_device, block.memory);
+    }
+    vkFreeMemory(_device, block.memory, nullptr);
+    block.memory = nullptr;
+    block.mapped = nullptr;
+}
+
+void
+VulkanMemoryAllocator::_update_peak_statistics()
+{
+    auto stats = getStatistics();
+    _peak_statistics.nb_blocks =
+      std::max(_peak_statistics.nb_blocks, stats.nb_blocks);
+    _peak_statistics.nb_allocations =
+      std::max(_peak_statistics.nb_allocations, stats.nb_allocations);
+    _peak_statistics.allocated_size =
+      std::max(_peak_statistics.allocated_size, stats.allocated_size);
+    _peak_statistics.used_size =
+      std::max(_peak_statistics.used_size, stats.used_size);
+}
+
+bool
+VulkanMemoryAllocator::_sub_allocate(Block &block,
+                                     VkMemoryRequirements const &requirements,
+                                     VulkanAllocation &allocation)
+{
+    auto align = [&](VkDeviceSize offset) -> VkDeviceSize {
+        return ((offset + requirements.alignment - 1) /
+                requirements.alignment * requirements.alignment);
+    };
+    VkDeviceSize offset{};
+
+    if (block.kind == BlockKind::TRANSIENT) {
+        offset = align(block.linear_offset);
+        if (offset + requirements.size > block.size) {
+            return (false);
+        }
+        block.linear_offset = offset + requirements.size;
+    } else {
+        // First fit, padding in front of the allocation stays free
+        auto range = std::find_if(
+          block.free_ranges.begin(),
+          block.free_ranges.end(),
+          [&](FreeRange const &it) -> bool {
+              return (align(it.offset) + requirements.size <=
+                      it.offset + it.size);
+          });
+        if (range == block.free_ranges.end()) {
+            return (false);
+        }
+        offset = align(range->offset);
+        auto range_end = range->offset + range->size;
+        auto alloc_end = offset + requirements.size;
+        if (offset > range->offset) {
+            range->size = offset - range->offset;
+            if (alloc_end < range_end) {
+                block.free_ranges.insert(range + 1,
+                                         { alloc_end, range_end - alloc_end });
+            }
+        } else if (alloc_end < range_end) {
+            range->offset = alloc_end;
+            range->size = range_end - alloc_end;
+        } else {
+            block.free_ranges.erase(range);
+        }
+    }
+
+    block.used += requirements.size;
+    ++block.nb_allocations;
+    allocation.memory = block.memory;
+    allocation.offset = offset;
+    allocation.size = requirements.size;
+    allocation.mapped =
+      (block.mapped) ? static_cast<uint8_t *>(block.mapped) + offset : nullptr;
+    return (true);
+}
+
+void
+VulkanMemoryAllocator::_release_range(Block &block,
+                                      VkDeviceSize offset,
+                                      VkDeviceSize size)
+{
+    auto next = std::find_if(
+      block.free_ranges.begin(),
+      block.free_ranges.end(),
+      [&](FreeRange const &it) -> bool { return (it.offset > offset); });
+    auto range = block.free_ranges.insert(next, { offset, size });
+
+    // Merge with neighbours
+    auto after = range + 1;
+    if (after != block.free_ranges.end() &&
+        range->offset + range->size == after->offset) {
+        range->size += after->size;
+        range = block.free_ranges.erase(after) - 1;
+    }
+    if (range != block.free_ranges.begin()) {
+        auto before = range - 1;
+        if (before->offset + before->size == range->offset) {
+            before->size += range->size;
+            block.free_ranges.erase(range);
+        }
+    }
+}
+
+void
+VulkanMemoryAllocator::_add_block_statistics(Block const &block,
+                                             VulkanMemoryStatistics &stats)
+{
+    ++stats.nb_blocks;
+    stats.nb_allocations += block.nb_allocations;
+    stats.allocated_size += block.size;
+    stats.used_size += block.used;
+}
@@ -1,6 +1,7 @@
 #include "VulkanPhysicalDevice.hpp"
 
 #include <map>
+#include <algorithm>
 #include <cstring>
 #include <cassert>
 #include <set>
@@ -116,6 +117,44 @@ checkDeviceFeaturesSupport(VkPhysicalDevice device, DeviceRequirement &dr)
     if (features.samplerAnisotropy) {
         dr.sampler_aniso = VK_TRUE;
     }
+    if (features.multiDrawIndirect) {
+        dr.multi_draw_indirect = VK_TRUE;
+    }
+    if (features.drawIndirectFirstInstance) {
+        dr.draw_indirect_first_instance = VK_TRUE;
+    }
+    if (features.textureCompressionBC) {
+        dr.texture_compression_bc = VK_TRUE;
+    }
+    if (features.shaderSampledImageArrayDynamicIndexing) {
+        dr.sampled_image_dynamic_indexing = VK_TRUE;
+    }
+
+    // Vulkan 1.2 features can only be queried on 1.2 devices
+    VkPhysicalDeviceProperties properties;
+    vkGetPhysicalDeviceProperties(device, &properties);
+    if (properties.apiVersion < VK_API_VERSION_1_2) {
+        return;
+    }
+    VkPhysicalDeviceVulkan11Features features_11{};
+    features_11.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_1_FEATURES;
+    VkPhysicalDeviceVulkan12Features features_12{};
+    features_12.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES;
+    features_12.pNext = &features_11;
+    VkPhysicalDeviceFeatures2 features_2{};
+    features_2.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
+    features_2.pNext = &features_12;
+    vkGetPhysicalDeviceFeatures2(device, &features_2);
+    if (features_12.runtimeDescriptorArray &&
+        features_12.descriptorBindingPartiallyBound) {
+        dr.descriptor_indexing = VK_TRUE;
+    }
+    if (features_12.drawIndirectCount) {
+        dr.draw_indirect_count = VK_TRUE;
+    }
+    if (features_11.shaderDrawParameters) {
+        dr.shader_draw_parameters = VK_TRUE;
+    }
 }
 
 void
@@ -133,6 +172,10 @@ checkDeviceExtensionSupport(VkPhysicalDevice device, DeviceRequirement &dr)
 
     for (auto const &supported_ext : vec_ext_prop) {
         req_extension.erase(supported_ext.extensionName);
+        if (!std::strcmp(supported_ext.extensionName,
+                         VK_EXT_MEMORY_BUDGET_EXTENSION_NAME)) {
+            dr.memory_budget = VK_TRUE;
+        }
     }
     dr.all_extension_supported = (req_extension.empty()) ? VK_TRUE : VK_FALSE;
 }
@@ -178,6 +221,56 @@ getMinUniformBufferOffsetAlignment(VkPhysicalDevice device)
     return (properties.limits.minUniformBufferOffsetAlignment);
 }
 
+VkDeviceSize
+getMinStorageBufferOffsetAlignment(VkPhysicalDevice device)
+{
+    VkPhysicalDeviceProperties properties;
+    vkGetPhysicalDeviceProperties(device, &properties);
+
+    return (properties.limits.minStorageBufferOffsetAlignment);
+}
+
+uint32_t
+getMaxDrawIndirectCount(VkPhysicalDevice device)
+{
+    VkPhysicalDeviceProperties properties;
+    vkGetPhysicalDeviceProperties(device, &properties);
+
+    return (properties.limits.maxDrawIndirectCount);
+}
+
+uint32_t
+getMaxStorageBufferRange(VkPhysicalDevice device)
+{
+    VkPhysicalDeviceProperties properties;
+    vkGetPhysicalDeviceProperties(device, &properties);
+
+    return (properties.limits.maxStorageBufferRange);
+}
+
+std::array<uint32_t, 3>
+getMaxComputeWorkGroupCount(VkPhysicalDevice device)
+{
+    VkPhysicalDeviceProperties properties;
+    vkGetPhysicalDeviceProperties(device, &properties);
+
+    return ({ properties.limits.maxComputeWorkGroupCount[0],
+              properties.limits.maxComputeWorkGroupCount[1],
+              properties.limits.maxComputeWorkGroupCount[2] });
+}
+
+uint32_t
+getMaxSampledImagesPerSet(VkPhysicalDevice device)
+{
+    VkPhysicalDeviceProperties properties;
+    vkGetPhysicalDeviceProperties(device, &properties);
+
+    return (std::min({ properties.limits.maxPerStageDescriptorSamplers,
+                       properties.limits.maxPerStageDescriptorSampledImages,
+                       properties.limits.maxDescriptorSetSamplers,
+                       properties.limits.maxDescriptorSetSampledImages }));
+}
+
 bool
 getLinearBlittingSupport(VkPhysicalDevice device, VkFormat imgFormat)
 {
@@ -0,0 +1,250 @@
+#include "VulkanStagingRing.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+
+#include "VulkanMemory.hpp"
+#include "VulkanCommandBuffer.hpp"
+
+void
+VulkanStagingRing::init(VkDevice device,
+                        VulkanMemoryAllocator &allocator,
+                        VkCommandPool commandPool,
+                        VkQueue queue,
+                        uint32_t nbFrames,
+                        VkDeviceSize size)
+{
+    _device = device;
+    _allocator = &allocator;
+    _command_pool = commandPool;
+    _queue = queue;
+    _size = size;
+
+    createBuffer(_device, _buffer, _size, VK_BUFFER_USAGE_TRANSFER_SRC_BIT);
+    _allocation = _allocator->allocateBuffer(
+      _buffer,
+      VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT |
+        VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+
+    _cmd_buffers.resize(nbFrames);
+    VkCommandBufferAllocateInfo alloc_info{};
+    alloc_info.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+    alloc_info.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+    alloc_info.commandPool = _command_pool;
+    alloc_info.commandBufferCount = _cmd_buffers.size();
+    if (vkAllocateCommandBuffers(_device, &alloc_info, _cmd_buffers.data()) !=
+        VK_SUCCESS) {
+        throw std::runtime_error(
+          "VkStagingRing: Failed to allocate command buffers");
+    }
+}
+
+void
+VulkanStagingRing::clear()
+{
+    if (!_cmd_buffers.empty()) {
+        vkFreeCommandBuffers(
+          _device, _command_pool, _cmd_buffers.size(), _cmd_buffers.data());
+    }
+    _cmd_buffers.clear();
+    vkDestroyBuffer(_device, _buffer, nullptr);
+    _allocator->free(_allocation);
+    _pending_copies.clear();
+    _pending_index.clear();
+    _in_flight.clear();
+    _device = nullptr;
+    _allocator = nullptr;
+    _command_pool = nullptr;
+    _queue = nullptr;
+    _buffer = nullptr;
+    _size = 0;
+    _head = 0;
+    _used = 0;
+    _pending_size = 0;
+}
+
+void
+VulkanStagingRing::upload(VkBuffer dstBuffer,
+                          VkDeviceSize dstOffset,
+                          void const *data,
+                          VkDeviceSize size)
+{
+    auto src = static_cast<uint8_t const *>(data);
+
+    // Uploads bigger than half the ring are split
+    while (size) {
+        auto chunk = std::min(size, _size / 2);
+        auto key = std::make_pair(dstBuffer, dstOffset);
+        auto pending = _pending_index.find(key);
+
+        if (pending != _pending_index.end() &&
+            _pending_copies[pending->second].region.size == chunk) {
+            auto const &region = _pending_copies[pending->second].region;
+            copyOnCpuCoherentMemory(_allocation, region.srcOffset, chunk, src);
+        } else {
+            // May submit pending copies, pending index is then cleared
+            auto offset = _reserve(chunk);
+            copyOnCpuCoherentMemory(_allocation, offset, chunk, src);
+            _pending_index[key] = _pending_copies.size();
+            _pending_copies.push_back(
+              { dstBuffer, { offset, dstOffset, chunk } });
+        }
+        src += chunk;
+        dstOffset += chunk;
+        size -= chunk;
+    }
+}
+
+void
+VulkanStagingRing::cancelUploads(VkBuffer dstBuffer)
+{
+    // Staging memory of canceled uploads is reclaimed with the next flush
+    std::erase_if(_pending_copies, [&](PendingCopy const &it) -> bool {
+        return (it.dst_buffer == dstBuffer);
+    });
+    _pending_index.clear();
+    for (size_t i = 0; i < _pending_copies.size(); ++i) {
+        auto const &it = _pending_copies[i];
+        _pending_index[{ it.dst_buffer, it.region.dstOffset }] = i;
+    }
+}
+
+void
+VulkanStagingRing::submitUploads()
+{
+    if (!_pending_copies.empty()) {
+        _submit_pending();
+    }
+}
+
+VkCommandBuffer
+VulkanStagingRing::flush(uint32_t frameIndex, VkFence fence)
+{
+    if (_pending_copies.empty()) {
+        return (nullptr);
+    }
+
+    auto cmd_buffer = _cmd_buffers[frameIndex];
+    vkResetCommandBuffer(cmd_buffer, 0);
+    VkCommandBufferBeginInfo begin_info{};
+    begin_info.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+    begin_info.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+    if (vkBeginCommandBuffer(cmd_buffer, &begin_info) != VK_SUCCESS) {
+        throw std::runtime_error(
+          "VkStagingRing: Failed to begin recording command buffer");
+    }
+    _record_copies(cmd_buffer);
+    if (vkEndCommandBuffer(cmd_buffer) != VK_SUCCESS) {
+        throw std::runtime_error(
+          "VkStagingRing: Failed to record command buffer");
+    }
+
+    _in_flight.push_back({ _pending_size, fence });
+    _pending_size = 0;
+    return (cmd_buffer);
+}
+
+VkDeviceSize
+VulkanStagingRing::getSize() const
+{
+    return (_size);
+}
+
+VkDeviceSize
+VulkanStagingRing::_reserve(VkDeviceSize size)
+{
+    while (true) {
+        if (!_used) {
+            _head = 0;
+        }
+
+        auto offset = (_head + ALIGNMENT - 1) / ALIGNMENT * ALIGNMENT;
+        auto needed = offset - _head + size;
+        // Space left at the end is skipped
+        if (offset + size > _size) {
+            offset = 0;
+            needed = _size - _head + size;
+        }
+        if (_used + needed <= _size) {
+            _head = offset + size;
+            _used += needed;
+            _pending_size += needed;
+            return (offset);
+        }
+
+        // Oldest flush first, pending uploads as last resort
+        if (!_in_flight.empty()) {
+            auto const &segment = _in_flight.front();
+            vkWaitForFences(_device, 1, &segment.fence, VK_TRUE, UINT64_MAX);
+            _used -= segment.size;
+            _in_flight.pop_front();
+        } else {
+            _submit_pending();
+        }
+    }
+}
+
+void
+VulkanStagingRing::_record_copies(VkCommandBuffer cmd_buffer)
+{
+    // Previous reads of destinations are done before they are overwritten
+    vkCmdPipelineBarrier(cmd_buffer,
+                         VK_PIPELINE_STAGE_ALL_COMMANDS_BIT,
+                         VK_PIPELINE_STAGE_TRANSFER_BIT,
+                         0,
+                         0,
+                         nullptr,
+                         0,
+                         nullptr,
+                         0,
+                         nullptr);
+
+    // One copy command per destination buffer
+    std::stable_sort(_pending_copies.begin(),
+                     _pending_copies.end(),
+                     [](PendingCopy const &a, PendingCopy const &b) -> bool {
+                         return (a.dst_buffer < b.dst_buffer);
+                     });
+    std::vector<VkBufferCopy> regions;
+    size_t i = 0;
+    while (i < _pending_copies.size()) {
+        auto dst_buffer = _pending_copies[i].dst_buffer;
+        regions.clear();
+        while (i < _pending_copies.size() &&
+               _pending_copies[i].dst_buffer == dst_buffer) {
+            regions.emplace_back(_pending_copies[i].region);
+            ++i;
+        }
+        vkCmdCopyBuffer(
+          cmd_buffer, _buffer, dst_buffer, regions.size(), regions.data());
+    }
+
+    VkMemoryBarrier barrier{};
+    barrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+    barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+    barrier.dstAccessMask = VK_ACCESS_MEMORY_READ_BIT;
+    vkCmdPipelineBarrier(cmd_buffer,
+                         VK_PIPELINE_STAGE_TRANSFER_BIT,
+                         VK_PIPELINE_STAGE_ALL_COMMANDS_BIT,
+                         0,
+                         1,
+                         &barrier,
+                         0,
+                         nullptr,
+                         0,
+                         nullptr);
+    _pending_copies.clear();
+    _pending_index.clear();
+}
+
+void
+VulkanStagingRing::_submit_pending()
+{
+    // Waits for the queue to be idle, every flush is then done as well
+    auto cmd_buffer = beginSingleTimeCommands(_device, _command_pool);
+    _record_copies(cmd_buffer);
+    endSingleTimeCommands(_device, _command_pool, cmd_buffer, _queue);
+    _in_flight.clear();
+    _used = 0;
+    _pending_size = 0;
+}
@@ -0,0 +1,334 @@
+#include "VulkanTextureCache.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <random>
+#include <stdexcept>
+#include <system_error>
+
+#include "fmt/core.h"
+
+// KTX2 layout, see Khronos KTX File Format Specification 2.0
+static constexpr uint8_t const KTX2_IDENTIFIER[12] = {
+    0xAB, 0x4B, 0x54, 0x58, 0x20, 0x32, 0x30, 0xBB, 0x0D, 0x0A, 0x1A, 0x0A
+};
+
+struct Ktx2Header final
+{
+    uint8_t identifier[12];
+    uint32_t vk_format;
+    uint32_t type_size;
+    uint32_t pixel_width;
+    uint32_t pixel_height;
+    uint32_t pixel_depth;
+    uint32_t layer_count;
+    uint32_t face_count;
+    uint32_t level_count;
+    uint32_t supercompression_scheme;
+    uint32_t dfd_byte_offset;
+    uint32_t dfd_byte_length;
+    uint32_t kvd_byte_offset;
+    uint32_t kvd_byte_length;
+    uint64_t sgd_byte_offset;
+    uint64_t sgd_byte_length;
+};
+static_assert(sizeof(Ktx2Header) == 80);
+
+struct Ktx2Level final
+{
+    uint64_t byte_offset;
+    uint64_t byte_length;
+    uint64_t uncompressed_byte_length;
+};
+
+// Data format descriptor values
+static constexpr uint8_t const KHR_DF_MODEL_BC1A = 128;
+static constexpr uint8_t const KHR_DF_MODEL_BC3 = 130;
+static constexpr uint8_t const KHR_DF_MODEL_BC5 = 132;
+static constexpr uint8_t const KHR_DF_PRIMARIES_BT709 = 1;
+static constexpr uint8_t const KHR_DF_TRANSFER_LINEAR = 1;
+static constexpr uint8_t const KHR_DF_TRANSFER_SRGB = 2;
+static constexpr uint8_t const KHR_DF_CHANNEL_RED = 0;
+static constexpr uint8_t const KHR_DF_CHANNEL_GREEN = 1;
+static constexpr uint8_t const KHR_DF_CHANNEL_ALPHA = 15;
+
+static std::vector<uint32_t>
+textureCacheBuildDfd(VkFormat format)
+{
+    uint8_t model;
+    uint8_t transfer = KHR_DF_TRANSFER_SRGB;
+    std::vector<uint8_t> channels;
+    switch (format) {
+        case VK_FORMAT_BC1_RGB_SRGB_BLOCK:
+            model = KHR_DF_MODEL_BC1A;
+            channels = { KHR_DF_CHANNEL_RED };
+            break;
+        case VK_FORMAT_BC3_SRGB_BLOCK:
+            model = KHR_DF_MODEL_BC3;
+            channels = { KHR_DF_CHANNEL_ALPHA, KHR_DF_CHANNEL_RED };
+            break;
+        case VK_FORMAT_BC5_UNORM_BLOCK:
+            model = KHR_DF_MODEL_BC5;
+            transfer = KHR_DF_TRANSFER_LINEAR;
+            channels = { KHR_DF_CHANNEL_RED, KHR_DF_CHANNEL_GREEN };
+            break;
+        default:
+            throw std::runtime_error("Unsupported format");
+    }
+
+    // Total size, then one basic descriptor block with one 64 bits sample
+    // per channel
+    uint32_t block_size = 24 + 16 * channels.size();
+    std::vector<uint32_t> dfd;
+    dfd.emplace_back(4 + block_size);
+    dfd.emplace_back(0);
+    dfd.emplace_back(2 | (block_size << 16));
+    dfd.emplace_back(model | (KHR_DF_PRIMARIES_BT709 << 8) | (transfer << 16));
+    // Texel block dimensions minus one
+    dfd.emplace_back(3 | (3 << 8));
+    dfd.emplace_back(getCompressedBlockSize(format));
+    dfd.emplace_back(0);
+    for (uint32_t i = 0; i < channels.size(); ++i) {
+        dfd.emplace_back((i * 64) | (63 << 16) | (channels[i] << 24));
+        dfd.emplace_back(0);
+        dfd.emplace_back(0);
+        dfd.emplace_back(UINT32_MAX);
+    }
+    return (dfd);
+}
+
+std::string
+textureCacheGetPath(std::string const &texture_path)
+{
+    return (texture_path + TEXTURE_CACHE_EXTENSION);
+}
+
+bool
+textureCacheGetSource(std::string const &texture_path,
+                      bool normal_map,
+                      TextureCacheSource &source)
+{
+    std::error_code ec;
+
+    source = {};
+    source.version = TEXTURE_CACHE_VERSION;
+    source.normal_map = normal_map;
+    source.size = std::filesystem::file_size(texture_path, ec);
+    if (ec) {
+        return (false);
+    }
+    source.mtime = std::filesystem::last_write_time(texture_path, ec)
+                     .time_since_epoch()
+                     .count();
+    return (!ec);
+}
+
+bool
+textureCacheLoad(std::string const &texture_path,
+                 bool normal_map,
+                 CompressedTexture &dst)
+{
+    auto cache_path = textureCacheGetPath(texture_path);
+    std::error_code ec;
+    TextureCacheSource source{};
+    if (!std::filesystem::exists(cache_path, ec) ||
+        !textureCacheGetSource(texture_path, normal_map, source)) {
+        return (false);
+    }
+
+    std::ifstream ifs(cache_path, std::ios::binary | std::ios::ate);
+    if (!ifs.is_open()) {
+        return (false);
+    }
+    std::vector<uint8_t> file(static_cast<size_t>(ifs.tellg()));
+    ifs.seekg(0);
+    ifs.read(reinterpret_cast<char *>(file.data()), file.size());
+    if (!ifs || file.size() < sizeof(Ktx2Header)) {
+        return (false);
+    }
+    auto in_file = [&](uint64_t offset, uint64_t size) -> bool {
+        return (offset <= file.size() && size <= file.size() - offset);
+    };
+
+    // Header
+    Ktx2Header header{};
+    std::memcpy(&header, file.data(), sizeof(Ktx2Header));
+    auto format = static_cast<VkFormat>(header.vk_format);
+    if (std::memcmp(header.identifier, KTX2_IDENTIFIER, 12) ||
+        (format != VK_FORMAT_BC1_RGB_SRGB_BLOCK &&
+         format != VK_FORMAT_BC3_SRGB_BLOCK &&
+         format != VK_FORMAT_BC5_UNORM_BLOCK) ||
+        (format == VK_FORMAT_BC5_UNORM_BLOCK) != normal_map ||
+        !header.pixel_width || !header.pixel_height ||
+        header.supercompression_scheme ||
+        header.level_count !=
+          getTextureMipLevels(header.pixel_width, header.pixel_height) ||
+        !in_file(sizeof(Ktx2Header),
+                 header.level_count * sizeof(Ktx2Level)) ||
+        !in_file(header.kvd_byte_offset, header.kvd_byte_length)) {
+        return (false);
+    }
+
+    // Source check, stored as key value data
+    bool valid_source = false;
+    for (uint32_t offset = 0; offset + 4 <= header.kvd_byte_length;) {
+        uint32_t entry_size;
+        auto entry = file.data() + header.kvd_byte_offset + offset;
+        std::memcpy(&entry_size, entry, 4);
+        if (entry_size > header.kvd_byte_length - offset - 4) {
+            break;
+        }
+        auto key_size = std::strlen(TEXTURE_CACHE_KEY) + 1;
+        if (entry_size == key_size + sizeof(TextureCacheSource) &&
+            !std::memcmp(entry + 4, TEXTURE_CACHE_KEY, key_size)) {
+            TextureCacheSource stored{};
+            std::memcpy(&stored, entry + 4 + key_size, sizeof(stored));
+            valid_source = !std::memcmp(&stored, &source, sizeof(source));
+            break;
+        }
+        offset += (4 + entry_size + 3) / 4 * 4;
+    }
+    if (!valid_source) {
+        return (false);
+    }
+
+    // Levels, level 0 first
+    dst = {};
+    dst.format = format;
+    dst.width = header.pixel_width;
+    dst.height = header.pixel_height;
+    dst.level_offsets.resize(header.level_count);
+    dst.level_sizes.resize(header.level_count);
+    VkDeviceSize total_size = 0;
+    for (uint32_t i = 0; i < header.level_count; ++i) {
+        Ktx2Level level{};
+        std::memcpy(&level,
+                    file.data() + sizeof(Ktx2Header) + i * sizeof(Ktx2Level),
+                    sizeof(Ktx2Level));
+        auto expected_size =
+          getCompressedLevelSize(format,
+                                 std::max(dst.width >> i, 1u),
+                                 std::max(dst.height >> i, 1u));
+        if (level.byte_length != expected_size ||
+            !in_file(level.byte_offset, level.byte_length)) {
+            return (false);
+        }
+        dst.level_offsets[i] = total_size;
+        dst.level_sizes[i] = level.byte_length;
+        total_size += level.byte_length;
+    }
+    dst.data.resize(total_size);
+    for (uint32_t i = 0; i < header.level_count; ++i) {
+        Ktx2Level level{};
+        std::memcpy(&level,
+                    file.data() + sizeof(Ktx2Header) + i * sizeof(Ktx2Level),
+                    sizeof(Ktx2Level));
+        std::memcpy(dst.data.data() + dst.level_offsets[i],
+                    file.data() + level.byte_offset,
+                    level.byte_length);
+    }
+    return (true);
+}
+
+// Unique per call, concurrent writers never share a temporary file
+static std::string
+textureCacheGetTmpPath(std::string const &cache_path)
+{
+    std::random_device rd;
+    return (fmt::format("{}.{:08x}{:08x}.tmp", cache_path, rd(), rd()));
+}
+
+void
+textureCacheWrite(std::string const &texture_path,
+                  bool normal_map,
+                  CompressedTexture const &src)
+{
+    std::string tmp_path;
+    try {
+        TextureCacheSource source{};
+        if (!textureCacheGetSource(texture_path, normal_map, source)) {
+            throw std::runtime_error("Failed to stat: " + texture_path);
+        }
+        auto cache_path = textureCacheGetPath(texture_path);
+        auto nb_levels = static_cast<uint32_t>(src.level_sizes.size());
+        auto dfd = textureCacheBuildDfd(src.format);
+
+        // Key value data
+        auto key_size = std::strlen(TEXTURE_CACHE_KEY) + 1;
+        uint32_t kvd_entry_size = key_size + sizeof(TextureCacheSource);
+        std::vector<uint8_t> kvd((4 + kvd_entry_size + 3) / 4 * 4);
+        std::memcpy(kvd.data(), &kvd_entry_size, 4);
+        std::memcpy(kvd.data() + 4, TEXTURE_CACHE_KEY, key_size);
+        std::memcpy(
+          kvd.data() + 4 + key_size, &source, sizeof(TextureCacheSource));
+
+        Ktx2Header header{};
+        std::memcpy(header.identifier, KTX2_IDENTIFIER, 12);
+        header.vk_format = src.format;
+        header.type_size = 1;
+        header.pixel_width = src.width;
+        header.pixel_height = src.height;
+        header.face_count = 1;
+        header.level_count = nb_levels;
+        header.dfd_byte_offset =
+          sizeof(Ktx2Header) + nb_levels * sizeof(Ktx2Level);
+        header.dfd_byte_length = dfd.size() * sizeof(uint32_t);
+        header.kvd_byte_offset =
+          header.dfd_byte_offset + header.dfd_byte_length;
+        header.kvd_byte_length = kvd.size();
+
+        // Level data is stored from the smallest level to the largest one
+        static constexpr uint64_t const LEVEL_ALIGNMENT = 16;
+        std::vector<Ktx2Level> levels(nb_levels);
+        uint64_t offset = header.kvd_byte_offset + header.kvd_byte_length;
+        offset = (offset + LEVEL_ALIGNMENT - 1) / LEVEL_ALIGNMENT *
+                 LEVEL_ALIGNMENT;
+        for (uint32_t i = nb_levels; i-- > 0;) {
+            levels[i].byte_offset = offset;
+            levels[i].byte_length = src.level_sizes[i];
+            levels[i].uncompressed_byte_length = src.level_sizes[i];
+            offset += src.level_sizes[i];
+        }
+
+        // Written in a temporary file so readers never load a partial cache
+        tmp_path = textureCacheGetTmpPath(cache_path);
+        std::ofstream ofs(tmp_path, std::ios::binary | std::ios::trunc);
+        if (!ofs.is_open()) {
+            throw std::runtime_error("Failed to open: " + tmp_path);
+        }
+        auto write_at =
+          [&](uint64_t at, void const *data, size_t size) -> void {
+            static constexpr char const PADDING[LEVEL_ALIGNMENT] = {};
+            if (!ofs) {
+                return;
+            }
+            auto pos = static_cast<uint64_t>(ofs.tellp());
+            ofs.write(PADDING, at - pos);
+            ofs.write(static_cast<char const *>(data), size);
+        };
+        write_at(0, &header, sizeof(Ktx2Header));
+        write_at(sizeof(Ktx2Header),
+                 levels.data(),
+                 levels.size() * sizeof(Ktx2Level));
+        write_at(header.dfd_byte_offset, dfd.data(), header.dfd_byte_length);
+        write_at(header.kvd_byte_offset, kvd.data(), kvd.size());
+        for (uint32_t i = nb_levels; i-- > 0;) {
+            write_at(levels[i].byte_offset,
+                     src.data.data() + src.level_offsets[i],
+                     src.level_sizes[i]);
+        }
+        ofs.close();
+        if (!ofs) {
+            throw std::runtime_error("Failed to write: " + tmp_path);
+        }
+        std::filesystem::rename(tmp_path, cache_path);
+    } catch (std::exception const &e) {
+        fmt::print(stderr, "VkTextureCache: {}\n", e.what());
+        if (!tmp_path.empty()) {
+            std::error_code ec;
+            std::filesystem::remove(tmp_path, ec);
+        }
+    }
+}
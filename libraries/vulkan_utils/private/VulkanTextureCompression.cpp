@@ -0,0 +1,339 @@
+#include "VulkanTextureCompression.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <stdexcept>
+
+void
+compressTexture(std::span<uint8_t const> pixels,
+                uint32_t width,
+                uint32_t height,
+                bool normal_map,
+                CompressedTexture &dst)
+{
+    if (!width || !height ||
+        pixels.size() < static_cast<size_t>(width) * height * 4) {
+        throw std::runtime_error("VkTextureCompression: invalid image");
+    }
+
+    bool opaque = true;
+    for (size_t i = 3; i < pixels.size(); i += 4) {
+        if (pixels[i] != 255) {
+            opaque = false;
+            break;
+        }
+    }
+    if (normal_map) {
+        dst.format = VK_FORMAT_BC5_UNORM_BLOCK;
+    } else {
+        dst.format =
+          (opaque) ? VK_FORMAT_BC1_RGB_SRGB_BLOCK : VK_FORMAT_BC3_SRGB_BLOCK;
+    }
+    dst.width = width;
+    dst.height = height;
+
+    // Level offsets first, blocks of every level are written in place
+    auto nb_levels = getTextureMipLevels(width, height);
+    dst.level_offsets.resize(nb_levels);
+    dst.level_sizes.resize(nb_levels);
+    VkDeviceSize total_size = 0;
+    for (uint32_t i = 0; i < nb_levels; ++i) {
+        dst.level_offsets[i] = total_size;
+        dst.level_sizes[i] = getCompressedLevelSize(
+          dst.format, std::max(width >> i, 1u), std::max(height >> i, 1u));
+        total_size += dst.level_sizes[i];
+    }
+    dst.data.resize(total_size);
+
+    auto block_size = getCompressedBlockSize(dst.format);
+    // Level 0 is read in place, following levels are generated
+    std::span<uint8_t const> level = pixels;
+    std::vector<uint8_t> level_pixels;
+    std::vector<uint8_t> next_level;
+    std::array<uint8_t, 64> block{};
+    uint32_t level_w = width;
+    uint32_t level_h = height;
+    for (uint32_t i = 0; i < nb_levels; ++i) {
+        auto out = dst.data.data() + dst.level_offsets[i];
+        for (uint32_t by = 0; by < level_h; by += 4) {
+            for (uint32_t bx = 0; bx < level_w; bx += 4) {
+                // Border blocks repeat the last row and column
+                for (uint32_t y = 0; y < 4; ++y) {
+                    auto src_y = std::min(by + y, level_h - 1);
+                    for (uint32_t x = 0; x < 4; ++x) {
+                        auto src_x = std::min(bx + x, level_w - 1);
+                        std::copy_n(
+                          level.data() +
+                            (static_cast<size_t>(src_y) * level_w + src_x) * 4,
+                          4,
+                          block.data() + (y * 4 + x) * 4);
+                    }
+                }
+
+                if (dst.format == VK_FORMAT_BC5_UNORM_BLOCK) {
+                    compressBc4Block(block.data(), 4, out);
+                    compressBc4Block(block.data() + 1, 4, out + 8);
+                } else if (dst.format == VK_FORMAT_BC3_SRGB_BLOCK) {
+                    compressBc4Block(block.data() + 3, 4, out);
+                    compressBc1Block(block.data(), out + 8);
+                } else {
+                    compressBc1Block(block.data(), out);
+                }
+                out += block_size;
+            }
+        }
+
+        if (i + 1 < nb_levels) {
+            buildTextureMip(level, level_w, level_h, !normal_map, next_level);
+            level_pixels.swap(next_level);
+            level = level_pixels;
+            level_w = std::max(level_w / 2, 1u);
+            level_h = std::max(level_h / 2, 1u);
+        }
+    }
+}
+
+uint32_t
+getTextureMipLevels(uint32_t width, uint32_t height)
+{
+    return (static_cast<uint32_t>(
+              std::floor(std::log2(std::max(width, height)))) +
+            1);
+}
+
+VkDeviceSize
+getCompressedBlockSize(VkFormat format)
+{
+    switch (format) {
+        case VK_FORMAT_BC1_RGB_SRGB_BLOCK:
+        case VK_FORMAT_BC1_RGB_UNORM_BLOCK:
+            return (8);
+        case VK_FORMAT_BC3_SRGB_BLOCK:
+        case VK_FORMAT_BC3_UNORM_BLOCK:
+        case VK_FORMAT_BC5_UNORM_BLOCK:
+            return (16);
+        default:
+            throw std::runtime_error(
+              "VkTextureCompression: unsupported format");
+    }
+}
+
+VkDeviceSize
+getCompressedLevelSize(VkFormat format, uint32_t width, uint32_t height)
+{
+    return (static_cast<VkDeviceSize>((width + 3) / 4) * ((height + 3) / 4) *
+            getCompressedBlockSize(format));
+}
+
+void
+buildTextureMip(std::span<uint8_t const> src,
+                uint32_t src_w,
+                uint32_t src_h,
+                bool srgb,
+                std::vector<uint8_t> &dst)
+{
+    static auto const to_linear = []() {
+        std::array<float, 256> lut{};
+        for (uint32_t i = 0; i < 256; ++i) {
+            auto c = static_cast<float>(i) / 255.0f;
+            lut[i] = (c <= 0.04045f)
+                       ? c / 12.92f
+                       : std::pow((c + 0.055f) / 1.055f, 2.4f);
+        }
+        return (lut);
+    }();
+    auto to_srgb = [](float c) -> uint8_t {
+        c = (c <= 0.0031308f) ? c * 12.92f
+                              : 1.055f * std::pow(c, 1.0f / 2.4f) - 0.055f;
+        return (static_cast<uint8_t>(
+          std::clamp(c * 255.0f + 0.5f, 0.0f, 255.0f)));
+    };
+
+    // Odd sizes drop their last row or column, as blitting does
+    auto dst_w = std::max(src_w / 2, 1u);
+    auto dst_h = std::max(src_h / 2, 1u);
+    dst.resize(static_cast<size_t>(dst_w) * dst_h * 4);
+    for (uint32_t y = 0; y < dst_h; ++y) {
+        for (uint32_t x = 0; x < dst_w; ++x) {
+            uint32_t const xs[2] = { std::min(x * 2, src_w - 1),
+                                     std::min(x * 2 + 1, src_w - 1) };
+            uint32_t const ys[2] = { std::min(y * 2, src_h - 1),
+                                     std::min(y * 2 + 1, src_h - 1) };
+            float sum[4] = {};
+            for (auto sy : ys) {
+                for (auto sx : xs) {
+                    auto texel =
+                      src.data() + (static_cast<size_t>(sy) * src_w + sx) * 4;
+                    for (uint32_t c = 0; c < 4; ++c) {
+                        sum[c] += (srgb && c < 3)
+                                    ? to_linear[texel[c]]
+                                    : static_cast<float>(texel[c]) / 255.0f;
+                    }
+                }
+            }
+
+            auto out = dst.data() + (static_cast<size_t>(y) * dst_w + x) * 4;
+            for (uint32_t c = 0; c < 4; ++c) {
+                auto avg = sum[c] * 0.25f;
+                out[c] = (srgb && c < 3)
+                           ? to_srgb(avg)
+                           : static_cast<uint8_t>(avg * 255.0f + 0.5f);
+            }
+        }
+    }
+}
+
+void
+compressBc1Block(uint8_t const *block, uint8_t *dst)
+{
+    // Principal axis of the block colors
+    float mean[3] = {};
+    for (uint32_t i = 0; i < 16; ++i) {
+        for (uint32_t c = 0; c < 3; ++c) {
+            mean[c] += block[i * 4 + c];
+        }
+    }
+    for (auto &it : mean) {
+        it /= 16.0f;
+    }
+    float cov[6] = {};
+    for (uint32_t i = 0; i < 16; ++i) {
+        float d[3];
+        for (uint32_t c = 0; c < 3; ++c) {
+            d[c] = block[i * 4 + c] - mean[c];
+        }
+        cov[0] += d[0] * d[0];
+        cov[1] += d[0] * d[1];
+        cov[2] += d[0] * d[2];
+        cov[3] += d[1] * d[1];
+        cov[4] += d[1] * d[2];
+        cov[5] += d[2] * d[2];
+    }
+    float axis[3] = { 1.0f, 1.0f, 1.0f };
+    for (uint32_t i = 0; i < 8; ++i) {
+        float next[3] = {
+            cov[0] * axis[0] + cov[1] * axis[1] + cov[2] * axis[2],
+            cov[1] * axis[0] + cov[3] * axis[1] + cov[4] * axis[2],
+            cov[2] * axis[0] + cov[4] * axis[1] + cov[5] * axis[2],
+        };
+        auto length = std::max(
+          { std::abs(next[0]), std::abs(next[1]), std::abs(next[2]) });
+        if (length <= 0.0f) {
+            break;
+        }
+        for (uint32_t c = 0; c < 3; ++c) {
+            axis[c] = next[c] / length;
+        }
+    }
+
+    // Endpoints are the extreme colors along the axis, slightly inset
+    float min_proj = 0.0f;
+    float max_proj = 0.0f;
+    for (uint32_t i = 0; i < 16; ++i) {
+        float proj = 0.0f;
+        for (uint32_t c = 0; c < 3; ++c) {
+            proj += (block[i * 4 + c] - mean[c]) * axis[c];
+        }
+        min_proj = std::min(min_proj, proj);
+        max_proj = std::max(max_proj, proj);
+    }
+    auto inset = (max_proj - min_proj) / 16.0f;
+    min_proj += inset;
+    max_proj -= inset;
+    float axis_sq = axis[0] * axis[0] + axis[1] * axis[1] + axis[2] * axis[2];
+    if (axis_sq <= 0.0f) {
+        axis_sq = 1.0f;
+    }
+    auto to_565 = [&](float proj) -> uint16_t {
+        uint32_t q[3];
+        uint32_t const max_q[3] = { 31, 63, 31 };
+        for (uint32_t c = 0; c < 3; ++c) {
+            auto v = std::clamp(
+              mean[c] + axis[c] * proj / axis_sq, 0.0f, 255.0f);
+            q[c] = static_cast<uint32_t>(v * max_q[c] / 255.0f + 0.5f);
+        }
+        return (static_cast<uint16_t>((q[0] << 11) | (q[1] << 5) | q[2]));
+    };
+    auto color0 = to_565(max_proj);
+    auto color1 = to_565(min_proj);
+    // color0 > color1 selects the 4 colors palette
+    if (color0 < color1) {
+        std::swap(color0, color1);
+    }
+
+    // Palette
+    auto expand = [](uint16_t color, int32_t *rgb) -> void {
+        auto r = (color >> 11) & 31;
+        auto g = (color >> 5) & 63;
+        auto b = color & 31;
+        rgb[0] = (r << 3) | (r >> 2);
+        rgb[1] = (g << 2) | (g >> 4);
+        rgb[2] = (b << 3) | (b >> 2);
+    };
+    int32_t palette[4][3];
+    expand(color0, palette[0]);
+    expand(color1, palette[1]);
+    for (uint32_t c = 0; c < 3; ++c) {
+        palette[2][c] = (2 * palette[0][c] + palette[1][c]) / 3;
+        palette[3][c] = (palette[0][c] + 2 * palette[1][c]) / 3;
+    }
+
+    uint32_t indices = 0;
+    if (color0 != color1) {
+        for (uint32_t i = 0; i < 16; ++i) {
+            int32_t best_dist = INT32_MAX;
+            uint32_t best = 0;
+            for (uint32_t j = 0; j < 4; ++j) {
+                int32_t dist = 0;
+                for (uint32_t c = 0; c < 3; ++c) {
+                    auto d = block[i * 4 + c] - palette[j][c];
+                    dist += d * d;
+                }
+                if (dist < best_dist) {
+                    best_dist = dist;
+                    best = j;
+                }
+            }
+            indices |= best << (i * 2);
+        }
+    }
+
+    dst[0] = color0 & 0xFF;
+    dst[1] = color0 >> 8;
+    dst[2] = color1 & 0xFF;
+    dst[3] = color1 >> 8;
+    for (uint32_t i = 0; i < 4; ++i) {
+        dst[4 + i] = (indices >> (i * 8)) & 0xFF;
+    }
+}
+
+void
+compressBc4Block(uint8_t const *values, uint32_t stride, uint8_t *dst)
+{
+    uint8_t min_value = 255;
+    uint8_t max_value = 0;
+    for (uint32_t i = 0; i < 16; ++i) {
+        min_value = std::min(min_value, values[i * stride]);
+        max_value = std::max(max_value, values[i * stride]);
+    }
+
+    // value0 > value1 selects the 8 values palette, step 0 is value0 and
+    // step 7 is value1, inner steps are stored as indices 2 to 7
+    uint64_t indices = 0;
+    if (max_value != min_value) {
+        auto range = static_cast<float>(max_value - min_value);
+        for (uint32_t i = 0; i < 16; ++i) {
+            auto step = static_cast<uint32_t>(
+              (max_value - values[i * stride]) * 7.0f / range + 0.5f);
+            uint64_t index = (step == 0) ? 0 : (step == 7) ? 1 : step + 1;
+            indices |= index << (i * 3);
+        }
+    }
+
+    dst[0] = max_value;
+    dst[1] = min_value;
+    for (uint32_t i = 0; i < 6; ++i) {
+        dst[2 + i] = (indices >> (i * 8)) & 0xFF;
+    }
+}
@@ -0,0 +1,338 @@
+#include "VulkanUploadBatch.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+
+#include "VulkanImage.hpp"
+#include "VulkanMemory.hpp"
+#include "VulkanCommandBuffer.hpp"
+#include "VulkanPhysicalDevice.hpp"
+
+void
+VulkanUploadBatch::init(VkPhysicalDevice physicalDevice,
+                        VkDevice device,
+                        VulkanMemoryAllocator &allocator,
+                        VkCommandPool commandPool,
+                        VkQueue queue)
+{
+    _physical_device = physicalDevice;
+    _device = device;
+    _allocator = &allocator;
+    _command_pool = commandPool;
+    _queue = queue;
+
+    VkFenceCreateInfo fence_info{};
+    fence_info.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
+    if (vkCreateFence(_device, &fence_info, nullptr, &_fence) != VK_SUCCESS) {
+        throw std::runtime_error("VkUploadBatch: Failed to create fence");
+    }
+}
+
+void
+VulkanUploadBatch::clear()
+{
+    if (_in_flight) {
+        vkWaitForFences(_device, 1, &_fence, VK_TRUE, UINT64_MAX);
+    }
+    _reset();
+    for (auto &it : _staging_blocks) {
+        vkDestroyBuffer(_device, it.buffer, nullptr);
+        _allocator->free(it.allocation);
+    }
+    _staging_blocks.clear();
+    vkDestroyFence(_device, _fence, nullptr);
+    _physical_device = nullptr;
+    _device = nullptr;
+    _allocator = nullptr;
+    _command_pool = nullptr;
+    _queue = nullptr;
+    _fence = nullptr;
+}
+
+void
+VulkanUploadBatch::uploadImage(VkImage image,
+                               VkFormat format,
+                               void const *data,
+                               VkDeviceSize size,
+                               uint32_t width,
+                               uint32_t height,
+                               uint32_t mipLevels,
+                               std::vector<VkDeviceSize> const &levelOffsets,
+                               uint32_t baseLevel)
+{
+    bool generate_mips =
+      levelOffsets.size() == 1 && mipLevels > 1 && !baseLevel;
+    if (generate_mips && !getLinearBlittingSupport(_physical_device, format)) {
+        throw std::runtime_error("VkUploadBatch: Linear Blitting not "
+                                 "supported for requested image format");
+    }
+
+    VkBuffer staging_buffer{};
+    auto staging_offset = _stage(data, size, staging_buffer);
+    _begin_cmd_buffer();
+
+    recordImageLayoutTransition(_cmd_buffer,
+                                image,
+                                format,
+                                mipLevels,
+                                VK_IMAGE_LAYOUT_UNDEFINED,
+                                VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL);
+    std::vector<VkBufferImageCopy> regions(levelOffsets.size());
+    for (uint32_t i = 0; i < regions.size(); ++i) {
+        auto &region = regions[i];
+        region.bufferOffset = staging_offset + levelOffsets[i];
+        region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+        region.imageSubresource.mipLevel = baseLevel + i;
+        region.imageSubresource.baseArrayLayer = 0;
+        region.imageSubresource.layerCount = 1;
+        region.imageOffset = { 0, 0, 0 };
+        region.imageExtent = { std::max(width >> (baseLevel + i), 1u),
+                               std::max(height >> (baseLevel + i), 1u),
+                               1 };
+    }
+    vkCmdCopyBufferToImage(_cmd_buffer,
+                           staging_buffer,
+                           image,
+                           VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                           regions.size(),
+                           regions.data());
+    if (generate_mips) {
+        recordGenerateMipmaps(_cmd_buffer,
+                              image,
+                              static_cast<int32_t>(width),
+                              static_cast<int32_t>(height),
+                              mipLevels);
+    } else {
+        recordImageLayoutTransition(_cmd_buffer,
+                                    image,
+                                    format,
+                                    mipLevels,
+                                    VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                                    VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+    }
+    ++_nb_pending_uploads;
+}
+
+void
+VulkanUploadBatch::uploadImageLevel(VkImage image,
+                                    VkFormat format,
+                                    void const *data,
+                                    VkDeviceSize size,
+                                    uint32_t width,
+                                    uint32_t height,
+                                    uint32_t level)
+{
+    VkBuffer staging_buffer{};
+    auto staging_offset = _stage(data, size, staging_buffer);
+    _begin_cmd_buffer();
+
+    recordImageLayoutTransition(_cmd_buffer,
+                                image,
+                                format,
+                                1,
+                                VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+                                VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                                level);
+    VkBufferImageCopy region{};
+    region.bufferOffset = staging_offset;
+    region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+    region.imageSubresource.mipLevel = level;
+    region.imageSubresource.baseArrayLayer = 0;
+    region.imageSubresource.layerCount = 1;
+    region.imageOffset = { 0, 0, 0 };
+    region.imageExtent = { std::max(width >> level, 1u),
+                           std::max(height >> level, 1u),
+                           1 };
+    vkCmdCopyBufferToImage(_cmd_buffer,
+                           staging_buffer,
+                           image,
+                           VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                           1,
+                           &region);
+    recordImageLayoutTransition(_cmd_buffer,
+                                image,
+                                format,
+                                1,
+                                VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                                VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+                                level);
+    ++_nb_pending_uploads;
+}
+
+void
+VulkanUploadBatch::uploadBuffer(VkBuffer buffer,
+                                VkDeviceSize offset,
+                                void const *data,
+                                VkDeviceSize size)
+{
+    VkBuffer staging_buffer{};
+    auto staging_offset = _stage(data, size, staging_buffer);
+    _begin_cmd_buffer();
+
+    VkBufferCopy region{};
+    region.srcOffset = staging_offset;
+    region.dstOffset = offset;
+    region.size = size;
+    vkCmdCopyBuffer(_cmd_buffer, staging_buffer, buffer, 1, &region);
+
+    VkMemoryBarrier barrier{};
+    barrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+    barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+    barrier.dstAccessMask = VK_ACCESS_MEMORY_READ_BIT;
+    vkCmdPipelineBarrier(_cmd_buffer,
+                         VK_PIPELINE_STAGE_TRANSFER_BIT,
+                         VK_PIPELINE_STAGE_ALL_COMMANDS_BIT,
+                         0,
+                         1,
+                         &barrier,
+                         0,
+                         nullptr,
+                         0,
+                         nullptr);
+    ++_nb_pending_uploads;
+}
+
+void
+VulkanUploadBatch::submit()
+{
+    submitAsync();
+    wait();
+}
+
+void
+VulkanUploadBatch::submitAsync()
+{
+    if (!_cmd_buffer || _in_flight) {
+        return;
+    }
+
+    VkResult result = vkEndCommandBuffer(_cmd_buffer);
+    if (result == VK_SUCCESS) {
+        VkSubmitInfo submit_info{};
+        submit_info.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+        submit_info.commandBufferCount = 1;
+        submit_info.pCommandBuffers = &_cmd_buffer;
+        result = vkQueueSubmit(_queue, 1, &submit_info, _fence);
+    }
+    if (result != VK_SUCCESS) {
+        _reset();
+        throw std::runtime_error("VkUploadBatch: Failed to submit uploads");
+    }
+    _in_flight = true;
+}
+
+bool
+VulkanUploadBatch::poll()
+{
+    if (!_in_flight) {
+        return (true);
+    }
+
+    auto result = vkGetFenceStatus(_device, _fence);
+    if (result == VK_NOT_READY) {
+        return (false);
+    }
+    vkResetFences(_device, 1, &_fence);
+    _reset();
+    if (result != VK_SUCCESS) {
+        throw std::runtime_error("VkUploadBatch: Failed to submit uploads");
+    }
+    return (true);
+}
+
+void
+VulkanUploadBatch::wait()
+{
+    if (!_in_flight) {
+        return;
+    }
+
+    auto result = vkWaitForFences(_device, 1, &_fence, VK_TRUE, UINT64_MAX);
+    vkResetFences(_device, 1, &_fence);
+    _reset();
+    if (result != VK_SUCCESS) {
+        throw std::runtime_error("VkUploadBatch: Failed to submit uploads");
+    }
+}
+
+bool
+VulkanUploadBatch::isInFlight() const
+{
+    return (_in_flight);
+}
+
+uint32_t
+VulkanUploadBatch::getNbPendingUploads() const
+{
+    return (_nb_pending_uploads);
+}
+
+VkDeviceSize
+VulkanUploadBatch::_stage(void const *data,
+                          VkDeviceSize size,
+                          VkBuffer &buffer)
+{
+    // Staging memory of an in flight batch is still read by the device
+    wait();
+
+    auto block = std::find_if(
+      _staging_blocks.begin(),
+      _staging_blocks.end(),
+      [&](StagingBlock const &it) -> bool {
+          auto offset = (it.used + STAGING_ALIGNMENT - 1) / STAGING_ALIGNMENT *
+                        STAGING_ALIGNMENT;
+          return (offset + size <= it.size);
+      });
+
+    // Images bigger than a block get their own block
+    if (block == _staging_blocks.end()) {
+        StagingBlock new_block{};
+        new_block.size = std::max(size, STAGING_BLOCK_SIZE);
+        createBuffer(_device,
+                     new_block.buffer,
+                     new_block.size,
+                     VK_BUFFER_USAGE_TRANSFER_SRC_BIT);
+        new_block.allocation = _allocator->allocateTransientBuffer(
+          new_block.buffer,
+          VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT |
+            VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+        _staging_blocks.emplace_back(new_block);
+        block = _staging_blocks.end() - 1;
+    }
+
+    auto offset = (block->used + STAGING_ALIGNMENT - 1) / STAGING_ALIGNMENT *
+                  STAGING_ALIGNMENT;
+    copyOnCpuCoherentMemory(block->allocation, offset, size, data);
+    block->used = offset + size;
+    buffer = block->buffer;
+    return (offset);
+}
+
+void
+VulkanUploadBatch::_begin_cmd_buffer()
+{
+    if (!_cmd_buffer) {
+        _cmd_buffer = beginSingleTimeCommands(_device, _command_pool);
+    }
+}
+
+void
+VulkanUploadBatch::_reset()
+{
+    if (_cmd_buffer) {
+        vkFreeCommandBuffers(_device, _command_pool, 1, &_cmd_buffer);
+        _cmd_buffer = nullptr;
+    }
+    _nb_pending_uploads = 0;
+    _in_flight = false;
+
+    // Only the first block is kept around for the next batch
+    for (size_t i = 1; i < _staging_blocks.size(); ++i) {
+        vkDestroyBuffer(_device, _staging_blocks[i].buffer, nullptr);
+        _allocator->free(_staging_blocks[i].allocation);
+    }
+    if (!_staging_blocks.empty()) {
+        _staging_blocks.resize(1);
+        _staging_blocks[0].used = 0;
+    }
+}
@@ -0,0 +1,67 @@
+#ifndef SCOP_VULKAN_VULKANFRAMEALLOCATOR_HPP
+#define SCOP_VULKAN_VULKANFRAMEALLOCATOR_HPP
+
+#include <cstdint>
+#include <vulkan/vulkan.h>
+
+#include "VulkanMemoryAllocator.hpp"
+#include "VulkanMappedBuffer.hpp"
+
+struct VulkanFrameAllocation final
+{
+    VkBuffer buffer{};
+    // From the start of buffer, usable as a dynamic offset
+    VkDeviceSize offset{};
+    void *data{};
+};
+
+// Linear allocator over a persistently mapped buffer, one area per frame
+// in flight. An area is rewound by reset once the device is done with
+// the frame that used it.
+class VulkanFrameAllocator final
+{
+  public:
+    VulkanFrameAllocator() = default;
+    ~VulkanFrameAllocator() = default;
+    VulkanFrameAllocator(VulkanFrameAllocator const &src) = delete;
+    VulkanFrameAllocator &operator=(VulkanFrameAllocator const &rhs) = delete;
+    VulkanFrameAllocator(VulkanFrameAllocator &&src) = delete;
+    VulkanFrameAllocator &operator=(VulkanFrameAllocator &&rhs) = delete;
+
+    static constexpr VkDeviceSize const DEFAULT_FRAME_SIZE = 1024 * 1024;
+
+    // minAlignment applies to every allocation, usage has to cover all
+    // the ways allocations are read by the device
+    void init(VkDevice device,
+              VulkanMemoryAllocator &allocator,
+              uint32_t nbFrames,
+              VkBufferUsageFlags usage,
+              VkDeviceSize minAlignment,
+              VkDeviceSize frameSize = DEFAULT_FRAME_SIZE);
+    void clear();
+
+    // Makes frameIndex the current frame and rewinds its area
+    void reset(uint32_t frameIndex);
+    // Valid until the current frame area is reset. Data written through
+    // the returned pointer has to be flushed.
+    VulkanFrameAllocation allocate(VkDeviceSize size,
+                                   VkDeviceSize alignment = 1);
+    // Allocates, copies data and flushes it
+    VulkanFrameAllocation push(void const *data,
+                               VkDeviceSize size,
+                               VkDeviceSize alignment = 1);
+    void flush(VulkanFrameAllocation const &allocation, VkDeviceSize size);
+
+    [[nodiscard]] VkBuffer getBuffer() const;
+    [[nodiscard]] VkDeviceSize getFrameSize() const;
+    // Used part of the current frame area, padding included
+    [[nodiscard]] VkDeviceSize getUsedSize() const;
+
+  private:
+    VulkanMappedBuffer _buffer;
+    VkDeviceSize _min_alignment{};
+    uint32_t _current_frame{};
+    VkDeviceSize _head{};
+};
+
+#endif // SCOP_VULKAN_VULKANFRAMEALLOCATOR_HPP
@@ -0,0 +1,40 @@
+#ifndef SCOP_VULKAN_VULKANGROWABLEBUFFER_HPP
+#define SCOP_VULKAN_VULKANGROWABLEBUFFER_HPP
+
+#include <cstdint>
+#include <vulkan/vulkan.h>
+
+#include "VulkanMemoryAllocator.hpp"
+
+// Device local buffer replaced by a bigger one when more room is needed.
+// Size is at least doubled on growth, content is copied on the gpu.
+class VulkanGrowableBuffer final
+{
+  public:
+    void init(VkDevice device,
+              VulkanMemoryAllocator &allocator,
+              VkCommandPool commandPool,
+              VkQueue queue,
+              VkDeviceSize size,
+              VkBufferUsageFlags usage);
+    void clear();
+
+    // Returns true when the buffer was replaced. Queue is waited for,
+    // the previous buffer is then destroyed. Uploads pending on the
+    // previous buffer have to be submitted beforehand.
+    bool reserve(VkDeviceSize size);
+    [[nodiscard]] VkBuffer getBuffer() const;
+    [[nodiscard]] VkDeviceSize getSize() const;
+
+  private:
+    VkDevice _device{};
+    VulkanMemoryAllocator *_allocator{};
+    VkCommandPool _command_pool{};
+    VkQueue _queue{};
+    VkBufferUsageFlags _usage{};
+    VkBuffer _buffer{};
+    VulkanAllocation _allocation{};
+    VkDeviceSize _size{};
+};
+
+#endif // SCOP_VULKAN_VULKANGROWABLEBUFFER_HPP
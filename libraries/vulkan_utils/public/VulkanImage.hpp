@@ -3,15 +3,21 @@
 
 #include <string>
 #include <vector>
+#include <memory>
+#include <cstdint>
 #include <vulkan/vulkan.h>
 
-VkDeviceSize loadTextureInBuffer(VkPhysicalDevice physical_device,
-                                 VkDevice device,
-                                 std::string const &filepath,
-                                 VkBuffer &tex_buffer,
-                                 VkDeviceMemory &tex_buffer_memory,
-                                 int &tex_w,
-                                 int &tex_h);
+struct ImagePixelsDeleter final
+{
+    void operator()(uint8_t *pixels) const;
+};
+// Pixels stay in the decoder allocation, no copy is made
+using ImagePixels = std::unique_ptr<uint8_t[], ImagePixelsDeleter>;
+
+// Decodes as RGBA8, has no vulkan dependency and can run on any thread
+ImagePixels decodeImage(std::string const &filepath, int &tex_w, int &tex_h);
+// Reads the image header only, returns false when it can't be parsed
+bool getImageSize(std::string const &filepath, int &tex_w, int &tex_h);
 VkImage createImage(VkDevice device,
                     uint32_t width,
                     uint32_t height,
@@ -19,11 +25,6 @@ VkImage createImage(VkDevice device,
                     VkFormat format,
                     VkImageTiling tiling,
                     VkImageUsageFlags usage);
-void allocateImage(VkPhysicalDevice physical_device,
-                   VkDevice device,
-                   VkImage &image,
-                   VkDeviceMemory &image_memory,
-                   VkMemoryPropertyFlags properties);
 void transitionImageLayout(VkDevice device,
                            VkCommandPool command_pool,
                            VkQueue gfx_queue,
@@ -32,6 +33,14 @@ void transitionImageLayout(VkDevice device,
                            uint32_t mip_level,
                            VkImageLayout old_layout,
                            VkImageLayout new_layout);
+// Transitions mip_level levels starting at base_mip_level
+void recordImageLayoutTransition(VkCommandBuffer cmd_buffer,
+                                 VkImage image,
+                                 VkFormat format,
+                                 uint32_t mip_level,
+                                 VkImageLayout old_layout,
+                                 VkImageLayout new_layout,
+                                 uint32_t base_mip_level = 0);
 void copyBufferToImage(VkDevice device,
                        VkCommandPool command_pool,
                        VkQueue gfx_queue,
@@ -39,6 +48,15 @@ void copyBufferToImage(VkDevice device,
                        VkImage image,
                        uint32_t width,
                        uint32_t height);
+// One region per mip level, level 0 first
+void copyBufferToImageLevels(VkDevice device,
+                             VkCommandPool command_pool,
+                             VkQueue gfx_queue,
+                             VkBuffer buffer,
+                             VkImage image,
+                             uint32_t width,
+                             uint32_t height,
+                             std::vector<VkDeviceSize> const &level_offsets);
 VkImageView createImageView(VkImage image,
                             VkFormat format,
                             uint32_t mip_level,
@@ -58,5 +76,12 @@ void generateMipmaps(VkPhysicalDevice physical_device,
                      int32_t tex_width,
                      int32_t tex_height,
                      uint32_t mip_levels);
+// Level 0 has to be in transfer dst layout, every level ends in shader
+// read only layout
+void recordGenerateMipmaps(VkCommandBuffer cmd_buffer,
+                           VkImage image,
+                           int32_t tex_width,
+                           int32_t tex_height,
+                           uint32_t mip_levels);
 
 #endif // SCOP_VULKAN_VULKANIMAGE_HPP
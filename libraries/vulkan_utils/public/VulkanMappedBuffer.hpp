@@ -0,0 +1,50 @@
+#ifndef SCOP_VULKAN_VULKANMAPPEDBUFFER_HPP
+#define SCOP_VULKAN_VULKANMAPPEDBUFFER_HPP
+
+#include <cstdint>
+#include <vulkan/vulkan.h>
+
+#include "VulkanMemoryAllocator.hpp"
+
+// Host visible buffer mapped for its whole lifetime, split in one area
+// per frame. Memory does not have to be host coherent, written ranges
+// are flushed. Copies refer to the same buffer, clear releases it.
+class VulkanMappedBuffer final
+{
+  public:
+    void init(VkDevice device,
+              VulkanMemoryAllocator &allocator,
+              VkDeviceSize frameSize,
+              uint32_t nbFrames,
+              VkBufferUsageFlags usage,
+              VkDeviceSize frameAlignment = 1);
+    void clear();
+
+    // offset is relative to the area of frameIndex
+    void write(uint32_t frameIndex,
+               VkDeviceSize offset,
+               void const *data,
+               VkDeviceSize size);
+    // Only needed for data written through getFrameData
+    void flush(uint32_t frameIndex, VkDeviceSize offset, VkDeviceSize size);
+    // Before reading data written by the device through getFrameData
+    void invalidate(uint32_t frameIndex,
+                    VkDeviceSize offset,
+                    VkDeviceSize size);
+    [[nodiscard]] void *getFrameData(uint32_t frameIndex) const;
+    [[nodiscard]] VkBuffer getBuffer() const;
+    [[nodiscard]] VkDeviceSize getFrameOffset(uint32_t frameIndex) const;
+    // Frame size rounded up to the frame alignment
+    [[nodiscard]] VkDeviceSize getFrameStride() const;
+    [[nodiscard]] uint32_t getNbFrames() const;
+
+  private:
+    VkDevice _device{};
+    VulkanMemoryAllocator *_allocator{};
+    VkBuffer _buffer{};
+    VulkanAllocation _allocation{};
+    VkDeviceSize _frame_stride{};
+    uint32_t _nb_frames{};
+};
+
+#endif // SCOP_VULKAN_VULKANMAPPEDBUFFER_HPP
@@ -4,6 +4,8 @@
 #include <cstdint>
 #include <vulkan/vulkan.h>
 
+#include "VulkanMemoryAllocator.hpp"
+
 uint32_t findMemoryType(VkPhysicalDevice physical_device,
                         uint32_t type_filter,
                         VkMemoryPropertyFlags properties);
@@ -11,11 +13,6 @@ void createBuffer(VkDevice device,
                   VkBuffer &buffer,
                   VkDeviceSize size,
                   VkBufferUsageFlags usage);
-void allocateBuffer(VkPhysicalDevice physical_device,
-                    VkDevice device,
-                    VkBuffer &buffer,
-                    VkDeviceMemory &buffer_memory,
-                    VkMemoryPropertyFlags properties);
 void copyBufferOnGpu(VkDevice device,
                      VkCommandPool command_pool,
                      VkQueue gfx_queue,
@@ -28,13 +25,13 @@ void copyBufferOnGpu(VkDevice device,
                      VkBuffer dst_buffer,
                      VkBuffer src_buffer,
                      VkBufferCopy copy_region);
-void copyOnCpuCoherentMemory(VkDevice device,
-                             VkDeviceMemory memory,
+// Allocation has to be host coherent, offset is relative to allocation
+void copyOnCpuCoherentMemory(VulkanAllocation const &allocation,
                              VkDeviceSize offset,
                              VkDeviceSize size,
                              void const *dataToCopy);
 void copyCpuBufferToGpu(VkDevice device,
-                        VkPhysicalDevice physicalDevice,
+                        VulkanMemoryAllocator &allocator,
                         VkCommandPool commandPool,
                         VkQueue queue,
                         VkBuffer dstBuffer,
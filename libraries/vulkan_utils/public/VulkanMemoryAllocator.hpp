@@ -0,0 +1,158 @@
+#ifndef SCOP_VULKAN_VULKANMEMORYALLOCATOR_HPP
+#define SCOP_VULKAN_VULKANMEMORYALLOCATOR_HPP
+
+#include <array>
+#include <vector>
+#include <cstdint>
+#include <vulkan/vulkan.h>
+
+// Part of a device memory block. Memory of host visible blocks stays
+// mapped, mapped then points to the start of the allocation.
+struct VulkanAllocation final
+{
+    VkDeviceMemory memory{};
+    VkDeviceSize offset{};
+    VkDeviceSize size{};
+    void *mapped{};
+    uint32_t memory_type{};
+};
+
+struct VulkanMemoryStatistics final
+{
+    // Number of vkAllocateMemory calls alive
+    uint32_t nb_blocks{};
+    uint32_t nb_allocations{};
+    VkDeviceSize allocated_size{};
+    VkDeviceSize used_size{};
+};
+
+struct VulkanHeapBudget final
+{
+    VkDeviceSize size{};
+    // With VK_EXT_memory_budget, budget and usage are given by the driver
+    // for the whole process. Otherwise budget is the heap size and usage
+    // what this allocator allocated.
+    VkDeviceSize budget{};
+    VkDeviceSize usage{};
+    bool device_local{};
+};
+
+// Sub allocates buffers and images from large blocks, one pool of blocks
+// per memory type. Not thread safe.
+class VulkanMemoryAllocator final
+{
+  public:
+    VulkanMemoryAllocator() = default;
+    ~VulkanMemoryAllocator() = default;
+    VulkanMemoryAllocator(VulkanMemoryAllocator const &src) = delete;
+    VulkanMemoryAllocator &operator=(VulkanMemoryAllocator const &rhs) =
+      delete;
+    VulkanMemoryAllocator(VulkanMemoryAllocator &&src) = delete;
+    VulkanMemoryAllocator &operator=(VulkanMemoryAllocator &&rhs) = delete;
+
+    // memoryBudget tells VK_EXT_memory_budget is enabled on device
+    void init(VkPhysicalDevice physicalDevice,
+              VkDevice device,
+              bool memoryBudget = false,
+              VkDeviceSize blockSize = DEFAULT_BLOCK_SIZE);
+    void clear();
+
+    // Memory is bound to the resource. Images are expected to use optimal
+    // tiling.
+    VulkanAllocation allocateBuffer(VkBuffer buffer,
+                                    VkMemoryPropertyFlags properties);
+    VulkanAllocation allocateImage(VkImage image,
+                                   VkMemoryPropertyFlags properties);
+    // Linear allocation for short lived staging buffers. A transient block
+    // is reused once all of its allocations are freed.
+    VulkanAllocation allocateTransientBuffer(VkBuffer buffer,
+                                             VkMemoryPropertyFlags properties);
+    // Resource using the allocation has to be destroyed beforehand
+    void free(VulkanAllocation &allocation);
+    // Makes host writes visible to the device, does nothing on host
+    // coherent memory. offset is relative to the allocation.
+    void flush(VulkanAllocation const &allocation,
+               VkDeviceSize offset,
+               VkDeviceSize size) const;
+    // Makes device writes visible to the host, does nothing on host
+    // coherent memory. offset is relative to the allocation.
+    void invalidate(VulkanAllocation const &allocation,
+                    VkDeviceSize offset,
+                    VkDeviceSize size) const;
+    [[nodiscard]] bool isHostCoherent(
+      VulkanAllocation const &allocation) const;
+
+    [[nodiscard]] VulkanMemoryStatistics getStatistics() const;
+    // Highest value of each getStatistics field since init
+    [[nodiscard]] VulkanMemoryStatistics getPeakStatistics() const;
+    [[nodiscard]] VulkanMemoryStatistics getHeapStatistics(
+      uint32_t heapIndex) const;
+    [[nodiscard]] uint32_t getNbHeaps() const;
+    [[nodiscard]] bool hasMemoryBudget() const;
+    [[nodiscard]] std::vector<VulkanHeapBudget> getHeapBudgets() const;
+
+  private:
+    static constexpr VkDeviceSize const DEFAULT_BLOCK_SIZE =
+      64 * 1024 * 1024;
+
+    // Buffers and optimal images never share a block when the device has
+    // a bufferImageGranularity constraint
+    enum class BlockKind
+    {
+        BUFFER,
+        IMAGE,
+        TRANSIENT,
+    };
+
+    struct FreeRange final
+    {
+        VkDeviceSize offset{};
+        VkDeviceSize size{};
+    };
+
+    struct Block final
+    {
+        VkDeviceMemory memory{};
+        VkDeviceSize size{};
+        VkDeviceSize used{};
+        void *mapped{};
+        BlockKind kind{};
+        bool dedicated{};
+        uint32_t nb_allocations{};
+        // Sorted by offset, unused by transient blocks
+        std::vector<FreeRange> free_ranges;
+        // Transient blocks only
+        VkDeviceSize linear_offset{};
+    };
+
+    VkPhysicalDevice _physical_device{};
+    VkDevice _device{};
+    VkDeviceSize _block_size{};
+    VkPhysicalDeviceMemoryProperties _memory_properties{};
+    VkDeviceSize _buffer_image_granularity{};
+    VkDeviceSize _non_coherent_atom_size{};
+    bool _memory_budget{};
+    VulkanMemoryStatistics _peak_statistics{};
+    std::array<std::vector<Block>, VK_MAX_MEMORY_TYPES> _pools;
+
+    inline VulkanAllocation _allocate(
+      VkMemoryRequirements requirements,
+      VkMemoryPropertyFlags properties,
+      BlockKind kind);
+    inline size_t _create_block(uint32_t memory_type,
+                                VkDeviceSize size,
+                                BlockKind kind,
+                                bool dedicated);
+    inline void _destroy_block(Block &block);
+    inline void _update_peak_statistics();
+    static inline bool _sub_allocate(Block &block,
+                                     VkMemoryRequirements const &requirements,
+                                     VulkanAllocation &allocation);
+    static inline void _release_range(Block &block,
+                                      VkDeviceSize offset,
+                                      VkDeviceSize size);
+    static inline void _add_block_statistics(Block const &block,
+                                             VulkanMemoryStatistics &stats);
+};
+
+#endif // SCOP_VULKAN_VULKANMEMORYALLOCATOR_HPP
@@ -14,6 +14,21 @@ struct DeviceRequirement
     std::optional<uint32_t> present_queue_index;
     VkBool32 geometry_shader{};
     VkBool32 sampler_aniso{};
+    // Optional, required by gpu cluster culling. drawIndirectCount
+    // needs a Vulkan 1.2 device.
+    VkBool32 multi_draw_indirect{};
+    VkBool32 draw_indirect_first_instance{};
+    VkBool32 draw_indirect_count{};
+    // Optional, required by compressed textures
+    VkBool32 texture_compression_bc{};
+    // Optional, required by bindless materials. Vulkan 1.2 device with
+    // runtimeDescriptorArray, descriptorBindingPartiallyBound and
+    // shaderDrawParameters.
+    VkBool32 sampled_image_dynamic_indexing{};
+    VkBool32 descriptor_indexing{};
+    VkBool32 shader_draw_parameters{};
+    // Optional, heap budgets reported by VK_EXT_memory_budget
+    VkBool32 memory_budget{};
     VkBool32 all_extension_supported{};
 
     [[nodiscard]] bool isValid() const;
@@ -36,6 +51,12 @@ void getDeviceQueues(VkPhysicalDevice device,
                      VkSurfaceKHR surface,
                      DeviceRequirement &dr);
 VkDeviceSize getMinUniformBufferOffsetAlignment(VkPhysicalDevice device);
+VkDeviceSize getMinStorageBufferOffsetAlignment(VkPhysicalDevice device);
+uint32_t getMaxDrawIndirectCount(VkPhysicalDevice device);
+uint32_t getMaxStorageBufferRange(VkPhysicalDevice device);
+std::array<uint32_t, 3> getMaxComputeWorkGroupCount(VkPhysicalDevice device);
+// Lowest of per stage and per set sampler and sampled image limits
+uint32_t getMaxSampledImagesPerSet(VkPhysicalDevice device);
 bool getLinearBlittingSupport(VkPhysicalDevice device, VkFormat imgFormat);
 
 #endif // SCOP_VULKAN_VULKANPHYSICALDEVICE_HPP
@@ -0,0 +1,91 @@
+#ifndef SCOP_VULKAN_VULKANSTAGINGRING_HPP
+#define SCOP_VULKAN_VULKANSTAGINGRING_HPP
+
+#include <vector>
+#include <deque>
+#include <map>
+#include <utility>
+#include <cstdint>
+#include <vulkan/vulkan.h>
+
+#include "VulkanMemoryAllocator.hpp"
+
+// Persistently mapped staging memory for small uploads into buffers.
+// Copies are recorded in one command buffer per frame in flight, the
+// fence of the frame tells when their staging memory can be reused.
+class VulkanStagingRing final
+{
+  public:
+    VulkanStagingRing() = default;
+    ~VulkanStagingRing() = default;
+    VulkanStagingRing(VulkanStagingRing const &src) = delete;
+    VulkanStagingRing &operator=(VulkanStagingRing const &rhs) = delete;
+    VulkanStagingRing(VulkanStagingRing &&src) = delete;
+    VulkanStagingRing &operator=(VulkanStagingRing &&rhs) = delete;
+
+    static constexpr VkDeviceSize const DEFAULT_SIZE = 4 * 1024 * 1024;
+
+    void init(VkDevice device,
+              VulkanMemoryAllocator &allocator,
+              VkCommandPool commandPool,
+              VkQueue queue,
+              uint32_t nbFrames,
+              VkDeviceSize size = DEFAULT_SIZE);
+    void clear();
+
+    // Data is copied to the ring right away. Uploads to the same range
+    // before a flush replace each other, partially overlapping ranges are
+    // not supported. When the ring is full, pending uploads are submitted
+    // and waited for.
+    void upload(VkBuffer dstBuffer,
+                VkDeviceSize dstOffset,
+                void const *data,
+                VkDeviceSize size);
+    // Has to be called before destroying dstBuffer
+    void cancelUploads(VkBuffer dstBuffer);
+    // Submits pending uploads and waits for them
+    void submitUploads();
+    // Records pending uploads, returns nullptr when there are none.
+    // Command buffer has to be submitted before the one signaling fence.
+    // Previous command buffer of frameIndex has to be done executing.
+    VkCommandBuffer flush(uint32_t frameIndex, VkFence fence);
+    [[nodiscard]] VkDeviceSize getSize() const;
+
+  private:
+    static constexpr VkDeviceSize const ALIGNMENT = 16;
+
+    struct PendingCopy final
+    {
+        VkBuffer dst_buffer{};
+        VkBufferCopy region{};
+    };
+
+    // Ring memory consumed by a flush, reusable once fence is signaled
+    struct Segment final
+    {
+        VkDeviceSize size{};
+        VkFence fence{};
+    };
+
+    VkDevice _device{};
+    VulkanMemoryAllocator *_allocator{};
+    VkCommandPool _command_pool{};
+    VkQueue _queue{};
+    VkBuffer _buffer{};
+    VulkanAllocation _allocation{};
+    VkDeviceSize _size{};
+    VkDeviceSize _head{};
+    // Includes padding and space skipped when wrapping
+    VkDeviceSize _used{};
+    VkDeviceSize _pending_size{};
+    std::vector<VkCommandBuffer> _cmd_buffers;
+    std::vector<PendingCopy> _pending_copies;
+    std::map<std::pair<VkBuffer, VkDeviceSize>, size_t> _pending_index;
+    std::deque<Segment> _in_flight;
+
+    inline VkDeviceSize _reserve(VkDeviceSize size);
+    inline void _record_copies(VkCommandBuffer cmd_buffer);
+    inline void _submit_pending();
+};
+
+#endif // SCOP_VULKAN_VULKANSTAGINGRING_HPP
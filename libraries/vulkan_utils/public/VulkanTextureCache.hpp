@@ -0,0 +1,37 @@
+#ifndef SCOP_VULKAN_VULKANTEXTURECACHE_HPP
+#define SCOP_VULKAN_VULKANTEXTURECACHE_HPP
+
+#include <string>
+#include <cstdint>
+
+#include "VulkanTextureCompression.hpp"
+
+// Compressed textures are stored as KTX2 files next to their source.
+// Bumped on any change of the encoder output.
+static constexpr uint32_t const TEXTURE_CACHE_VERSION = 1;
+static constexpr char const *TEXTURE_CACHE_EXTENSION = ".ktx2";
+static constexpr char const *TEXTURE_CACHE_KEY = "scop.source";
+
+// Stored as key value data, the cache is outdated when it differs
+struct TextureCacheSource final
+{
+    uint32_t version;
+    uint32_t normal_map;
+    uint64_t size;
+    int64_t mtime;
+};
+
+std::string textureCacheGetPath(std::string const &texture_path);
+bool textureCacheGetSource(std::string const &texture_path,
+                           bool normal_map,
+                           TextureCacheSource &source);
+// Returns false when no valid cache exists for texture_path
+bool textureCacheLoad(std::string const &texture_path,
+                      bool normal_map,
+                      CompressedTexture &dst);
+// Failure to write only disables the cache for this texture
+void textureCacheWrite(std::string const &texture_path,
+                       bool normal_map,
+                       CompressedTexture const &src);
+
+#endif // SCOP_VULKAN_VULKANTEXTURECACHE_HPP
@@ -0,0 +1,44 @@
+#ifndef SCOP_VULKAN_VULKANTEXTURECOMPRESSION_HPP
+#define SCOP_VULKAN_VULKANTEXTURECOMPRESSION_HPP
+
+#include <vector>
+#include <span>
+#include <cstdint>
+#include <vulkan/vulkan.h>
+
+// Block compressed texture with its full mip chain, level 0 first
+struct CompressedTexture final
+{
+    VkFormat format{};
+    uint32_t width{};
+    uint32_t height{};
+    std::vector<VkDeviceSize> level_offsets;
+    std::vector<VkDeviceSize> level_sizes;
+    std::vector<uint8_t> data;
+};
+
+// Color textures are BC1 when opaque and BC3 otherwise, normal maps are
+// BC5. Pixels are RGBA8, color is expected in sRGB.
+// Has no vulkan dependency and can run on any thread.
+void compressTexture(std::span<uint8_t const> pixels,
+                     uint32_t width,
+                     uint32_t height,
+                     bool normal_map,
+                     CompressedTexture &dst);
+uint32_t getTextureMipLevels(uint32_t width, uint32_t height);
+VkDeviceSize getCompressedBlockSize(VkFormat format);
+VkDeviceSize getCompressedLevelSize(VkFormat format,
+                                    uint32_t width,
+                                    uint32_t height);
+// 2x2 box filter, averaging is done in linear space when srgb is set
+void buildTextureMip(std::span<uint8_t const> src,
+                     uint32_t src_w,
+                     uint32_t src_h,
+                     bool srgb,
+                     std::vector<uint8_t> &dst);
+// Block is 4x4 RGBA8 texels, row major
+void compressBc1Block(uint8_t const *block, uint8_t *dst);
+// Values are 16 single channel texels, stride is in bytes
+void compressBc4Block(uint8_t const *values, uint32_t stride, uint8_t *dst);
+
+#endif // SCOP_VULKAN_VULKANTEXTURECOMPRESSION_HPP
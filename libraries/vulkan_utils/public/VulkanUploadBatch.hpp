@@ -0,0 +1,99 @@
+#ifndef SCOP_VULKAN_VULKANUPLOADBATCH_HPP
+#define SCOP_VULKAN_VULKANUPLOADBATCH_HPP
+
+#include <vector>
+#include <cstdint>
+#include <vulkan/vulkan.h>
+
+#include "VulkanMemoryAllocator.hpp"
+
+// Records the uploads of many images and buffers in a single command buffer,
+// submitted with one fence wait. Data is copied to staging memory when
+// recorded, staging memory is allocated in large blocks.
+class VulkanUploadBatch final
+{
+  public:
+    VulkanUploadBatch() = default;
+    ~VulkanUploadBatch() = default;
+    VulkanUploadBatch(VulkanUploadBatch const &src) = delete;
+    VulkanUploadBatch &operator=(VulkanUploadBatch const &rhs) = delete;
+    VulkanUploadBatch(VulkanUploadBatch &&src) = delete;
+    VulkanUploadBatch &operator=(VulkanUploadBatch &&rhs) = delete;
+
+    void init(VkPhysicalDevice physicalDevice,
+              VkDevice device,
+              VulkanMemoryAllocator &allocator,
+              VkCommandPool commandPool,
+              VkQueue queue);
+    void clear();
+
+    // Image has to be in undefined layout and ends in shader read only
+    // layout. levelOffsets fill the levels starting at baseLevel, the
+    // others are left undefined. When levelOffsets holds a single level
+    // and baseLevel is 0, the other levels are blitted from it.
+    void uploadImage(VkImage image,
+                     VkFormat format,
+                     void const *data,
+                     VkDeviceSize size,
+                     uint32_t width,
+                     uint32_t height,
+                     uint32_t mipLevels,
+                     std::vector<VkDeviceSize> const &levelOffsets,
+                     uint32_t baseLevel = 0);
+    // Image has to be in shader read only layout, only level is written.
+    // width and height are the ones of level 0.
+    void uploadImageLevel(VkImage image,
+                          VkFormat format,
+                          void const *data,
+                          VkDeviceSize size,
+                          uint32_t width,
+                          uint32_t height,
+                          uint32_t level);
+    // Written range is visible to any command submitted afterwards
+    void uploadBuffer(VkBuffer buffer,
+                      VkDeviceSize offset,
+                      void const *data,
+                      VkDeviceSize size);
+    // Blocks until every recorded upload is done, batch is then reusable
+    void submit();
+    // Does not block, batch is reusable once poll returns true or after
+    // wait
+    void submitAsync();
+    bool poll();
+    void wait();
+    [[nodiscard]] bool isInFlight() const;
+    [[nodiscard]] uint32_t getNbPendingUploads() const;
+
+  private:
+    static constexpr VkDeviceSize const STAGING_BLOCK_SIZE =
+      64 * 1024 * 1024;
+    // Covers texel block sizes of compressed formats
+    static constexpr VkDeviceSize const STAGING_ALIGNMENT = 16;
+
+    struct StagingBlock final
+    {
+        VkBuffer buffer{};
+        VulkanAllocation allocation{};
+        VkDeviceSize size{};
+        VkDeviceSize used{};
+    };
+
+    VkPhysicalDevice _physical_device{};
+    VkDevice _device{};
+    VulkanMemoryAllocator *_allocator{};
+    VkCommandPool _command_pool{};
+    VkQueue _queue{};
+    VkFence _fence{};
+    VkCommandBuffer _cmd_buffer{};
+    std::vector<StagingBlock> _staging_blocks;
+    uint32_t _nb_pending_uploads{};
+    bool _in_flight{};
+
+    inline VkDeviceSize _stage(void const *data,
+                               VkDeviceSize size,
+                               VkBuffer &buffer);
+    inline void _begin_cmd_buffer();
+    inline void _reset();
+};
+
+#endif // SCOP_VULKAN_VULKANUPLOADBATCH_HPP
@@ -6,7 +6,12 @@ layout(location = 1) in vec3 inNormal;
 layout(location = 2) in vec2 inTexCoord;
 layout(location = 3) in vec3 inTangent;
 layout(location = 4) in vec3 inBiTangent;
+#ifdef LOD_SELECTION
+// Buffer index of the instance, instances are drawn level after level
+layout(location = 5) in uint inInstanceIndex;
+#else
 layout(location = 5) in mat4 instanceMatrix;
+#endif
 
 layout(location = 0) out vec2 outFragTexCoord;
 
@@ -14,7 +19,16 @@ layout(binding = 0) uniform SystemUBO {
     mat4 view_proj;
 } systemUbo;
 
+#ifdef LOD_SELECTION
+layout(std430, binding = 3) readonly buffer InstanceBuffer {
+    mat4 instance_matrices[];
+};
+#endif
+
 void main() {
+#ifdef LOD_SELECTION
+    mat4 instanceMatrix = instance_matrices[inInstanceIndex];
+#endif
     gl_Position = systemUbo.view_proj * instanceMatrix * vec4(inVertexPosition, 1.0);
     outFragTexCoord = inTexCoord;
 }
\ No newline at end of file
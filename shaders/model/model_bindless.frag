@@ -0,0 +1,31 @@
+#version 450
+#extension GL_ARB_separate_shader_objects : enable
+#extension GL_EXT_nonuniform_qualifier : enable
+
+layout(location = 0) in vec2 inFragTexCoord;
+// Dynamically uniform, each draw of a multi draw is its own invocation
+// group
+layout(location = 1) flat in uint inMaterialIndex;
+
+layout(location = 0) out vec4 outColor;
+
+struct Material {
+    vec3 diffuse_color;
+    uint texture_index;
+    vec3 min_point;
+    vec3 extent;
+};
+
+layout(std430, binding = 1) readonly buffer Materials {
+    Material materials[];
+};
+layout(binding = 2) uniform sampler2D textures[];
+
+void main() {
+    Material material = materials[inMaterialIndex];
+    vec4 tex_color = texture(textures[material.texture_index], inFragTexCoord);
+    if (tex_color.a < 0.5f) {
+        discard;
+    }
+    outColor = vec4(tex_color.rgb * material.diffuse_color, 1.0f);
+}
@@ -0,0 +1,40 @@
+#version 450
+#extension GL_ARB_separate_shader_objects : enable
+
+layout(location = 0) in vec4 inPackedPosition;
+layout(location = 1) in vec2 inPackedNormal;
+layout(location = 2) in vec2 inTexCoord;
+layout(location = 3) in vec2 inPackedTangent;
+#ifdef LOD_SELECTION
+// Buffer index of the instance, instances are drawn level after level
+layout(location = 5) in uint inInstanceIndex;
+#else
+layout(location = 5) in mat4 instanceMatrix;
+#endif
+
+layout(location = 0) out vec2 outFragTexCoord;
+
+layout(binding = 0) uniform SystemUBO {
+    mat4 view_proj;
+} systemUbo;
+
+#ifdef LOD_SELECTION
+layout(std430, binding = 3) readonly buffer InstanceBuffer {
+    mat4 instance_matrices[];
+};
+#endif
+
+layout(push_constant) uniform MeshBounds {
+    vec3 min_point;
+    vec3 extent;
+} meshBounds;
+
+void main() {
+#ifdef LOD_SELECTION
+    mat4 instanceMatrix = instance_matrices[inInstanceIndex];
+#endif
+    vec3 position = meshBounds.min_point + inPackedPosition.xyz * meshBounds.extent;
+
+    gl_Position = systemUbo.view_proj * instanceMatrix * vec4(position, 1.0);
+    outFragTexCoord = inTexCoord;
+}
@@ -0,0 +1,59 @@
+#version 450
+#extension GL_ARB_separate_shader_objects : enable
+#extension GL_ARB_shader_draw_parameters : enable
+
+layout(location = 0) in vec4 inPackedPosition;
+layout(location = 1) in vec2 inPackedNormal;
+layout(location = 2) in vec2 inTexCoord;
+layout(location = 3) in vec2 inPackedTangent;
+#ifdef LOD_SELECTION
+// Buffer index of the instance, instances are drawn level after level
+layout(location = 5) in uint inInstanceIndex;
+#else
+layout(location = 5) in mat4 instanceMatrix;
+#endif
+
+layout(location = 0) out vec2 outFragTexCoord;
+layout(location = 1) flat out uint outMaterialIndex;
+
+layout(binding = 0) uniform SystemUBO {
+    mat4 view_proj;
+} systemUbo;
+
+#ifdef LOD_SELECTION
+layout(std430, binding = 3) readonly buffer InstanceBuffer {
+    mat4 instance_matrices[];
+};
+#endif
+
+// Mesh bounds are stored with the material of the draw
+struct Material {
+    vec3 diffuse_color;
+    uint texture_index;
+    vec3 min_point;
+    vec3 extent;
+};
+
+layout(std430, binding = 1) readonly buffer Materials {
+    Material materials[];
+};
+
+// False when each indirect call only draws a single mesh
+layout(constant_id = 0) const bool PER_DRAW_MATERIAL = true;
+
+layout(push_constant) uniform DrawOffset {
+    uint first_draw;
+} drawOffset;
+
+void main() {
+#ifdef LOD_SELECTION
+    mat4 instanceMatrix = instance_matrices[inInstanceIndex];
+#endif
+    uint material_index = drawOffset.first_draw + (PER_DRAW_MATERIAL ? uint(gl_DrawIDARB) : 0u);
+    Material material = materials[material_index];
+    vec3 position = material.min_point + inPackedPosition.xyz * material.extent;
+
+    gl_Position = systemUbo.view_proj * instanceMatrix * vec4(position, 1.0);
+    outFragTexCoord = inTexCoord;
+    outMaterialIndex = material_index;
+}